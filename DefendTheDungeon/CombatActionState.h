@@ -0,0 +1,46 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatCore.h"
+#include "CombatActionState.generated.h"
+
+/**
+ * 캐릭터가 현재 수행 중인 행동 상태입니다.
+ * 한 번에 하나의 상태만 가질 수 있으며, UCombatComponent의 bIsAttacking, bSkillQ 등 불 변수는 이 상태에서 파생됩니다.
+ * 순서를 바꾸면 CombatCore::EActionState와 CombatCore::LevelTable도 같이 바꿔야 합니다.
+ */
+UENUM(BlueprintType)
+enum class ECombatActionState : uint8
+{
+	Idle,
+	Attack,
+	Dash,
+	SkillQ,
+	SkillE,
+	SkillR,
+	Block,
+	KnockBack,
+	BigKnockBack,
+	Stun,
+	MAX UMETA(Hidden)
+};
+
+namespace CombatAction
+{
+	static constexpr int32 NumStates = static_cast<int32>(ECombatActionState::MAX);
+	static_assert(NumStates == CombatCore::NumStates, "ECombatActionState must mirror CombatCore::EActionState");
+	static_assert(static_cast<uint8>(ECombatActionState::Attack) == static_cast<uint8>(CombatCore::EActionState::Attack)
+		&& static_cast<uint8>(ECombatActionState::Block) == static_cast<uint8>(CombatCore::EActionState::Block)
+		&& static_cast<uint8>(ECombatActionState::Stun) == static_cast<uint8>(CombatCore::EActionState::Stun),
+		"ECombatActionState must mirror CombatCore::EActionState");
+
+	//우선순위 표와 전이 표는 CombatCore.h에 있다.
+	constexpr CombatCore::EActionState ToCore(ECombatActionState State) { return static_cast<CombatCore::EActionState>(State); }
+
+	constexpr int32 GetActionLevel(ECombatActionState State) { return CombatCore::GetActionLevel(ToCore(State)); }
+	constexpr int32 GetCancelLevel(ECombatActionState State) { return CombatCore::GetCancelLevel(ToCore(State)); }
+	constexpr bool IsCrowdControl(ECombatActionState State) { return CombatCore::IsCrowdControl(ToCore(State)); }
+	constexpr bool CanTransition(ECombatActionState From, ECombatActionState To) { return CombatCore::CanTransition(ToCore(From), ToCore(To)); }
+}
@@ -0,0 +1,157 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatActionTrace.h"
+
+#include "CombatActionState.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+UE_TRACE_CHANNEL_DEFINE(CombatActionChannel)
+
+UE_TRACE_EVENT_BEGIN(CombatAction, Lifecycle)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, CharacterId)
+	UE_TRACE_EVENT_FIELD(uint32, ActionId)
+	UE_TRACE_EVENT_FIELD(int8, ActionLevel)
+	UE_TRACE_EVENT_FIELD(int8, CompetingLevel)
+	UE_TRACE_EVENT_FIELD(uint8, ActionState)
+	UE_TRACE_EVENT_FIELD(uint8, Type)
+UE_TRACE_EVENT_END()
+
+namespace CombatActionTrace
+{
+	bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(TEXT("Combat.Trace.Enable"), bEnabled, TEXT("액션 수명 주기 이벤트를 링 버퍼에 기록합니다."));
+
+	//2의 거듭제곱이어야 한다.
+	static constexpr uint64 Capacity = 16384;
+	static constexpr uint64 IndexMask = Capacity - 1;
+
+	//Sequence가 홀수면 쓰는 중, 짝수면 (쓰기 번호 + 1) * 2
+	struct FSlot
+	{
+		std::atomic<uint64> Sequence{0};
+		FEvent Event;
+	};
+
+	static FSlot Slots[Capacity];
+	static std::atomic<uint64> WriteIndex{0};
+
+	void RecordEvent(EEvent Type, const UObject* Character, FName ActionName, int32 ActionLevel, int32 CompetingLevel, uint8 ActionState)
+	{
+		const uint64 Cycles = FPlatformTime::Cycles64();
+		const uint64 Index = WriteIndex.fetch_add(1, std::memory_order_relaxed);
+		FSlot& Slot = Slots[Index & IndexMask];
+
+		Slot.Sequence.store(Index * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Slot.Event.Cycles = Cycles;
+		Slot.Event.Character = Character;
+		Slot.Event.ActionName = ActionName;
+		Slot.Event.ActionLevel = static_cast<int8>(ActionLevel);
+		Slot.Event.CompetingLevel = static_cast<int8>(CompetingLevel);
+		Slot.Event.ActionState = ActionState;
+		Slot.Event.Type = Type;
+		Slot.Sequence.store(Index * 2 + 2, std::memory_order_release);
+
+		UE_TRACE_LOG(CombatAction, Lifecycle, CombatActionChannel)
+			<< Lifecycle.Cycle(Cycles)
+			<< Lifecycle.CharacterId(Character ? Character->GetUniqueID() : 0)
+			<< Lifecycle.ActionId(ActionName.GetComparisonIndex().ToUnstableInt())
+			<< Lifecycle.ActionLevel(static_cast<int8>(ActionLevel))
+			<< Lifecycle.CompetingLevel(static_cast<int8>(CompetingLevel))
+			<< Lifecycle.ActionState(ActionState)
+			<< Lifecycle.Type(static_cast<uint8>(Type));
+	}
+
+	static const TCHAR* GetEventName(EEvent Type)
+	{
+		switch (Type)
+		{
+		case EEvent::Request:	return TEXT("Request");
+		case EEvent::Accept:	return TEXT("Accept");
+		case EEvent::Deny:		return TEXT("Deny");
+		case EEvent::Fail:		return TEXT("Fail");
+		case EEvent::Cancel:	return TEXT("Cancel");
+		case EEvent::End:		return TEXT("End");
+		default:				return TEXT("Unknown");
+		}
+	}
+
+	int32 DumpTimeline(const FString& Path)
+	{
+		//쓰는 중이거나 덮어써진 슬롯은 건너뛰고 복사한다.
+		TArray<FEvent> Events;
+		Events.Reserve(Capacity);
+		const uint64 End = WriteIndex.load(std::memory_order_acquire);
+		const uint64 Begin = End > Capacity ? End - Capacity : 0;
+		for (uint64 Index = Begin; Index < End; Index++)
+		{
+			const FSlot& Slot = Slots[Index & IndexMask];
+			const uint64 Before = Slot.Sequence.load(std::memory_order_acquire);
+			if (Before != Index * 2 + 2) continue;
+
+			FEvent Copy = Slot.Event;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (Slot.Sequence.load(std::memory_order_relaxed) != Before) continue;
+			Events.Add(Copy);
+		}
+
+		if (Events.Num() == 0) return 0;
+
+		const uint64 FirstCycles = Events[0].Cycles;
+		TMap<FWeakObjectPtr, FString> CharacterNames;
+		for (const FEvent& Event : Events)
+		{
+			if (!CharacterNames.Contains(Event.Character))
+			{
+				const UObject* Character = Event.Character.Get();
+				CharacterNames.Add(Event.Character, Character ? Character->GetName() : TEXT("Expired"));
+			}
+		}
+
+		//캐릭터별 타임라인
+		Events.StableSort([&CharacterNames](const FEvent& A, const FEvent& B)
+		{
+			const FString& NameA = CharacterNames[A.Character];
+			const FString& NameB = CharacterNames[B.Character];
+			return NameA != NameB ? NameA < NameB : A.Cycles < B.Cycles;
+		});
+
+		const UEnum* StateEnum = StaticEnum<ECombatActionState>();
+		FString Csv = TEXT("Character,TimeMs,Event,Action,ActionLevel,CompetingLevel,State\n");
+		for (const FEvent& Event : Events)
+		{
+			Csv += FString::Printf(TEXT("%s,%.3f,%s,%s,%d,%d,%s\n"),
+				*CharacterNames[Event.Character],
+				FPlatformTime::ToMilliseconds64(Event.Cycles - FirstCycles),
+				GetEventName(Event.Type),
+				*Event.ActionName.ToString(),
+				Event.ActionLevel, Event.CompetingLevel,
+				*StateEnum->GetNameStringByValue(Event.ActionState));
+		}
+
+		const FString FullPath = FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectSavedDir(), Path) : Path;
+		if (!FFileHelper::SaveStringToFile(Csv, *FullPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			MY_LOG(LogTemp, Error, TEXT("Failed to write combat action timeline %s"), *FullPath);
+			return 0;
+		}
+		return Events.Num();
+	}
+
+	static FAutoConsoleCommand DumpCommand(
+		TEXT("Combat.Trace.Dump"),
+		TEXT("최근 액션 이벤트를 캐릭터별 타임라인 CSV로 저장합니다. 인자: [경로]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const FString Path = Args.Num() > 0 ? Args[0] : TEXT("Profiling/CombatActionTimeline.csv");
+			const int32 NumEvents = DumpTimeline(Path);
+			MY_LOG(LogTemp, Log, TEXT("Combat action timeline, %d events written to %s"), NumEvents, *Path);
+		}));
+}
@@ -0,0 +1,69 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "UObject/WeakObjectPtr.h"
+
+/*
+ 액션 수명 주기 추적
+ TryPlayAction_Internal의 요청, 수락, 거절, 실패, 취소, 종료를 고정 크기 이벤트로 기록한다.
+ 문자열을 만들지 않으므로 항상 켜 두어도 비용이 작다.
+ - 최근 이벤트는 락 없는 링 버퍼에 남으며, Combat.Trace.Dump [경로] 로 캐릭터별 타임라인 CSV를 뽑을 수 있다.
+ - Unreal Insights에서 -trace=CombatAction 채널을 켜면 같은 이벤트가 트레이스 파일에도 기록된다.
+ - Combat.Trace.Enable 0 으로 끌 수 있다.
+ */
+
+UE_TRACE_CHANNEL_EXTERN(CombatActionChannel, DEFENDTHEDUNGEON_API)
+
+//액션 문자열 로그, Shipping 빌드에서는 컴파일되지 않는다.
+#if UE_BUILD_SHIPPING
+	#define COMBAT_ACTION_LOG(...)
+#else
+	#define COMBAT_ACTION_LOG(...) MY_LOG(__VA_ARGS__)
+#endif
+
+namespace CombatActionTrace
+{
+	enum class EEvent : uint8
+	{
+		Request,
+		Accept,
+		Deny,
+		Fail,
+		Cancel,
+		End,
+	};
+
+	struct FEvent
+	{
+		uint64 Cycles;
+		FWeakObjectPtr Character;
+		FName ActionName;
+		//요청 액션의 ActionLevel과 경쟁한 현재 액션의 CancelLevel
+		int8 ActionLevel;
+		int8 CompetingLevel;
+		uint8 ActionState;
+		EEvent Type;
+	};
+
+	DEFENDTHEDUNGEON_API extern bool bEnabled;
+
+	DEFENDTHEDUNGEON_API void RecordEvent(EEvent Type, const UObject* Character, FName ActionName, int32 ActionLevel, int32 CompetingLevel, uint8 ActionState);
+
+	FORCEINLINE void Record(EEvent Type, const UObject* Character, FName ActionName, int32 ActionLevel, int32 CompetingLevel, uint8 ActionState)
+	{
+		if (bEnabled)
+		{
+			RecordEvent(Type, Character, ActionName, ActionLevel, CompetingLevel, ActionState);
+		}
+	}
+
+	/**
+	 * 링 버퍼에 남아 있는 이벤트를 캐릭터별, 시간순으로 정렬해 CSV로 저장합니다.
+	 * @param Path 저장 경로, 상대 경로면 Saved 폴더 기준.
+	 * @return 저장한 이벤트 수.
+	 */
+	DEFENDTHEDUNGEON_API int32 DumpTimeline(const FString& Path);
+}
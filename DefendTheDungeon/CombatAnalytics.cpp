@@ -0,0 +1,351 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatAnalytics.h"
+
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	int32 AnalyticsEnabled = 0;
+	FAutoConsoleVariableRef CVarAnalyticsEnabled(TEXT("Combat.Analytics"), AnalyticsEnabled, TEXT("1이면 서버에서 매치별 전투 분석 기록을 남깁니다. 월드가 시작될 때 적용됩니다."));
+
+	constexpr uint32 FileMagic = 0x41434444; //'DDCA'
+	constexpr uint32 FileVersion = 1;
+}
+
+/*******************************************************************/
+/* FCombatAnalyticsRing */
+
+FCombatAnalyticsRing::FCombatAnalyticsRing(uint32 InCapacity)
+	: Mask(InCapacity - 1)
+{
+	check(FMath::IsPowerOfTwo(InCapacity));
+	Buffer.SetNum(InCapacity);
+}
+
+bool FCombatAnalyticsRing::Push(const FCombatAnalyticsRecord& Record)
+{
+	const uint32 CurrentTail = Tail.load(std::memory_order_relaxed);
+	if (CurrentTail - Head.load(std::memory_order_acquire) > Mask) return false;
+
+	Buffer[CurrentTail & Mask] = Record;
+	Tail.store(CurrentTail + 1, std::memory_order_release);
+	return true;
+}
+
+bool FCombatAnalyticsRing::Pop(FCombatAnalyticsRecord& OutRecord)
+{
+	const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+	if (CurrentHead == Tail.load(std::memory_order_acquire)) return false;
+
+	OutRecord = Buffer[CurrentHead & Mask];
+	Head.store(CurrentHead + 1, std::memory_order_release);
+	return true;
+}
+
+/*******************************************************************/
+/* FCombatAnalyticsWorker */
+
+/**
+ * 분석 스레드입니다. 링 버퍼를 비워 열 배열과 집계 표에 넣고, 매치가 끝나면 파일로 씁니다.
+ * 게임 스레드와 공유하는 것은 링 버퍼와 다음 매치 이름뿐입니다.
+ */
+class FCombatAnalyticsWorker : public FRunnable
+{
+public:
+	FCombatAnalyticsWorker(FCombatAnalyticsRing& InRing, const FString& InMatchName)
+		: Ring(InRing)
+		, MatchName(InMatchName)
+	{
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+		Thread = FRunnableThread::Create(this, TEXT("CombatAnalytics"), 0, TPri_BelowNormal);
+	}
+
+	virtual ~FCombatAnalyticsWorker() override
+	{
+		bStopping = true;
+		WakeEvent->Trigger();
+		if (Thread)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+		}
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	}
+
+	virtual uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			WakeEvent->Wait(100);
+			Drain();
+
+			FString NextMatchName;
+			{
+				FScopeLock Lock(&MatchLock);
+				Swap(NextMatchName, PendingMatchName);
+			}
+			if (!NextMatchName.IsEmpty())
+			{
+				WriteMatch();
+				MatchName = NextMatchName;
+			}
+		}
+
+		//종료 전에 남은 기록까지 쓴다.
+		Drain();
+		WriteMatch();
+		return 0;
+	}
+
+	//현재 매치를 닫고 NextMatchName으로 새 매치를 연다. 게임 스레드에서 호출
+	void EndMatch(const FString& NextMatchName)
+	{
+		{
+			FScopeLock Lock(&MatchLock);
+			PendingMatchName = NextMatchName;
+		}
+		WakeEvent->Trigger();
+	}
+
+private:
+	//(종류, 스킬, 공격 종류, 피해 종류)별 집계
+	struct FAggregate
+	{
+		uint32 Count = 0;
+		double Total = 0.0;
+		float Max = 0.f;
+	};
+
+	static uint64 MakeKey(ECombatAnalyticsKind Kind, uint16 Skill, uint8 AttackType, uint8 DamageType)
+	{
+		return static_cast<uint64>(Kind) << 32 | static_cast<uint64>(Skill) << 16 | static_cast<uint64>(AttackType) << 8 | DamageType;
+	}
+
+	uint16 GetNameIndex(FName Name)
+	{
+		if (const uint16* Index = NameIndices.Find(Name))
+		{
+			return *Index;
+		}
+		const uint16 Index = static_cast<uint16>(Names.Add(Name));
+		NameIndices.Add(Name, Index);
+		return Index;
+	}
+
+	void Drain()
+	{
+		FCombatAnalyticsRecord Record;
+		while (Ring.Pop(Record))
+		{
+			const uint16 Skill = GetNameIndex(Record.SkillName);
+
+			Times.Add(Record.Time);
+			Kinds.Add(static_cast<uint8>(Record.Kind));
+			Skills.Add(Skill);
+			AttackTypes.Add(Record.AttackType);
+			DamageTypes.Add(Record.DamageType);
+			Amounts.Add(Record.Amount);
+			ActorIds.Add(Record.ActorId);
+
+			FAggregate& Aggregate = Aggregates.FindOrAdd(MakeKey(Record.Kind, Skill, Record.AttackType, Record.DamageType));
+			Aggregate.Count++;
+			Aggregate.Total += Record.Amount;
+			Aggregate.Max = FMath::Max(Aggregate.Max, Record.Amount);
+		}
+	}
+
+	void WriteMatch()
+	{
+		if (Times.Num() > 0)
+		{
+			const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CombatAnalytics"));
+			WriteColumns(FPaths::Combine(Directory, MatchName + TEXT(".ddca")));
+			WriteSummary(FPaths::Combine(Directory, MatchName + TEXT("_summary.csv")));
+		}
+
+		Times.Reset();
+		Kinds.Reset();
+		Skills.Reset();
+		AttackTypes.Reset();
+		DamageTypes.Reset();
+		Amounts.Reset();
+		ActorIds.Reset();
+		Names.Reset();
+		NameIndices.Reset();
+		Aggregates.Reset();
+	}
+
+	/*
+	 파일 형식
+		uint32 Magic, uint32 Version, uint32 압축 전 크기, 이후 zlib 압축 본문
+		본문 : int32 행 수, 이름 표(TArray<FString>), 열 7개(TArray) Time, Kind, Skill, AttackType, DamageType, Amount, ActorId
+	 */
+	void WriteColumns(const FString& Path)
+	{
+		TArray<uint8> Body;
+		FMemoryWriter Writer(Body);
+
+		int32 NumRows = Times.Num();
+		TArray<FString> NameStrings;
+		for (const FName& Name : Names)
+		{
+			NameStrings.Add(Name.ToString());
+		}
+		Writer << NumRows << NameStrings;
+		Writer << Times << Kinds << Skills << AttackTypes << DamageTypes << Amounts << ActorIds;
+
+		const uint32 Header[] = { FileMagic, FileVersion, static_cast<uint32>(Body.Num()) };
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Body.Num());
+		TArray<uint8> File;
+		File.SetNumUninitialized(sizeof(Header) + CompressedSize);
+
+		uint8* Out = File.GetData();
+		FMemory::Memcpy(Out, Header, sizeof(Header));
+		if (!FCompression::CompressMemory(NAME_Zlib, Out + sizeof(Header), CompressedSize, Body.GetData(), Body.Num()))
+		{
+			MY_LOG(LogTemp, Error, TEXT("Failed to compress combat analytics %s"), *Path);
+			return;
+		}
+		File.SetNum(sizeof(Header) + CompressedSize);
+
+		if (!FFileHelper::SaveArrayToFile(File, *Path))
+		{
+			MY_LOG(LogTemp, Error, TEXT("Failed to write combat analytics %s"), *Path);
+			return;
+		}
+		MY_LOG(LogTemp, Log, TEXT("Combat analytics, %d rows, %d -> %d bytes, %s"), NumRows, Body.Num(), File.Num(), *Path);
+	}
+
+	void WriteSummary(const FString& Path) const
+	{
+		static const TCHAR* KindNames[] = { TEXT("Damage"), TEXT("SkillUse"), TEXT("CrowdControl") };
+
+		FString Csv = TEXT("Kind,Skill,AttackType,DamageType,Count,Total,Average,Max\n");
+		for (const TPair<uint64, FAggregate>& Pair : Aggregates)
+		{
+			const uint8 Kind = static_cast<uint8>(Pair.Key >> 32);
+			const uint16 Skill = static_cast<uint16>(Pair.Key >> 16);
+			const FAggregate& Aggregate = Pair.Value;
+			Csv += FString::Printf(TEXT("%s,%s,%u,%u,%u,%.1f,%.2f,%.1f\n"),
+				Kind < UE_ARRAY_COUNT(KindNames) ? KindNames[Kind] : TEXT("?"), *Names[Skill].ToString(),
+				static_cast<uint32>((Pair.Key >> 8) & 0xFF), static_cast<uint32>(Pair.Key & 0xFF),
+				Aggregate.Count, Aggregate.Total, Aggregate.Total / Aggregate.Count, Aggregate.Max);
+		}
+
+		if (!FFileHelper::SaveStringToFile(Csv, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			MY_LOG(LogTemp, Error, TEXT("Failed to write combat analytics %s"), *Path);
+		}
+	}
+
+	FCombatAnalyticsRing& Ring;
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	std::atomic<bool> bStopping{ false };
+
+	FCriticalSection MatchLock;
+	FString PendingMatchName;
+	FString MatchName;
+
+	//열 배열, 분석 스레드만 건드린다.
+	TArray<float> Times;
+	TArray<uint8> Kinds;
+	TArray<uint16> Skills;
+	TArray<uint8> AttackTypes;
+	TArray<uint8> DamageTypes;
+	TArray<float> Amounts;
+	TArray<uint32> ActorIds;
+	TArray<FName> Names;
+	TMap<FName, uint16> NameIndices;
+	TMap<uint64, FAggregate> Aggregates;
+};
+
+/*******************************************************************/
+/* UCombatAnalyticsSubsystem */
+
+bool UCombatAnalyticsSubsystem::IsEnabled()
+{
+	return AnalyticsEnabled != 0;
+}
+
+bool UCombatAnalyticsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	//클라이언트는 피해, CC가 서버에서 정해지므로 기록할 것이 없다.
+	const UWorld* World = Cast<UWorld>(Outer);
+	return IsEnabled() && FPlatformProcess::SupportsMultithreading() && World && World->IsGameWorld() && World->GetNetMode() != NM_Client
+		&& Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatAnalyticsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Ring = MakeUnique<FCombatAnalyticsRing>(RingCapacity);
+	Worker = MakeUnique<FCombatAnalyticsWorker>(*Ring, MakeMatchName());
+}
+
+void UCombatAnalyticsSubsystem::Deinitialize()
+{
+	//워커가 남은 기록을 쓰고 끝날 때까지 기다린 뒤 버퍼를 지운다.
+	Worker.Reset();
+	Ring.Reset();
+
+	if (NumDropped > 0)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Combat analytics dropped %u records, ring buffer full"), NumDropped);
+	}
+	Super::Deinitialize();
+}
+
+FString UCombatAnalyticsSubsystem::MakeMatchName() const
+{
+	return FString::Printf(TEXT("%s_%s"), *GetWorld()->GetMapName(), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+}
+
+void UCombatAnalyticsSubsystem::Record(ECombatAnalyticsKind Kind, const AActor* Actor, FName SkillName, float Amount, uint8 AttackType, uint8 DamageType)
+{
+	if (!Ring) return;
+
+	FCombatAnalyticsRecord NewRecord;
+	NewRecord.Time = GetWorld()->GetTimeSeconds();
+	NewRecord.Amount = Amount;
+	NewRecord.SkillName = SkillName;
+	NewRecord.ActorId = Actor ? Actor->GetUniqueID() : 0;
+	NewRecord.Kind = Kind;
+	NewRecord.AttackType = AttackType;
+	NewRecord.DamageType = DamageType;
+
+	if (!Ring->Push(NewRecord))
+	{
+		NumDropped++;
+	}
+}
+
+void UCombatAnalyticsSubsystem::EndMatch()
+{
+	if (Worker)
+	{
+		Worker->EndMatch(MakeMatchName());
+	}
+}
+
+static FAutoConsoleCommandWithWorld EndAnalyticsMatchCommand(
+	TEXT("Combat.Analytics.EndMatch"),
+	TEXT("현재 매치의 전투 분석 기록을 파일로 쓰고 새 매치를 시작합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCombatAnalyticsSubsystem* Analytics = World ? World->GetSubsystem<UCombatAnalyticsSubsystem>() : nullptr)
+		{
+			Analytics->EndMatch();
+		}
+	}));
@@ -0,0 +1,106 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include <atomic>
+#include "CombatAnalytics.generated.h"
+
+/*
+ 전투 분석 파이프라인
+ 스킬별, 공격 종류별 피해, CC 유지 시간, 스킬 사용 횟수를 매치 단위로 모은다.
+ - 게임 스레드는 고정 크기 기록을 미리 잡아 둔 링 버퍼에 넣기만 한다. 잠금, 할당 없음. 가득 차면 버리고 개수만 센다.
+ - 백그라운드 스레드가 버퍼를 비우며 집계하고, 매치가 끝나면 파일로 쓴다.
+	Saved/CombatAnalytics/<매치>.ddca : 열 단위(시간, 종류, 스킬, 공격 종류, 피해 종류, 값, 액터) 원본 기록, zlib 압축
+	Saved/CombatAnalytics/<매치>_summary.csv : 스킬, 공격 종류별 집계
+ Combat.Analytics 1 일 때 서버 게임 월드에서만 동작한다.
+ */
+
+enum class ECombatAnalyticsKind : uint8
+{
+	//Amount = 최종 피해
+	Damage,
+	//Amount = 쿨타임
+	SkillUse,
+	//Amount = CC가 실제로 걸려 있던 시간(풀릴 때 기록), AttackType에 CombatCore::ECrowdControl
+	CrowdControl,
+};
+
+//고정 크기 기록, 게임 스레드에서 복사만 한다.
+struct FCombatAnalyticsRecord
+{
+	float Time = 0.f;
+	float Amount = 0.f;
+	FName SkillName;
+	uint32 ActorId = 0;
+	ECombatAnalyticsKind Kind = ECombatAnalyticsKind::Damage;
+	uint8 AttackType = 0;
+	uint8 DamageType = 0;
+};
+
+/**
+ * 생산자 하나(게임 스레드), 소비자 하나(분석 스레드)용 고정 크기 링 버퍼입니다.
+ * 용량은 2의 거듭제곱, 생성할 때 한 번만 할당합니다.
+ */
+class FCombatAnalyticsRing
+{
+public:
+	explicit FCombatAnalyticsRing(uint32 InCapacity);
+
+	//가득 차면 false
+	bool Push(const FCombatAnalyticsRecord& Record);
+	bool Pop(FCombatAnalyticsRecord& OutRecord);
+
+private:
+	TArray<FCombatAnalyticsRecord> Buffer;
+	uint32 Mask;
+	//캐시 라인을 나눠 생산자와 소비자가 서로의 라인을 건드리지 않게 한다.
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head{ 0 };
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail{ 0 };
+};
+
+class FCombatAnalyticsWorker;
+
+/**
+ * 매치 단위 전투 분석 서브시스템입니다.
+ * 월드가 시작되면 매치를 열고, 월드가 끝나거나 Combat.Analytics.EndMatch로 닫으면 파일을 씁니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatAnalyticsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static bool IsEnabled();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * 기록을 넣습니다. 게임 스레드에서만 호출합니다.
+	 * @param Kind 기록 종류
+	 * @param Actor 기록 주체(공격자, 사용자, CC 대상)
+	 * @param SkillName 스킬 이름
+	 * @param Amount 종류별 값
+	 * @param AttackType 공격 종류(EAttackType) 또는 CC 종류
+	 * @param DamageType 피해 종류(EDamageType)
+	 */
+	void Record(ECombatAnalyticsKind Kind, const AActor* Actor, FName SkillName, float Amount, uint8 AttackType = 0, uint8 DamageType = 0);
+
+	//현재 매치를 닫아 파일로 쓰고 새 매치를 연다.
+	void EndMatch();
+
+	//링 버퍼가 가득 차 버린 기록 수
+	uint32 GetDroppedCount() const { return NumDropped; }
+
+	static constexpr uint32 RingCapacity = 1 << 16;
+
+private:
+	FString MakeMatchName() const;
+
+	TUniquePtr<FCombatAnalyticsRing> Ring;
+	TUniquePtr<FCombatAnalyticsWorker> Worker;
+	uint32 NumDropped = 0;
+};
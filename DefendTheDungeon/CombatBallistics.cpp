@@ -0,0 +1,124 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatBallistics.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "HAL/IConsoleManager.h"
+
+namespace CombatBallistics
+{
+	FLaunchSolution SolveLaunch(const FVector& Start, const FVector& Target, float Speed, float GravityZ)
+	{
+		const FVector Delta = Target - Start;
+		float DirX, DirY, DirZ;
+		FLaunchSolution Solution;
+		Solution.bInRange = SolveLaunchComponents(Delta.X, Delta.Y, Delta.Z, Speed, GravityZ, DirX, DirY, DirZ, Solution.FlightTime);
+		Solution.Direction = FVector(DirX, DirY, DirZ);
+		return Solution;
+	}
+}
+
+void FCombatAimBatch::Reset(int32 ExpectedNum)
+{
+	for (TArray<float>* Column : { &DeltaX, &DeltaY, &DeltaZ, &Speed, &GravityZ })
+	{
+		Column->Reset(ExpectedNum);
+	}
+}
+
+int32 FCombatAimBatch::Add(const FVector& Start, const FVector& Target, float InSpeed, float InGravityZ)
+{
+	const FVector Delta = Target - Start;
+	DeltaX.Add(Delta.X);
+	DeltaY.Add(Delta.Y);
+	DeltaZ.Add(Delta.Z);
+	GravityZ.Add(InGravityZ);
+	return Speed.Add(InSpeed);
+}
+
+void FCombatAimBatch::SolveBatch()
+{
+	const int32 Count = Num();
+	DirX.SetNumUninitialized(Count);
+	DirY.SetNumUninitialized(Count);
+	DirZ.SetNumUninitialized(Count);
+	FlightTime.SetNumUninitialized(Count);
+	InRange.SetNumUninitialized(Count);
+
+	//열마다 연속된 메모리를 한 방향으로 훑는다. 요소 사이 의존이 없어 벡터화된다.
+	const float* RESTRICT InX = DeltaX.GetData();
+	const float* RESTRICT InY = DeltaY.GetData();
+	const float* RESTRICT InZ = DeltaZ.GetData();
+	const float* RESTRICT InSpeed = Speed.GetData();
+	const float* RESTRICT InGravity = GravityZ.GetData();
+	float* RESTRICT OutX = DirX.GetData();
+	float* RESTRICT OutY = DirY.GetData();
+	float* RESTRICT OutZ = DirZ.GetData();
+	float* RESTRICT OutTime = FlightTime.GetData();
+	uint8* RESTRICT OutInRange = InRange.GetData();
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		OutInRange[Index] = CombatBallistics::SolveLaunchComponents(InX[Index], InY[Index], InZ[Index], InSpeed[Index], InGravity[Index],
+			OutX[Index], OutY[Index], OutZ[Index], OutTime[Index]);
+	}
+}
+
+/**
+ * 사수 수만큼 조준을 스칼라 경로(요청마다 SolveLaunch)와 배치 경로로 풀어 비용을 비교합니다.
+ * 사용법 : Combat.Ballistics.Benchmark [Shooters=1000] [Frames=300]
+ */
+static FAutoConsoleCommand BallisticsBenchmarkCommand(
+	TEXT("Combat.Ballistics.Benchmark"),
+	TEXT("탄도 조준 스칼라, 배치 계산 비용을 측정합니다. [Shooters] [Frames]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumShooters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+		const int32 NumFrames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 300;
+		constexpr float GravityZ = -980.f;
+		constexpr float Speed = 1000.f;
+
+		FRandomStream Random(47);
+		TArray<FVector> Starts;
+		TArray<FVector> Targets;
+		for (int32 Index = 0; Index < NumShooters; Index++)
+		{
+			Starts.Add(FVector(Random.FRandRange(-5000.f, 5000.f), Random.FRandRange(-5000.f, 5000.f), Random.FRandRange(0.f, 300.f)));
+			Targets.Add(Starts.Last() + Random.GetUnitVector() * Random.FRandRange(100.f, 1200.f));
+		}
+
+		uint64 ScalarCycles = 0;
+		uint64 BatchCycles = 0;
+		int32 NumInRange = 0;
+		float Checksum = 0.f;
+		FCombatAimBatch Batch;
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			uint64 Start = FPlatformTime::Cycles64();
+			for (int32 Index = 0; Index < NumShooters; Index++)
+			{
+				const CombatBallistics::FLaunchSolution Solution = CombatBallistics::SolveLaunch(Starts[Index], Targets[Index], Speed, GravityZ);
+				Checksum += Solution.Direction.Z;
+			}
+			ScalarCycles += FPlatformTime::Cycles64() - Start;
+
+			Start = FPlatformTime::Cycles64();
+			Batch.Reset(NumShooters);
+			for (int32 Index = 0; Index < NumShooters; Index++)
+			{
+				Batch.Add(Starts[Index], Targets[Index], Speed, GravityZ);
+			}
+			Batch.SolveBatch();
+			BatchCycles += FPlatformTime::Cycles64() - Start;
+
+			Checksum += Batch.DirZ[Frame % NumShooters];
+		}
+		for (int32 Index = 0; Index < NumShooters; Index++)
+		{
+			NumInRange += Batch.IsInRange(Index);
+		}
+
+		const double ScalarMs = FPlatformTime::ToMilliseconds64(ScalarCycles);
+		const double BatchMs = FPlatformTime::ToMilliseconds64(BatchCycles);
+		MY_LOG(LogTemp, Log, TEXT("Combat.Ballistics.Benchmark: %d shooters x %d frames, scalar %.3f ms/frame, batch %.3f ms/frame, in range %d, checksum %f"),
+			NumShooters, NumFrames, ScalarMs / NumFrames, BatchMs / NumFrames, NumInRange, Checksum);
+	}));
@@ -0,0 +1,96 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ 탄도 조준 계산
+ 시작점, 목표점, 발사 속력, 중력으로 목표에 떨어지는 발사 방향을 닫힌 식으로 구한다. 반복, 트레이스 없음.
+	tanθ = (v² - sqrt(v⁴ - g(g·d² + 2·h·v²))) / (g·d)	d : 수평 거리, h : 높이 차, 낮은 궤도
+ 사거리 밖이면 근 안의 값을 0으로 두어 목표 방향으로 가장 멀리 가는 각도를 돌려주고 bInRange는 false가 된다.
+ 이 방향을 쓸지는 호출하는 쪽이 정한다.
+ 여러 사수(캐릭터, AI)를 한 번에 풀 때는 FCombatAimBatch에 SoA로 모아 SolveBatch를 부른다.
+ 요소마다 분기 없이 같은 식을 거치므로 컴파일러가 SIMD로 묶을 수 있다.
+ */
+namespace CombatBallistics
+{
+	struct FLaunchSolution
+	{
+		//단위 발사 방향
+		FVector Direction = FVector::ForwardVector;
+		//목표까지 비행 시간(초)
+		float FlightTime = 0.f;
+		//주어진 속력으로 목표에 닿을 수 있으면 true
+		bool bInRange = false;
+	};
+
+	/**
+	 * 한 요소의 발사 방향을 구합니다. 스칼라, 배치 경로 모두 이 식을 씁니다.
+	 * @param Dx, Dy, Dz 시작점에서 목표점까지 벡터
+	 * @param Speed 발사 속력(cm/s)
+	 * @param GravityZ 중력 가속도 Z(보통 음수), 0이면 직선
+	 * @return 사거리 안이면 true
+	 */
+	FORCEINLINE bool SolveLaunchComponents(float Dx, float Dy, float Dz, float Speed, float GravityZ,
+		float& OutDirX, float& OutDirY, float& OutDirZ, float& OutFlightTime)
+	{
+		const float G = FMath::Max(-GravityZ, 0.f);
+		const float V2 = Speed * Speed;
+		const float HorizontalSq = Dx * Dx + Dy * Dy;
+		const float Horizontal = FMath::Sqrt(HorizontalSq);
+		const float InvHorizontal = 1.f / FMath::Max(Horizontal, KINDA_SMALL_NUMBER);
+
+		const float Discriminant = V2 * V2 - G * (G * HorizontalSq + 2.f * Dz * V2);
+		const bool bInRange = Discriminant >= 0.f;
+		const float TanTheta = (V2 - FMath::Sqrt(FMath::Max(Discriminant, 0.f))) / FMath::Max(G * Horizontal, KINDA_SMALL_NUMBER);
+		const float CosTheta = FMath::InvSqrt(1.f + TanTheta * TanTheta);
+		const float SinTheta = TanTheta * CosTheta;
+
+		//중력이 없거나 바로 위아래면 직선으로 쏜다.
+		const float Length = FMath::Sqrt(HorizontalSq + Dz * Dz);
+		const float InvLength = 1.f / FMath::Max(Length, KINDA_SMALL_NUMBER);
+		const bool bStraight = G <= KINDA_SMALL_NUMBER || Horizontal <= KINDA_SMALL_NUMBER;
+
+		OutDirX = bStraight ? Dx * InvLength : Dx * InvHorizontal * CosTheta;
+		OutDirY = bStraight ? Dy * InvLength : Dy * InvHorizontal * CosTheta;
+		OutDirZ = bStraight ? Dz * InvLength : SinTheta;
+		OutFlightTime = (bStraight ? Length : Horizontal / FMath::Max(CosTheta, KINDA_SMALL_NUMBER)) / FMath::Max(Speed, KINDA_SMALL_NUMBER);
+		return bStraight || bInRange;
+	}
+
+	DEFENDTHEDUNGEON_API FLaunchSolution SolveLaunch(const FVector& Start, const FVector& Target, float Speed, float GravityZ);
+}
+
+/**
+ * 여러 사수의 조준 요청을 성분별 배열(SoA)로 모읍니다.
+ * 프레임마다 Reset 후 Add로 채우고 SolveBatch로 한 번에 풉니다. 배열은 재사용되어 할당이 반복되지 않습니다.
+ * IsInRange가 false인 요청의 방향은 가장 멀리 가는 각도이므로, 쓸지는 SolveLaunch와 마찬가지로 호출하는 쪽이 정합니다.
+ */
+struct DEFENDTHEDUNGEON_API FCombatAimBatch
+{
+	void Reset(int32 ExpectedNum = 0);
+	int32 Add(const FVector& Start, const FVector& Target, float Speed, float GravityZ);
+	int32 Num() const { return Speed.Num(); }
+
+	//모든 요청을 풉니다.
+	void SolveBatch();
+
+	FVector GetDirection(int32 Index) const { return FVector(DirX[Index], DirY[Index], DirZ[Index]); }
+	float GetFlightTime(int32 Index) const { return FlightTime[Index]; }
+	bool IsInRange(int32 Index) const { return InRange[Index] != 0; }
+
+	//입력, 시작점에서 목표점까지 벡터
+	TArray<float> DeltaX;
+	TArray<float> DeltaY;
+	TArray<float> DeltaZ;
+	TArray<float> Speed;
+	TArray<float> GravityZ;
+
+	//출력
+	TArray<float> DirX;
+	TArray<float> DirY;
+	TArray<float> DirZ;
+	TArray<float> FlightTime;
+	TArray<uint8> InRange;
+};
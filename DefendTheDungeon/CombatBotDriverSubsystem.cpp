@@ -0,0 +1,306 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatBotDriverSubsystem.h"
+
+#include "CombatComponent.h"
+#include "DefendTheDungeon/Character/DDCharacter.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+const UCombatBotDriverSubsystem::FNetProfile UCombatBotDriverSubsystem::NetProfiles[] =
+{
+	{ TEXT("Off"), 0, 0, 0 },
+	{ TEXT("Average"), 30, 10, 1 },
+	{ TEXT("Bad"), 75, 25, 3 },
+	{ TEXT("Terrible"), 150, 50, 5 },
+};
+
+namespace
+{
+	constexpr float HistogramBucketMs = 10.f;
+	constexpr int32 NumHistogramBuckets = 30;
+
+	ECombatActionState ToActionState(ECombatBotInput Input)
+	{
+		switch (Input)
+		{
+		case ECombatBotInput::Attack: return ECombatActionState::Attack;
+		case ECombatBotInput::SkillQ: return ECombatActionState::SkillQ;
+		case ECombatBotInput::Dash: return ECombatActionState::Dash;
+		case ECombatBotInput::Block: return ECombatActionState::Block;
+		default: return ECombatActionState::Idle;
+		}
+	}
+
+	float Percentile(const TArray<float>& Sorted, float P)
+	{
+		if (Sorted.Num() == 0) return 0.f;
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(P * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+}
+
+bool UCombatBotDriverSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!FParse::Param(FCommandLine::Get(), TEXT("CombatBot"))) return false;
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatBotDriverSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("CombatBotAPM="), ActionsPerMinute);
+	FParse::Value(CommandLine, TEXT("CombatBotDuration="), Duration);
+	FParse::Value(CommandLine, TEXT("CombatBotNetProfile="), NetProfileName);
+	FParse::Value(CommandLine, TEXT("CombatBotCsv="), CsvPath);
+	ActionsPerMinute = FMath::Max(ActionsPerMinute, 1.f);
+}
+
+void UCombatBotDriverSubsystem::Deinitialize()
+{
+	if (StartTime > 0.0 && !bFinished)
+	{
+		Finish();
+	}
+	Super::Deinitialize();
+}
+
+TStatId UCombatBotDriverSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatBotDriverSubsystem, STATGROUP_Tickables);
+}
+
+UCombatComponent* UCombatBotDriverSubsystem::FindLocalCombatComponent() const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const ADDCharacter* Character = PlayerController ? Cast<ADDCharacter>(PlayerController->GetPawn()) : nullptr;
+	return Character ? Character->GetCombatComponent() : nullptr;
+}
+
+void UCombatBotDriverSubsystem::ApplyNetProfile()
+{
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (!NetDriver) return;
+	bNetProfileApplied = true;
+
+#if DO_ENABLE_NET_TEST
+	for (const FNetProfile& Profile : NetProfiles)
+	{
+		if (NetProfileName != Profile.Name) continue;
+
+		//나가는 패킷, 들어오는 패킷 모두에 지연을 걸어 왕복 지연이 약 LagMs * 2가 되게 한다.
+		FPacketSimulationSettings Settings;
+		Settings.PktLag = Profile.LagMs;
+		Settings.PktLagVariance = Profile.JitterMs;
+		Settings.PktLoss = Profile.LossPercent;
+		Settings.PktIncomingLagMin = FMath::Max(Profile.LagMs - Profile.JitterMs, 0);
+		Settings.PktIncomingLagMax = Profile.LagMs + Profile.JitterMs;
+		Settings.PktIncomingLoss = Profile.LossPercent;
+		NetDriver->SetPacketSimulationSettings(Settings);
+
+		MY_LOG(LogTemp, Log, TEXT("CombatBot net profile %s, Lag %d, Jitter %d, Loss %d"), Profile.Name, Profile.LagMs, Profile.JitterMs, Profile.LossPercent);
+		return;
+	}
+	MY_LOG(LogTemp, Warning, TEXT("Unknown CombatBot net profile %s"), *NetProfileName);
+#else
+	MY_LOG(LogTemp, Warning, TEXT("Packet simulation is not available in this build, running without net profile"));
+#endif
+}
+
+void UCombatBotDriverSubsystem::Tick(float DeltaTime)
+{
+	if (bFinished) return;
+
+	UCombatComponent* CombatComponent = FindLocalCombatComponent();
+	if (!CombatComponent) return;
+
+	//캐릭터가 준비된 첫 프레임에 초기화
+	if (BoundCombatComponent != CombatComponent)
+	{
+		BoundCombatComponent = CombatComponent;
+		CombatComponent->SetLatencyProbeListener(this);
+
+		if (UAnimInstance* AnimInstance = CombatComponent->GetOwner<ADDCharacter>()->GetMesh()->GetAnimInstance())
+		{
+			AnimInstance->OnMontageStarted.AddUniqueDynamic(this, &UCombatBotDriverSubsystem::OnMontageStarted);
+		}
+	}
+
+	if (!bNetProfileApplied) ApplyNetProfile();
+
+	const double Now = FPlatformTime::Seconds();
+	if (StartTime == 0.0)
+	{
+		StartTime = Now;
+		NextPressTime = Now;
+	}
+
+	if (Now >= NextPressTime)
+	{
+		PressInput(CombatComponent, static_cast<ECombatBotInput>(NextInput));
+		NextInput = (NextInput + 1) % static_cast<uint8>(ECombatBotInput::MAX);
+		NextPressTime += 60.0 / ActionsPerMinute;
+	}
+
+	if (Now - StartTime >= Duration)
+	{
+		Finish();
+		FGenericPlatformMisc::RequestExit(false);
+	}
+}
+
+bool UCombatBotDriverSubsystem::PressInput(UCombatComponent* CombatComponent, ECombatBotInput Input)
+{
+	const double PressTime = FPlatformTime::Seconds();
+
+	bool bSent = false;
+	switch (Input)
+	{
+	case ECombatBotInput::Attack:
+		bSent = CombatComponent->Attack();
+		break;
+	case ECombatBotInput::SkillQ:
+		bSent = CombatComponent->SkillQ();
+		break;
+	case ECombatBotInput::Dash:
+		//Dash()는 키 입력 상태를 읽으므로 같은 검사 후 방향을 직접 넘긴다.
+		bSent = CombatComponent->IsDashReady() && CombatComponent->CanEnterState(ECombatActionState::Dash);
+		if (bSent) CombatComponent->Server_Dash(ENoWeaponDash::Front);
+		break;
+	case ECombatBotInput::Block:
+		bSent = CombatComponent->IsBlockReady() && CombatComponent->CanEnterState(ECombatActionState::Block);
+		if (bSent) CombatComponent->Block();
+		break;
+	default:
+		break;
+	}
+
+	if (!bSent)
+	{
+		NumBlocked++;
+		return false;
+	}
+
+	//요청과 같은 Reliable 채널로 바로 뒤에 보내, 서버가 그 요청을 판정한 직후에 받게 한다.
+	const int32 Sequence = NextSequence++;
+	CombatComponent->Server_LatencyProbe(Sequence);
+	PendingResults.Add({ Sequence, PressTime, Input });
+	PendingMontages.Add({ Sequence, PressTime, Input });
+	NumPressed++;
+	return true;
+}
+
+void UCombatBotDriverSubsystem::OnServerResult(int32 Sequence, bool bAccepted)
+{
+	if (bFinished) return;
+
+	const int32 Index = PendingResults.IndexOfByPredicate([Sequence](const FPendingInput& Pending) { return Pending.Sequence == Sequence; });
+	if (Index == INDEX_NONE) return;
+	const FPendingInput Pending = PendingResults[Index];
+	PendingResults.RemoveAt(Index);
+
+	if (!bAccepted)
+	{
+		NumDenied++;
+		//거절된 입력은 몽타주가 재생되지 않는다.
+		PendingMontages.RemoveAll([Sequence](const FPendingInput& Montage) { return Montage.Sequence == Sequence; });
+		return;
+	}
+
+	//두 끝 모두 클라이언트 시계, 편도는 핑의 절반을 빼서 추정한다.
+	const float RoundTripMs = static_cast<float>((FPlatformTime::Seconds() - Pending.PressTime) * 1000.0);
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const APlayerState* PlayerState = PlayerController ? PlayerController->PlayerState : nullptr;
+	const float PingMs = PlayerState ? PlayerState->GetPingInMilliseconds() : 0.f;
+
+	ServerRoundTrips.Add(RoundTripMs);
+	ServerLatencies.Add(FMath::Max(RoundTripMs - PingMs * 0.5f, 0.f));
+}
+
+void UCombatBotDriverSubsystem::OnMontageStarted(UAnimMontage* Montage)
+{
+	if (bFinished || PendingMontages.Num() == 0) return;
+
+	//이 몽타주를 재생하는 입력 중 가장 오래된 것, 피격 몽타주처럼 어느 입력의 것도 아니면 무시한다.
+	const UCombatComponent* CombatComponent = BoundCombatComponent.Get();
+	if (!CombatComponent) return;
+
+	const int32 Index = PendingMontages.IndexOfByPredicate([CombatComponent, Montage](const FPendingInput& Pending)
+	{
+		return CombatComponent->IsActionMontage(ToActionState(Pending.Input), Montage);
+	});
+	if (Index == INDEX_NONE) return;
+
+	MontageLatencies.Add(static_cast<float>((FPlatformTime::Seconds() - PendingMontages[Index].PressTime) * 1000.0));
+	PendingMontages.RemoveAt(Index);
+}
+
+void UCombatBotDriverSubsystem::Finish()
+{
+	bFinished = true;
+	if (UCombatComponent* CombatComponent = BoundCombatComponent.Get())
+	{
+		CombatComponent->SetLatencyProbeListener(nullptr);
+	}
+	WriteCsv();
+}
+
+void UCombatBotDriverSubsystem::WriteCsv() const
+{
+	const FString FullPath = FPaths::IsRelative(CsvPath) ? FPaths::Combine(FPaths::ProjectSavedDir(), CsvPath) : CsvPath;
+	const bool bWriteHeader = !IFileManager::Get().FileExists(*FullPath);
+
+	FString Csv;
+	if (bWriteHeader)
+	{
+		Csv += TEXT("NetProfile,APM,Metric,Pressed,BlockedOnClient,Denied,Samples,P50Ms,P95Ms,P99Ms,MaxMs");
+		for (int32 Bucket = 0; Bucket < NumHistogramBuckets; Bucket++)
+		{
+			Csv += FString::Printf(TEXT(",<%d"), static_cast<int32>((Bucket + 1) * HistogramBucketMs));
+		}
+		Csv += FString::Printf(TEXT(",>=%d\n"), static_cast<int32>(NumHistogramBuckets * HistogramBucketMs));
+	}
+
+	auto AppendMetric = [&](const TCHAR* Metric, const TArray<float>& Samples)
+	{
+		TArray<float> Sorted = Samples;
+		Sorted.Sort();
+
+		Csv += FString::Printf(TEXT("%s,%.0f,%s,%d,%d,%d,%d,%.2f,%.2f,%.2f,%.2f"),
+			*NetProfileName, ActionsPerMinute, Metric, NumPressed, NumBlocked, NumDenied, Sorted.Num(),
+			Percentile(Sorted, 0.5f), Percentile(Sorted, 0.95f), Percentile(Sorted, 0.99f),
+			Sorted.Num() > 0 ? Sorted.Last() : 0.f);
+
+		TArray<int32> Histogram;
+		Histogram.SetNumZeroed(NumHistogramBuckets + 1);
+		for (const float Sample : Sorted)
+		{
+			Histogram[FMath::Min(static_cast<int32>(Sample / HistogramBucketMs), NumHistogramBuckets)]++;
+		}
+		for (const int32 Count : Histogram)
+		{
+			Csv += FString::Printf(TEXT(",%d"), Count);
+		}
+		Csv += TEXT("\n");
+	};
+
+	AppendMetric(TEXT("PressToServerResult"), ServerRoundTrips);
+	AppendMetric(TEXT("PressToServerAction"), ServerLatencies);
+	AppendMetric(TEXT("PressToClientMontage"), MontageLatencies);
+
+	if (!FFileHelper::SaveStringToFile(Csv, *FullPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		MY_LOG(LogTemp, Error, TEXT("Failed to write combat bot csv %s"), *FullPath);
+		return;
+	}
+	MY_LOG(LogTemp, Log, TEXT("Combat bot latency written to %s"), *FullPath);
+}
@@ -0,0 +1,105 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatBotDriverSubsystem.generated.h"
+
+class UAnimMontage;
+class UCombatComponent;
+
+//봇이 누르는 입력
+UENUM()
+enum class ECombatBotInput : uint8
+{
+	Attack,
+	SkillQ,
+	Dash,
+	Block,
+	MAX UMETA(Hidden)
+};
+
+/**
+ * 입력 지연 측정용 헤드리스 봇 클라이언트입니다.
+ * -CombatBot 인자로 실행한 클라이언트에서만 생성되며, 로컬 캐릭터로 Attack/SkillQ/Dash/Block을 정해진 APM으로 입력합니다.
+ * 클라이언트에서 받아들여진 입력마다 아래 구간을 모두 클라이언트 시계로 측정합니다.
+ *	- 입력 ~ 서버 판정 결과 도착 : 요청 바로 뒤에 보낸 지연 프로브의 응답까지 걸린 왕복 시간
+ *	- 입력 ~ 서버 ActionCalled : 위 왕복 시간에서 핑의 절반(서버 -> 클라이언트 편도 추정)을 뺀 값
+ *	- 입력 ~ 클라이언트 몽타주 시작 : 그 입력의 행동 몽타주가 시작될 때까지, 피격 몽타주 등은 세지 않는다.
+ * 측정이 끝나면 p50/p95/p99와 10ms 단위 히스토그램을 CSV로 이어 씁니다.
+ *
+ * 실행 예시
+ *	DefendTheDungeon 127.0.0.1 -game -nullrhi -CombatBot -CombatBotAPM=180
+ *		-CombatBotNetProfile=Bad -CombatBotDuration=60 -CombatBotCsv=Profiling/CombatBotLatency.csv
+ *
+ * 네트워크 프로필(Off, Average, Bad, Terrible)은 패킷 지연, 지터, 손실을 흉내내며 비 Shipping 빌드에서만 적용됩니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatBotDriverSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//UCombatComponent::CL_LatencyProbeResult에서 호출
+	void OnServerResult(int32 Sequence, bool bAccepted);
+
+private:
+	struct FPendingInput
+	{
+		int32 Sequence;
+		double PressTime;
+		ECombatBotInput Input;
+	};
+
+	//네트워크 에뮬레이션 프로필
+	struct FNetProfile
+	{
+		const TCHAR* Name;
+		int32 LagMs;
+		int32 JitterMs;
+		int32 LossPercent;
+	};
+	static const FNetProfile NetProfiles[];
+
+	UCombatComponent* FindLocalCombatComponent() const;
+	void ApplyNetProfile();
+	//클라이언트에서 요청이 나갔으면 true, 쿨타임 등으로 막혔으면 프로브도 보내지 않는다.
+	bool PressInput(UCombatComponent* CombatComponent, ECombatBotInput Input);
+	void Finish();
+	void WriteCsv() const;
+
+	UFUNCTION()
+	void OnMontageStarted(UAnimMontage* Montage);
+
+	//설정
+	float ActionsPerMinute = 120.f;
+	float Duration = 60.f;
+	FString NetProfileName = TEXT("Off");
+	FString CsvPath = TEXT("Profiling/CombatBotLatency.csv");
+
+	//상태
+	TWeakObjectPtr<UCombatComponent> BoundCombatComponent;
+	TArray<FPendingInput> PendingResults;
+	TArray<FPendingInput> PendingMontages;
+	int32 NextSequence = 1;
+	uint8 NextInput = 0;
+	double NextPressTime = 0.0;
+	double StartTime = 0.0;
+	bool bNetProfileApplied = false;
+	bool bFinished = false;
+
+	//결과(ms)
+	TArray<float> ServerRoundTrips;
+	TArray<float> ServerLatencies;
+	TArray<float> MontageLatencies;
+	int32 NumPressed = 0;
+	int32 NumBlocked = 0;
+	int32 NumDenied = 0;
+};
@@ -0,0 +1,112 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatClock.h"
+
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	int32 ClockHz = 30;
+	FAutoConsoleVariableRef CVarClockHz(TEXT("Combat.Clock.Hz"), ClockHz, TEXT("전투 시계 주기(Hz), 월드가 시작될 때 적용됩니다."));
+}
+
+bool UCombatClock::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatClock::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	TickRate = FMath::Clamp(ClockHz, 1, 240);
+}
+
+TStatId UCombatClock::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatClock, STATGROUP_Tickables);
+}
+
+FCombatTimerHandle UCombatClock::SetTimer(const UObject* Owner, int32 DelayTicks, TFunction<void()> Callback, int32 LoopTicks)
+{
+	FTimer Timer;
+	Timer.DueTick = CurrentTick + FMath::Max(DelayTicks, 1);
+	Timer.Id = NextId++;
+	Timer.LoopTicks = LoopTicks;
+	Timer.Owner = Owner;
+	Timer.Callback = MoveTemp(Callback);
+
+	ActiveTimers.Add(Timer.Id);
+	const FCombatTimerHandle Handle{ Timer.Id };
+	Timers.HeapPush(MoveTemp(Timer), FTimerOrder());
+	return Handle;
+}
+
+void UCombatClock::ClearTimer(FCombatTimerHandle& Handle)
+{
+	//힙에서 바로 빼지 않고, 꺼낼 때 건너뛴다.
+	if (Handle.IsValid())
+	{
+		ActiveTimers.Remove(Handle.Id);
+	}
+	Handle.Invalidate();
+}
+
+void UCombatClock::Tick(float DeltaTime)
+{
+	const double TickSeconds = GetTickSeconds();
+	Accumulator += DeltaTime;
+
+	int32 NumSteps = 0;
+	while (Accumulator >= TickSeconds && NumSteps < MaxCatchUpTicks)
+	{
+		Accumulator -= TickSeconds;
+		Step();
+		NumSteps++;
+	}
+
+	//긴 멈춤(로딩, 디버거) 뒤에는 따라잡지 않고 버린다.
+	if (Accumulator >= TickSeconds)
+	{
+		MY_LOG(LogTemp, Verbose, TEXT("Combat clock dropped %.3f s"), Accumulator - FMath::Fmod(Accumulator, TickSeconds));
+		Accumulator = FMath::Fmod(Accumulator, TickSeconds);
+	}
+}
+
+void UCombatClock::Step()
+{
+	CurrentTick++;
+
+	while (Timers.Num() > 0 && Timers.HeapTop().DueTick <= CurrentTick)
+	{
+		FTimer Timer;
+		Timers.HeapPop(Timer, FTimerOrder(), EAllowShrinking::No);
+
+		if (!ActiveTimers.Contains(Timer.Id)) continue;
+		if (!Timer.Owner.IsValid())
+		{
+			ActiveTimers.Remove(Timer.Id);
+			continue;
+		}
+
+		if (Timer.LoopTicks > 0)
+		{
+			//반복 타이머는 실행 전에 다시 넣어 콜백 안에서 해제할 수 있게 한다.
+			FTimer Next;
+			Next.DueTick = Timer.DueTick + Timer.LoopTicks;
+			Next.Id = Timer.Id;
+			Next.LoopTicks = Timer.LoopTicks;
+			Next.Owner = Timer.Owner;
+			Next.Callback = Timer.Callback;
+			Timers.HeapPush(MoveTemp(Next), FTimerOrder());
+		}
+		else
+		{
+			ActiveTimers.Remove(Timer.Id);
+		}
+
+		Timer.Callback();
+	}
+}
@@ -0,0 +1,91 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatClock.generated.h"
+
+struct FCombatTimerHandle
+{
+	uint32 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Invalidate() { Id = 0; }
+};
+
+/**
+ * 고정 주기 전투 시계입니다.
+ * 쿨타임, 군중 제어 시간, 은신 시간, 장판 주기처럼 전투 판정에 쓰는 시간은 모두 이 시계의 정수 틱으로 잽니다.
+ *	- 주기는 Combat.Clock.Hz(기본 30), 월드 시작 시 한 번 읽는다.
+ *	- 서버 프레임이 주기보다 느리면 한 프레임에 여러 틱을 따라잡는다. 최대 MaxCatchUpTicks까지.
+ *	- 같은 틱의 타이머는 등록 순서대로 실행되므로 프레임 속도와 관계없이 결과가 같다.
+ *	- 연출 보간이 필요하면 GetInterpolationAlpha()로 다음 틱까지의 비율을 얻는다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatClock : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * 틱 타이머를 등록합니다.
+	 * @param Owner 소유 객체, 사라지면 실행하지 않는다.
+	 * @param DelayTicks 첫 실행까지의 틱 수, 최소 1
+	 * @param Callback 실행할 함수
+	 * @param LoopTicks 0보다 크면 이 간격으로 반복
+	 */
+	FCombatTimerHandle SetTimer(const UObject* Owner, int32 DelayTicks, TFunction<void()> Callback, int32 LoopTicks = 0);
+
+	//타이머를 해제합니다. 타이머 함수 안에서 자기 자신을 해제해도 된다.
+	void ClearTimer(FCombatTimerHandle& Handle);
+	bool IsTimerActive(const FCombatTimerHandle& Handle) const { return Handle.IsValid() && ActiveTimers.Contains(Handle.Id); }
+
+	//초를 틱으로 바꾼다. 반올림하며 최소 1틱
+	int32 SecondsToTicks(float Seconds) const { return FMath::Max(1, FMath::RoundToInt(Seconds * TickRate)); }
+
+	int64 GetTick() const { return CurrentTick; }
+	int32 GetTickRate() const { return TickRate; }
+	double GetTickSeconds() const { return 1.0 / TickRate; }
+
+	//현재 틱의 전투 시간(초)
+	double GetTime() const { return static_cast<double>(CurrentTick) / TickRate; }
+
+	//다음 틱까지 진행 비율 [0, 1)
+	float GetInterpolationAlpha() const { return static_cast<float>(Accumulator * TickRate); }
+
+	static constexpr int32 MaxCatchUpTicks = 8;
+
+private:
+	struct FTimer
+	{
+		int64 DueTick;
+		uint32 Id;
+		int32 LoopTicks;
+		TWeakObjectPtr<const UObject> Owner;
+		TFunction<void()> Callback;
+	};
+
+	//DueTick, 등록 순서 기준 최소 힙
+	struct FTimerOrder
+	{
+		bool operator()(const FTimer& A, const FTimer& B) const
+		{
+			return A.DueTick != B.DueTick ? A.DueTick < B.DueTick : A.Id < B.Id;
+		}
+	};
+
+	void Step();
+
+	TArray<FTimer> Timers;
+	TSet<uint32> ActiveTimers;
+	uint32 NextId = 1;
+	int64 CurrentTick = 0;
+	double Accumulator = 0.0;
+	int32 TickRate = 30;
+};
@@ -6,7 +6,24 @@
 #include "Ability/Effect/BarrierEffect.h"
 #include "Ability/Effect/GuardEffect.h"
 #include "Ability/Effect/StealthHeistEffect.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "Camera/CameraComponent.h"
+#include "CombatActionTrace.h"
+#include "CombatAnalytics.h"
+#include "CombatBallistics.h"
+#include "CombatBotDriverSubsystem.h"
+#include "CombatCosmeticRouter.h"
+#include "CombatEventBus.h"
+#include "CombatNetAccounting.h"
+#include "CombatProjectilePool.h"
+#include "CombatReplay.h"
+#include "CombatRewind.h"
+#include "CombatSim.h"
+#include "CombatSkillActorPool.h"
+#include "CombatStats.h"
+#include "CombatThreat.h"
+#include "CombatVisibility.h"
 #include "Component/Projectile/ProjectileShooterComponent.h"
 #include "DefendTheDungeon/Ability/Effect/DamageEffect.h"
 #include "DefendTheDungeon/Ability/Effect/EventBuffEffect.h"
@@ -21,12 +38,29 @@
 #include "DefendTheDungeon/Skill/MagicProjectile/GravityProjectile.h"
 #include "DefendTheDungeon/Skill/SpawnSkill/DarkMagicOrbSkill.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "HAL/IConsoleManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "Net/UnrealNetwork.h"
 #include "Skill/SkillActorHaveStatComp.h"
+#include "Tasks/Task.h"
 #include "UI/CombatWidget/SkillWidget.h"
 #include "UI/HUD/W_IngameHUD.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	float BlockMaxRewind = 0.2f;
+	FAutoConsoleVariableRef CVarBlockMaxRewind(TEXT("Combat.Block.MaxRewind"), BlockMaxRewind, TEXT("막기를 누른 시각을 과거로 인정하는 최대 시간(초)"));
+
+	bool bDebugAim = false;
+	FAutoConsoleVariableRef CVarDebugAim(TEXT("Combat.Debug.Aim"), bDebugAim, TEXT("프로젝타일 조준 지점, 크로스헤어 트레이스를 그립니다."));
+}
 
 // Sets default values for this component's properties
 UCombatComponent::UCombatComponent(): DDCharacter(nullptr)
@@ -57,6 +91,53 @@ UCombatComponent::UCombatComponent(): DDCharacter(nullptr)
 	CurAction.CancelLevel = ActionMax;
 }
 
+uint64 UCombatComponent::TotalRemoteCalls = 0;
+
+bool UCombatComponent::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+	TotalRemoteCalls++;
+	if (Function->HasAnyFunctionFlags(FUNC_NetMulticast))
+	{
+		COMBAT_COUNT(MulticastsSent, 1);
+	}
+
+	if (!FCombatNetAccounting::IsEnabled())
+	{
+		return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+	}
+
+	//전송 전후 송신 비트 차이로 RPC 비용을 잰다.
+	FCombatNetAccounting& Accounting = FCombatNetAccounting::Get();
+	Accounting.BeginRPC(this, Function);
+	const bool bProcessed = Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+	Accounting.EndRPC(this, Function);
+	return bProcessed;
+}
+
+void UCombatComponent::ProcessEvent(UFunction* Function, void* Parms)
+{
+	//서버가 받은 입력 RPC(원격, 리슨 서버 로컬 모두 여기를 지난다)를 녹화한다.
+	if (ReplaySlot != INDEX_NONE && Function->HasAnyFunctionFlags(FUNC_NetServer))
+	{
+		if (UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>(); Replay && Replay->IsRecording())
+		{
+			Replay->RecordInput(ReplaySlot, Function, Parms);
+		}
+	}
+
+	Super::ProcessEvent(Function, Parms);
+}
+
+void UCombatComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	if (FCombatNetAccounting::IsEnabled())
+	{
+		FCombatNetAccounting::Get().RecordPropertyChanges(this, NetShadowState);
+	}
+}
+
 void UCombatComponent::SetIngameplayerController_Implementation()
 {
 	if (!DDCharacter) LOG_RETURN(Error, TEXT("No DDCharacter"));
@@ -81,34 +162,136 @@ bool UCombatComponent::CanEquipItem() const
 void UCombatComponent::OnDamaged(AActor* InInstigator, float Damage, EAttackType DamageAttackType)
 {
 	//MY_LOG(LogTemp, Error, TEXT("Damage = %f"), Damage)
+	if (UCombatReplaySubsystem* Replay = GetReplayRecorder())
+	{
+		Replay->RecordDamage(ReplaySlot, Damage, static_cast<uint8>(DamageAttackType));
+	}
+
 	if (Damage > 0.f)
 	{
 		if (bStealthed) EndStealth();
+		RecordIncomingDamage(InInstigator, Damage);
+	}
+
+	if (UCombatEventBus* EventBus = GetWorld()->GetSubsystem<UCombatEventBus>())
+	{
+		EventBus->Publish(FCombatDamagedEvent{ GetOwner(), InInstigator, Damage, DamageAttackType });
 	}
 }
 
 bool UCombatComponent::CanPlayAction(int32 ActionLevel) const
 {
-	return ActionLevel <= CurAction.CancelLevel; // 더 높은 우선순위면 true
+	return CombatCore::CanPlayAction(ActionLevel, CurAction.CancelLevel); // 더 높은 우선순위면 true
+}
+
+uint64 UCombatComponent::ToCoreFunctionKey(const FName& FunctionName)
+{
+	//NAME_None은 0이 된다.
+	return (static_cast<uint64>(FunctionName.GetComparisonIndex().ToUnstableInt()) << 32) | static_cast<uint32>(FunctionName.GetNumber());
+}
+
+CombatCore::FActionDesc UCombatComponent::ToCoreAction(const FAction& Action)
+{
+	CombatCore::FActionDesc Desc;
+	Desc.Owner = Action.Owner;
+	Desc.ActionType = static_cast<uint8>(Action.ActionType.GetValue());
+	Desc.PlayFunction = ToCoreFunctionKey(Action.PlayFunctionName);
+	Desc.CancelFunction = ToCoreFunctionKey(Action.CancelFunctionName);
+	Desc.EndFunction = ToCoreFunctionKey(Action.EndFunctionName);
+	Desc.ActionLevel = Action.ActionLevel;
+	Desc.CancelLevel = Action.CancelLevel;
+	return Desc;
+}
+
+void UCombatComponent::SetDefaultAction()
+{
+	if (!CurAction.ActionName.IsNone() || ActionState != ECombatActionState::Idle)
+	{
+		CombatActionTrace::Record(CombatActionTrace::EEvent::End, GetOwner(), CurAction.ActionName, CurAction.ActionLevel, CurAction.CancelLevel, static_cast<uint8>(ActionState));
+	}
+	
+	CurAction.Owner = nullptr;
+	CurAction.ActionLevel = ActionMax;
+	CurAction.CancelLevel = ActionMax;
+	CurAction.ActionName = FName();
+	CurAction.CancelFunctionName = CurAction.EndFunctionName = CurAction.PlayFunctionName = FName();
+
+	ActionCalled.Clear();
+	ActionCancelCalled.Clear();
+
+	SetActionState(ECombatActionState::Idle);
+}
+
+void UCombatComponent::SetActionState(ECombatActionState NewState)
+{
+	ActionState = NewState;
+	OnRep_ActionState();
+}
+
+void UCombatComponent::OnRep_ActionState()
+{
+	bIsAttacking = ActionState == ECombatActionState::Attack;
+	bIsDashing = ActionState == ECombatActionState::Dash;
+	bSkillQ = ActionState == ECombatActionState::SkillQ;
+	bSkillE = ActionState == ECombatActionState::SkillE;
+	bSkillR = ActionState == ECombatActionState::SkillR;
+	bIsBlocking = ActionState == ECombatActionState::Block;
+	bKnockbacked = ActionState == ECombatActionState::KnockBack;
+	bBigKnockbacked = ActionState == ECombatActionState::BigKnockBack;
+	bStunned = ActionState == ECombatActionState::Stun;
+}
+
+bool UCombatComponent::EnterCrowdControlState(ECombatActionState CCState)
+{
+	check(CombatAction::IsCrowdControl(CCState));
+	if (!CanEnterState(CCState)) return false;
+
+	//진행 중인 액션은 취소 함수로 정리한다. 취소 함수가 없으면 기본 상태로 돌아간다.
+	if (ActionCancelCalled.IsBound())
+	{
+		CombatActionTrace::Record(CombatActionTrace::EEvent::Cancel, GetOwner(), CurAction.ActionName, CombatAction::GetActionLevel(CCState), CurAction.CancelLevel, static_cast<uint8>(ActionState));
+		ActionCancelCalled.Execute();
+		ActionCancelCalled.Clear();
+	}
+	//이전 CC 상태를 덮으면 그 CC 기록도 끝낸다. 상태와 기록이 어긋나지 않게 한다.
+	ClearCrowdControl(CombatCore::ToCrowdControl(CombatAction::ToCore(ActionState)));
+	SetDefaultAction();
+
+	CurAction.ActionLevel = CombatAction::GetActionLevel(CCState);
+	CurAction.CancelLevel = CombatAction::GetCancelLevel(CCState);
+	CurAction.ActionType = EActionType::CrowdControl;
+	SetActionState(CCState);
+	MarkCrowdControlHits();
+	
+	return true;
+}
+
+void UCombatComponent::ExitCrowdControlState(ECombatActionState CCState)
+{
+	if (ActionState == CCState)
+	{
+		ClearCrowdControl(CombatCore::ToCrowdControl(CombatAction::ToCore(CCState)));
+		SetDefaultAction();
+	}
 }
 
 bool UCombatComponent::CheckValidAction(const FAction& Action) const
 {
 	if (!Action.Owner->FindFunction(Action.PlayFunctionName))
 	{
-		MY_LOG(LogTemp, Error, TEXT("PlayFunction is Not Valid, Check Owener Member Function.  Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
+		COMBAT_ACTION_LOG(LogTemp, Error, TEXT("PlayFunction is Not Valid, Check Owener Member Function.  Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
 		return false;
 	}
 
 	if (!Action.CancelFunctionName.IsNone() && !Action.Owner->FindFunction(Action.CancelFunctionName))
 	{
-		MY_LOG(LogTemp, Error, TEXT("CancelFunction is Not Valid, Check Owener Member Function, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
+		COMBAT_ACTION_LOG(LogTemp, Error, TEXT("CancelFunction is Not Valid, Check Owener Member Function, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
 		return false;
 	}
 
 	if (!Action.EndFunctionName.IsNone() && !Action.Owner->FindFunction(Action.EndFunctionName))
 	{
-		MY_LOG(LogTemp, Error, TEXT("EndFunction is Not Valid, Check Owener Member Function, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
+		COMBAT_ACTION_LOG(LogTemp, Error, TEXT("EndFunction is Not Valid, Check Owener Member Function, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
 		return false;
 	}
 
@@ -117,52 +300,57 @@ bool UCombatComponent::CheckValidAction(const FAction& Action) const
 
 bool UCombatComponent::TryPlayAction_Internal(FAction& Action)
 {
-	if (GetNetMode() != NM_ListenServer)
+	COMBAT_SCOPE_CYCLE(TryPlayAction);
+
+	//리슨 서버, 데디케이티드 서버 모두 허용
+	if (!GetOwner() || !GetOwner()->HasAuthority())
 	{
-		MY_LOG(LogTemp, Error, TEXT("TryPlayAction Called in Client"));
+		COMBAT_ACTION_LOG(LogTemp, Error, TEXT("TryPlayAction Called in Client"));
 		return false;
 	}
-	
-	if (!CheckValidAction(Action)) return false;
 
-	if (Action.ActionLevel < 0) Action.ActionLevel = 0;
-	else if (Action.ActionLevel > ActionMax) Action.ActionLevel = ActionMax;
+	CombatActionTrace::Record(CombatActionTrace::EEvent::Request, GetOwner(), Action.ActionName, Action.ActionLevel, CurAction.CancelLevel, static_cast<uint8>(ActionState));
+	
+	if (!CheckValidAction(Action))
+	{
+		CombatActionTrace::Record(CombatActionTrace::EEvent::Fail, GetOwner(), Action.ActionName, Action.ActionLevel, CurAction.CancelLevel, static_cast<uint8>(ActionState));
+		return false;
+	}
 
-	if (Action.CancelLevel < 0) Action.CancelLevel = 0;
-	else if (Action.CancelLevel > ActionMax) Action.CancelLevel = ActionMax;
+	//우선순위 판정은 CombatCore에 위임한다.
+	CombatCore::FActionDesc Requested = ToCoreAction(Action);
+	CombatCore::FActionBindings Bindings;
+	const CombatCore::EPlayDecision Decision = CombatCore::DecidePlay(ToCoreAction(CurAction), Requested, Bindings);
+	Action.ActionLevel = Requested.ActionLevel;
+	Action.CancelLevel = Requested.CancelLevel;
 
-	if (!CanPlayAction(Action.ActionLevel))
+	if (Decision == CombatCore::EPlayDecision::Denied)
 	{
-		MY_LOG(LogTemp, Log, TEXT("Try Action Level %d < Cur Cancel Level %d, denied. Owner %s, ActionName %s, ActionType %s"), Action.ActionLevel, CurAction.CancelLevel, *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
+		CombatActionTrace::Record(CombatActionTrace::EEvent::Deny, GetOwner(), Action.ActionName, Action.ActionLevel, CurAction.CancelLevel, static_cast<uint8>(ActionState));
+		COMBAT_ACTION_LOG(LogTemp, Log, TEXT("Try Action Level %d < Cur Cancel Level %d, denied. Owner %s, ActionName %s, ActionType %s"), Action.ActionLevel, CurAction.CancelLevel, *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
 		return false;
 	}
 
-	//전 액션과 동일한 경우, 건너뛴다.
-	if (CurAction != Action)
+	if (Decision == CombatCore::EPlayDecision::Replace)
 	{
 		//이전 액션 취소 함수 호출
-		if (ActionCancelCalled.ExecuteIfBound()) ActionCancelCalled.Clear();
-
-		//취소 함수 바인딩
-		if (!Action.CancelFunctionName.IsNone())
-			ActionCancelCalled.BindUFunction(Action.Owner, Action.CancelFunctionName);
-
-		//취소 함수가 비워져 있을 땐, 기본 상태로 돌아간다 생각한다.
-		else
+		if (ActionCancelCalled.IsBound())
 		{
-			ActionEnded.BindUFunction(this, "SetDefaultAction");
+			CombatActionTrace::Record(CombatActionTrace::EEvent::Cancel, GetOwner(), CurAction.ActionName, Action.ActionLevel, CurAction.CancelLevel, static_cast<uint8>(ActionState));
+			ActionCancelCalled.Execute();
+			ActionCancelCalled.Clear();
 		}
 
-		//엔드 함수 바인딩
+		//취소 함수 바인딩, 비워져 있을 땐 기본 상태로 돌아간다 생각한다.
+		if (Bindings.bBindCancel)
+			ActionCancelCalled.BindUFunction(Action.Owner, Action.CancelFunctionName);
+
+		//엔드 함수 바인딩, 비워져 있을 땐 기본 상태로 돌아간다 생각한다.
 		ActionEnded.Clear();
-		if (!Action.EndFunctionName.IsNone())
+		if (Bindings.bBindEnd)
 			ActionEnded.BindUFunction(Action.Owner, Action.EndFunctionName);
-
-		//엔드 함수가 비워져 있을 땐, 기본 상태로 돌아간다 생각한다.
 		else
-		{
 			ActionEnded.BindUFunction(this, "SetDefaultAction");
-		}
 	
 		//새로운 액션 바인딩
 		ActionCalled.Clear();
@@ -170,14 +358,18 @@ bool UCombatComponent::TryPlayAction_Internal(FAction& Action)
 	}
 
 	//액션 실행
+	const int32 CompetingLevel = CurAction.CancelLevel;
 	if (ActionCalled.ExecuteIfBound())
 	{
-		MY_LOG(LogTemp, Log, TEXT("Action Called, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
+		CombatActionTrace::Record(CombatActionTrace::EEvent::Accept, GetOwner(), Action.ActionName, Action.ActionLevel, CompetingLevel, static_cast<uint8>(ActionState));
+		COMBAT_ACTION_LOG(LogTemp, Log, TEXT("Action Called, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
 		CurAction = Action;
+		BeginHitSwing();
 	}
 	else
 	{
-		MY_LOG(LogTemp, Warning, TEXT("Action Call Failed, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
+		CombatActionTrace::Record(CombatActionTrace::EEvent::Fail, GetOwner(), Action.ActionName, Action.ActionLevel, CompetingLevel, static_cast<uint8>(ActionState));
+		COMBAT_ACTION_LOG(LogTemp, Warning, TEXT("Action Call Failed, Owner %s, ActionName %s, ActionType %s"), *GetNameSafe(Action.Owner), *Action.ActionName.ToString(), *UEnum::GetValueAsString(Action.ActionType));
 		return false;
 	}
 	
@@ -186,7 +378,45 @@ bool UCombatComponent::TryPlayAction_Internal(FAction& Action)
 
 void UCombatComponent::Server_TryPlayAction_Implementation(FAction Action)
 {
-	TryPlayAction_Internal(Action);
+	const bool bAccepted = TryPlayAction_Internal(Action);
+	bLastRequestAccepted = bAccepted;
+}
+
+void UCombatComponent::Server_LatencyProbe_Implementation(int32 Sequence)
+{
+	//직전 요청의 판정이 이미 끝났으므로 바로 돌려준다.
+	CL_LatencyProbeResult(Sequence, bLastRequestAccepted);
+}
+
+void UCombatComponent::CL_LatencyProbeResult_Implementation(int32 Sequence, bool bAccepted)
+{
+	if (UCombatBotDriverSubsystem* Listener = LatencyProbeListener.Get())
+	{
+		Listener->OnServerResult(Sequence, bAccepted);
+	}
+}
+
+bool UCombatComponent::IsActionMontage(ECombatActionState State, const UAnimMontage* Montage) const
+{
+	if (!Montage) return false;
+
+	switch (State)
+	{
+	case ECombatActionState::Attack:
+		return AttackAnimMontage.Contains(Montage);
+	case ECombatActionState::Dash:
+		return DashAnimMontage.Contains(Montage);
+	case ECombatActionState::SkillQ:
+		return SkillAnimMontage.IsValidIndex(Skill_Q) && SkillAnimMontage[Skill_Q] == Montage;
+	case ECombatActionState::SkillE:
+		return SkillAnimMontage.IsValidIndex(Skill_E) && SkillAnimMontage[Skill_E] == Montage;
+	case ECombatActionState::SkillR:
+		return SkillAnimMontage.IsValidIndex(Skill_R) && SkillAnimMontage[Skill_R] == Montage;
+	case ECombatActionState::Block:
+		return BlockMontage == Montage;
+	default:
+		return false;
+	}
 }
 
 void UCombatComponent::TryPlayAction(FAction& Action)
@@ -220,9 +450,10 @@ bool UCombatComponent::Attack()
 		return false;
 	}
 
-	if (bIsAttacking) return false;
+	if (!CanEnterState(ECombatActionState::Attack)) return false;
 
-	FAction AttackAction(this, Attacking, FName("Attack_Action"), FName("Attack_Cancel"), FName("AttackEnd"), 4, 3, FName("Attack"));
+	FAction AttackAction(this, Attacking, FName("Attack_Action"), FName("Attack_Cancel"), FName("AttackEnd"),
+		CombatAction::GetActionLevel(ECombatActionState::Attack), CombatAction::GetCancelLevel(ECombatActionState::Attack), FName("Attack"));
 	Server_TryPlayAction(AttackAction);
 	
 	return true;
@@ -231,7 +462,8 @@ bool UCombatComponent::Attack()
 
 void UCombatComponent::AttackEnd()
 {
-	bIsAttacking = false;
+	//이미 다른 행동으로 넘어간 뒤 늦게 호출된 경우 무시한다.
+	if (ActionState != ECombatActionState::Attack) return;
 	SetDefaultAction();
 }
 
@@ -286,8 +518,10 @@ void UCombatComponent::Server_Dash_Implementation(ENoWeaponDash InDashSide)
 {
 	DashSide = InDashSide;
 	
-	FAction DashAction(this, EActionType::Skill, FName("Dash_Action"), FName("Dash_Cancel"), FName("DashEnd"), 3, 2);
-	TryPlayAction(DashAction);
+	FAction DashAction(this, EActionType::Skill, FName("Dash_Action"), FName("Dash_Cancel"), FName("DashEnd"),
+		CombatAction::GetActionLevel(ECombatActionState::Dash), CombatAction::GetCancelLevel(ECombatActionState::Dash));
+	const bool bAccepted = TryPlayAction_Internal(DashAction);
+	bLastRequestAccepted = bAccepted;
 
 }
 
@@ -321,7 +555,8 @@ bool UCombatComponent::SkillQ()
 
 	if (!bQReady) return false;
 
-	FAction SkillQAction(this, Skill, FName("SkillQ_Action"), FName("SkillQ_Cancel"), FName("SkillQEnd"), 3, 2, FName("SkillQ"));
+	FAction SkillQAction(this, Skill, FName("SkillQ_Action"), FName("SkillQ_Cancel"), FName("SkillQEnd"),
+		CombatAction::GetActionLevel(ECombatActionState::SkillQ), CombatAction::GetCancelLevel(ECombatActionState::SkillQ), FName("SkillQ"));
 	Server_TryPlayAction(SkillQAction);
 	
 	return true;
@@ -338,7 +573,8 @@ bool UCombatComponent::SkillE()
 
 	if (!bEReady) return false;
 	
-	FAction SkillEAction(this, Skill, FName("SkillE_Action"), FName("SkillE_Cancel"), FName("SkillEEnd"), 3, 2, FName("SkillE"));
+	FAction SkillEAction(this, Skill, FName("SkillE_Action"), FName("SkillE_Cancel"), FName("SkillEEnd"),
+		CombatAction::GetActionLevel(ECombatActionState::SkillE), CombatAction::GetCancelLevel(ECombatActionState::SkillE), FName("SkillE"));
 	Server_TryPlayAction(SkillEAction);
 	
 	return true;
@@ -354,7 +590,8 @@ bool UCombatComponent::SkillR()
 
 	if (!bRReady) return false;
 
-	FAction SkillRAction(this, Skill, FName("SkillR_Action"), FName("SkillR_Cancel"), FName("SkillREnd"), 3, 2, FName("SkillR"));
+	FAction SkillRAction(this, Skill, FName("SkillR_Action"), FName("SkillR_Cancel"), FName("SkillREnd"),
+		CombatAction::GetActionLevel(ECombatActionState::SkillR), CombatAction::GetCancelLevel(ECombatActionState::SkillR), FName("SkillR"));
 	Server_TryPlayAction(SkillRAction);
 	
 	return true;
@@ -373,15 +610,19 @@ void UCombatComponent::MC_PlayAttackMontage_Implementation(int32 CurComboCount)
 
 void UCombatComponent::DetectedHit()
 {
+	ReportActionHits(ECombatActionState::Attack);
 }
 void UCombatComponent::SkillQDetectedHit()
 {
+	ReportActionHits(ECombatActionState::SkillQ);
 }
 void UCombatComponent::SkillEDetectedHit()
 {
+	ReportActionHits(ECombatActionState::SkillE);
 }
 void UCombatComponent::SkillRDetectedHit()
 {
+	ReportActionHits(ECombatActionState::SkillR);
 }
 
 void UCombatComponent::SubWeaponSkill()
@@ -412,28 +653,28 @@ void UCombatComponent::SubWeaponSkill()
 
 void UCombatComponent::DashEnd()
 {
-	bIsDashing = false;
+	if (ActionState != ECombatActionState::Dash) return;
 	StartDashCoolTime();
 	SetDefaultAction();
 }
 
 void UCombatComponent::SkillQEnd()
 {
-	bSkillQ = false;
+	if (ActionState != ECombatActionState::SkillQ) return;
 	StartQCoolTime();
 	SetDefaultAction();
 }
 
 void UCombatComponent::SkillEEnd()
 {
-	bSkillE = false;
+	if (ActionState != ECombatActionState::SkillE) return;
 	StartECoolTime();
 	SetDefaultAction();
 }
 
 void UCombatComponent::SkillREnd()
 {
-	bSkillR = false;
+	if (ActionState != ECombatActionState::SkillR) return;
 	StartRCoolTime();
 	SetDefaultAction();
 }
@@ -478,7 +719,7 @@ void UCombatComponent::Server_Skill_Confirm_SubWeapon_Implementation()
 		{
 			StartECoolTime();
 			bAimingToGiveShield = false;
-			MC_ConfirmGiveShield();
+			SendCosmetic(ECombatCosmetic::ConfirmGiveShield);
 			GiveShield();
 			SetComponentTick(false);
 			SkillEEnd();
@@ -486,23 +727,32 @@ void UCombatComponent::Server_Skill_Confirm_SubWeapon_Implementation()
 		else if (bDarkMagicOrbSkill)
 		{
 			bDarkMagicOrbSkill = false;
-			MC_ConfirmGiveShield();
+			SendCosmetic(ECombatCosmetic::ConfirmGiveShield);
 			StartECoolTime();
 			SetComponentTick(false);
 
+			//이전 장판이 아직 판정 중이면 끝내고, 미리보기를 확정된 장판으로 넘긴다.
+			FinishActiveDarkMagicOrb();
 			if (DecalMagicOrbSkill)
 			{
 				DecalMagicOrbSkill->SpawnNS();
 			}
+			ActiveDarkMagicOrb = DecalMagicOrbSkill;
+			ActiveDarkMagicOrbLocation = DecalLocation;
+			DecalMagicOrbSkill = nullptr;
 
-			GetWorld()->GetTimerManager().SetTimer(DarkMagicOrbHandle, this, &UCombatComponent::DarkMagicOrbSkillRun, 0.2f, true);
+			//장판 주기는 전투 시계 틱으로 센다. 시전자가 많아도 한 틱에 몰리지 않게 스케줄러가 위상을 흩는다.
+			//슬로우를 거는 판정이므로 Normal, 예산을 넘어도 몇 틱 안에 실행되고 판정 횟수는 그대로다.
+			if (UCombatJobScheduler* Scheduler = GetWorld()->GetSubsystem<UCombatJobScheduler>())
+			{
+				DarkMagicOrbJob = Scheduler->Register(this, DarkMagicOrbPulseInterval, ECombatJobPriority::Normal, [this]() { DarkMagicOrbSkillRun(); });
+			}
 			SkillEEnd();
 		}
 		else if (bGravityProjectileShooted && IsValid(ShootedGravityProjectile))
 		{
 			//MY_LOG(LogTemp, Error, TEXT("다시 눌러봄"));
-			ShootedGravityProjectile->Destroy();
-			ShootedGravityProjectile = nullptr;
+			DetonateGravityProjectile();
 		}
 	}
 	else
@@ -524,20 +774,17 @@ void UCombatComponent::MC_ConfirmGiveShield_Implementation()
 
 void UCombatComponent::Attack_Cancel()
 {
-	bIsAttacking = false;
 	SetDefaultAction();
 }
 
 void UCombatComponent::SkillQ_Cancel()
 {
-	bSkillQ = false;
 	StartQCoolTime();
 	SetDefaultAction();
 }
 
 void UCombatComponent::SkillE_Cancel()
 {
-	bSkillE = false;
 	//보조무기 중단 추가
 	if (bAimingToGiveShield)
 	{
@@ -551,17 +798,12 @@ void UCombatComponent::SkillE_Cancel()
 		StartECoolTime();
 		SetComponentTick(false);
 
-		if (DecalMagicOrbSkill)
-		{
-			DecalMagicOrbSkill->K2_DestroyActor();
-			DecalMagicOrbSkill = nullptr;
-		}
+		ReleaseDarkMagicOrb();
 	}
 	else if (bGravityProjectileShooted && IsValid(ShootedGravityProjectile))
 	{
 		//MY_LOG(LogTemp, Error, TEXT("다시 눌러봄"));
-		ShootedGravityProjectile->Destroy();
-		ShootedGravityProjectile = nullptr;
+		DetonateGravityProjectile();
 	}
 
 	SetDefaultAction();
@@ -569,30 +811,49 @@ void UCombatComponent::SkillE_Cancel()
 
 void UCombatComponent::SkillR_Cancel()
 {
-	bSkillR = false;
 	StartRCoolTime();
 	SetDefaultAction();
 }
 
 void UCombatComponent::Dash_Cancel()
 {
-	bIsDashing = false;
 	StartDashCoolTime();
 	SetDefaultAction();
 }
 
+void UCombatComponent::RemoveTrackedEffect(UBaseStatComponent* FromStatComponent, FCombatEffectHandle& Handle)
+{
+	if (!Handle.IsSet()) return;
+
+	const ECombatEffectSlot Slot = EffectTable.GetSlot(Handle);
+	UBaseEffect* Effect = EffectTable.Release(Handle);
+
+	//이미 만료되어 스탯 컴포넌트가 뗀 효과는 다시 떼지 않는다. 두 번 떼면 스탯이 두 번 되돌아간다.
+	if (IsEffectActive(FromStatComponent, Slot, Effect))
+	{
+		FromStatComponent->RemoveEffect(Effect);
+	}
+}
+
+bool UCombatComponent::IsEffectActive(UBaseStatComponent* InStatComponent, ECombatEffectSlot Slot, const UBaseEffect* Effect)
+{
+	return InStatComponent && Effect && Slot != ECombatEffectSlot::MAX
+		&& InStatComponent->FindEffectByName(CombatEffect::GetEffectName(Slot)) == Effect;
+}
+
+UBaseEffect* UCombatComponent::FindTrackedEffect(ECombatEffectSlot Slot) const
+{
+	UBaseEffect* Effect = EffectTable.FindBySlot(Slot);
+	return IsEffectActive(StatComponent, Slot, Effect) ? Effect : nullptr;
+}
+
 void UCombatComponent::Block_Cancel()
 {
 	if(StatComponent)
 	{
-		UBaseEffect* PlayerGuardEffect = StatComponent->FindEffectByName("PlayerGuard");
-		if(PlayerGuardEffect)
-		{
-			StatComponent->RemoveEffect(PlayerGuardEffect);
-		}
+		RemoveTrackedEffect(StatComponent, GuardEffectHandle);
 	}
 	
-	bIsBlocking = false;
 	StartBlockCoolTime();
 	StopMontage(0.f, BlockMontage);
 	SetDefaultAction();
@@ -600,11 +861,11 @@ void UCombatComponent::Block_Cancel()
 
 void UCombatComponent::ResetBoolValByKnockbacked()
 {
-	bIsDashing = false;
-	bIsAttacking = false;
-	bSkillQ = false;
-	bSkillE = false;
-	bSkillR = false;
+	//CC 상태는 각자의 타이머가 해제한다.
+	if (!CombatAction::IsCrowdControl(ActionState))
+	{
+		SetDefaultAction();
+	}
 }
 
 void UCombatComponent::StopMontage_Implementation(float BlendOut, UAnimMontage* Montage)
@@ -649,19 +910,14 @@ void UCombatComponent::ResetValue()
 {
 	ComboCount = 0;
 	SkillComboCount = 0;
-	bIsAttacking = false;
-	bSkillQ = false;
-	bSkillE = false;
-	bSkillR = false;
-	bIsBlocking = false;
-	bQReady = true;
-	bEReady = true;
-	bRReady = true;
-	bDashReady = true;
-	bBlockReady = true;
-	bIsDashing = false;
-	bStunned = false;
-	bShocked = false;
+	SetDefaultAction();
+	CooldownBook.Reset();
+	for (int32 Type = 0; Type < static_cast<int32>(CombatCore::ECrowdControl::MAX); Type++)
+	{
+		ClearCrowdControl(static_cast<CombatCore::ECrowdControl>(Type));
+	}
+	CrowdControlBook.Reset();
+	SyncCombatBookFlags();
 
 	if (IngamePlayerController)
 	{
@@ -669,11 +925,20 @@ void UCombatComponent::ResetValue()
 		IngamePlayerController->Client_SetStunState(false);
 	}
 	
+	RecentDamage.Reset();
+	BlockPressTime = 0.0;
+	LastCrowdControlTime = -1.0;
+	EffectTable.Reset();
+	GuardEffectHandle.Invalidate();
+	StealthEffectHandle.Invalidate();
+	InvalidateStatCache();
+	MonsterStatCache.Reset();
+	
 	if (GetWorld())
 	{
-		GetWorld()->GetTimerManager().ClearTimer(QCoolTimeHandle);
-		GetWorld()->GetTimerManager().ClearTimer(ECoolTimeHandle);
-		GetWorld()->GetTimerManager().ClearTimer(RCoolTimeHandle);
+		ClearCombatTimer(QCoolTimeHandle);
+		ClearCombatTimer(ECoolTimeHandle);
+		ClearCombatTimer(RCoolTimeHandle);
 	}
 }
 
@@ -699,6 +964,8 @@ void UCombatComponent::SkillInterrupted(UAnimMontage *AnimMontage)
 
 void UCombatComponent::ShieldProvocation()
 {
+	COMBAT_SCOPE_CYCLE(ShieldProvocation);
+
 	//서버 단계에서 도발 코드
 	//MY_LOG(LogTemp, Log, TEXT("Provacation Activated"));
 
@@ -728,16 +995,23 @@ void UCombatComponent::ShieldProvocation()
 		IgnoreActors,
 		OverlappedActors
 	);
+	COMBAT_COUNT(Queries, 1);
+	COMBAT_COUNT(TargetsHit, OverlappedActors.Num());
 
 	// 검색 결과 로그 출력
 	if (bHit)
 	{
+		UCombatThreatSubsystem* Threat = GetWorld()->GetSubsystem<UCombatThreatSubsystem>();
 		for (AActor* FoundActor : OverlappedActors)
 		{
 			AMonsterBase* Monster = Cast<AMonsterBase>(FoundActor);
 			if (Monster)
 			{
 				Monster->SetProvocation(DDCharacter, 3);
+				if (Threat)
+				{
+					Threat->Taunt(Monster, DDCharacter, 3.f);
+				}
 			}
 		}
 	}
@@ -748,6 +1022,8 @@ void UCombatComponent::ShieldProvocation()
 
 void UCombatComponent::SwordHiding()
 {
+	COMBAT_SCOPE_CYCLE(SwordHiding);
+
 	if (!bStealthed)
 	{
 		if (!DDCharacter) return;
@@ -783,6 +1059,8 @@ void UCombatComponent::SwordHiding()
 				IgnoreActors,
 				OverlappedActors
 			);
+			COMBAT_COUNT(Queries, 1);
+			COMBAT_COUNT(TargetsHit, OverlappedActors.Num());
 
 			//MY_LOG(LogTemp, Warning, TEXT("Provacation Activated!, Num %d"), OverlappedActors.Num());
 			// 검색 결과 로그 출력
@@ -809,15 +1087,30 @@ void UCombatComponent::EndStealth()
 	
 	if (bStealthed)
 	{
-		UBaseEffect* HeistEffect = DDCharacter->GetStatComponent()->FindEffectByName("StealthHeist");
-		DDCharacter->GetStatComponent()->RemoveEffect(HeistEffect);
+		RemoveTrackedEffect(DDCharacter->GetStatComponent(), StealthEffectHandle);
 		
 		bStealthed = false;
-		GetWorld()->GetTimerManager().ClearTimer(StealthHandle);
+		ClearCombatTimer(StealthHandle);
+		UpdateVisibility();
 		MC_SetStealth(false);
 	}
 }
 
+void UCombatComponent::UpdateVisibility()
+{
+	if (UCombatEventBus* EventBus = GetWorld()->GetSubsystem<UCombatEventBus>())
+	{
+		EventBus->Publish(FCombatStealthEvent{ GetOwner(), bStealthed });
+	}
+
+	if (VisibilitySlot == INDEX_NONE) return;
+
+	if (UCombatVisibilitySubsystem* Visibility = GetWorld()->GetSubsystem<UCombatVisibilitySubsystem>())
+	{
+		Visibility->SetVisible(VisibilitySlot, !bStealthed);
+	}
+}
+
 void UCombatComponent::SetStealth()
 {
 	if(!GetOwner()->HasAuthority()) return;
@@ -826,6 +1119,7 @@ void UCombatComponent::SetStealth()
 	{
 		// 속도 이펙트 추가. 현재 더블스워드라면 이동속도 증가량 60%로 상향
 		UStealthHeistEffect* SpeedEffect = NewObject<UStealthHeistEffect>();
+		COMBAT_COUNT(EffectsCreated, 1);
 		float SpeedPercent = 0.3f;
 		if(DDCharacter->WeaponMode == EWeaponMode::DoubleSword)
 		{
@@ -833,20 +1127,28 @@ void UCombatComponent::SetStealth()
 		}
 		SpeedEffect->Initialize(GetOwner(), SpeedPercent);
 		DDCharacter->GetStatComponent()->ApplyEffect(SpeedEffect);
+		StealthEffectHandle = EffectTable.Add(SpeedEffect, ECombatEffectSlot::StealthHeist);
 		
 		bStealthed = true;
+		UpdateVisibility();
 		MC_SetStealth(true);
 
-		//캐릭터가 스텔스화 됐다는 것을 이 캐릭터를 감지한 몬스터들에게 전달
-		if (DDCharacter->OnCharacterStealthed.IsBound())
+		//은신한 캐릭터는 위협 표에서 빠진다.
+		if (UCombatThreatSubsystem* Threat = GetWorld()->GetSubsystem<UCombatThreatSubsystem>())
 		{
-			DDCharacter->OnCharacterStealthed.Broadcast(DDCharacter);
+			Threat->DropSource(DDCharacter);
 		}
-		GetWorld()->GetTimerManager().SetTimer(StealthHandle, this, &UCombatComponent::EndStealth, 10, false);
+
+		//캐릭터가 스텔스화 됐다는 것을 이 캐릭터를 감지한 몬스터들에게 바로 전달
+		//이벤트 버스 알림(UpdateVisibility)은 다음 버스 Flush에 가므로 한 틱 늦다. 바로 반응해야 하는 쪽은 아직 이 델리게이트를 쓴다.
+		DDCharacter->OnCharacterStealthed.Broadcast(DDCharacter);
+		StealthHandle = SetCombatTimer(StealthDuration, [this]() { EndStealth(); });
 	}
 	else
 	{
-		GetWorld()->GetTimerManager().SetTimer(StealthHandle, this, &UCombatComponent::EndStealth, 10, false);
+		//이미 은신 중이면 남은 시간을 처음부터 다시 센다.
+		ClearCombatTimer(StealthHandle);
+		StealthHandle = SetCombatTimer(StealthDuration, [this]() { EndStealth(); });
 	}
 }
 
@@ -887,7 +1189,7 @@ void UCombatComponent::MC_SetStealth_Implementation(bool bStealth)
 
 void UCombatComponent::GiveShield()
 {
-	float CurretHealth = DDCharacter->GetStatComponent()->GetCurrentValue(EAttributeType::MaxHealth);
+	float CurretHealth = GetCachedMaxHealth();
 	
 	if (OverlayedCharacter)
 	{
@@ -918,6 +1220,7 @@ void UCombatComponent::GiveShield()
 void UCombatComponent::ApplyBarrier(AActor* NewInstigator, float Amount)
 {
 	UBarrierEffect* BarrierEffect = NewObject<UBarrierEffect>();
+	COMBAT_COUNT(EffectsCreated, 1);
 	BarrierEffect->Initialize(NewInstigator, Amount);
 
 	StatComponent->ApplyEffect(BarrierEffect);
@@ -927,7 +1230,12 @@ void UCombatComponent::DarkMagicOrbSkill()
 {
 	if (bSkillE)
 	{
-		DecalMagicOrbSkill = GetWorld()->SpawnActor<ADarkMagicOrbSkill>(BP_MagicOrbDecal, FVector::ZeroVector, FRotator::ZeroRotator);
+		//시전마다 스폰하지 않고 풀에서 꺼낸다. 이전 미리보기가 남아 있으면 먼저 돌려준다. 판정 중인 장판은 그대로 둔다.
+		ReleaseDarkMagicOrb();
+		if (UCombatSkillActorPool* SkillPool = GetWorld()->GetSubsystem<UCombatSkillActorPool>())
+		{
+			DecalMagicOrbSkill = SkillPool->Acquire<ADarkMagicOrbSkill>(BP_MagicOrbDecal, FTransform::Identity, DDCharacter);
+		}
 		if (IsValid(DecalMagicOrbSkill))
 		{
 			bDarkMagicOrbSkill = true;
@@ -944,7 +1252,9 @@ void UCombatComponent::DarkMagicOrbSkill()
 
 void UCombatComponent::DarkMagicOrbSkillRun()
 {
-	FVector StartLocation = DecalLocation;
+	COMBAT_SCOPE_CYCLE(DarkMagicOrbSkillRun);
+
+	FVector StartLocation = ActiveDarkMagicOrbLocation;
 	FVector EndLocation = StartLocation;
 	float SphereRadius = 250.0f;
 
@@ -960,6 +1270,7 @@ void UCombatComponent::DarkMagicOrbSkillRun()
 			if (AMonsterBase *MonsterBase = Cast<AMonsterBase>(HitActor))
 			{
 				USlowEffect* SlowEffect = NewObject<USlowEffect>();
+				COMBAT_COUNT(EffectsCreated, 1);
 				//받는 데미지 증가 디버프 추가해야 함
 				if (MonsterBase->GetMonsterRole() == EMonsterRole::Boss)
 				{
@@ -984,13 +1295,52 @@ void UCombatComponent::DarkMagicOrbSkillRun()
 	}
 
 	
-	//MY_LOG(LogTemp, Warning, TEXT("DarkMagicOrbTime = %f"), DarkMagicOrbTime);
-	DarkMagicOrbTime += 0.2f;
-	if (DarkMagicOrbTime >= 4.f)
+	//MY_LOG(LogTemp, Warning, TEXT("DarkMagicOrbPulse = %d"), DarkMagicOrbPulse);
+	DarkMagicOrbPulse++;
+	if (DarkMagicOrbPulse >= DarkMagicOrbPulseCount)
+	{
+		FinishActiveDarkMagicOrb();
+	}
+}
+
+void UCombatComponent::ReleaseDarkMagicOrb()
+{
+	if (IsValid(DecalMagicOrbSkill))
+	{
+		if (UCombatSkillActorPool* SkillPool = GetWorld()->GetSubsystem<UCombatSkillActorPool>())
+		{
+			SkillPool->Release(DecalMagicOrbSkill);
+		}
+		else
+		{
+			DecalMagicOrbSkill->Destroy();
+		}
+	}
+	DecalMagicOrbSkill = nullptr;
+}
+
+void UCombatComponent::FinishActiveDarkMagicOrb()
+{
+	if (UCombatJobScheduler* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UCombatJobScheduler>() : nullptr)
+	{
+		Scheduler->Unregister(DarkMagicOrbJob);
+	}
+	DarkMagicOrbJob.Invalidate();
+	DarkMagicOrbPulse = 0;
+
+	if (IsValid(ActiveDarkMagicOrb))
 	{
-		GetWorld()->GetTimerManager().ClearTimer(DarkMagicOrbHandle);
-		DarkMagicOrbTime = 0.f;
+		//나이아가라를 바로 끊지 않고 남은 파티클이 사라진 뒤 돌려준다.
+		if (UCombatSkillActorPool* SkillPool = GetWorld()->GetSubsystem<UCombatSkillActorPool>())
+		{
+			SkillPool->ReleaseWhenFinished(ActiveDarkMagicOrb);
+		}
+		else
+		{
+			ActiveDarkMagicOrb->Destroy();
+		}
 	}
+	ActiveDarkMagicOrb = nullptr;
 }
 
 void UCombatComponent::GravityProjectile()
@@ -1001,26 +1351,147 @@ void UCombatComponent::GravityProjectile()
 		bGravityProjectileShooted = true;
 		FVector SpawnLocation = DDCharacter->GetMesh()->GetSocketLocation(TEXT("SkillActorSpawn"));
 		FRotator SpawnRotation = DDCharacter->GetController()->GetControlRotation();
-		ShootedGravityProjectile = ProjectileShooterComp->GetPreparedDisabledProjectile<AGravityProjectile>(SpawnLocation, SpawnRotation, DDCharacter, EDDCharacterPoolingProjectileType::BP_GravityProjectile);
+		RegisterProjectilePools();
+		UCombatProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UCombatProjectilePoolSubsystem>();
+		ShootedGravityProjectile = Pool ? Cast<AGravityProjectile>(Pool->Acquire(ProjectileShooterComp, static_cast<uint8>(EDDCharacterPoolingProjectileType::BP_GravityProjectile), SpawnLocation, SpawnRotation)) : nullptr;
+		if (!ShootedGravityProjectile)
+		{
+			//예비 풀을 등록하지 않았으면 슈터 컴포넌트 풀을 쓴다.
+			ShootedGravityProjectile = ProjectileShooterComp->GetPreparedDisabledProjectile<AGravityProjectile>(SpawnLocation, SpawnRotation, DDCharacter, EDDCharacterPoolingProjectileType::BP_GravityProjectile);
+		}
 		if (ShootedGravityProjectile)
 		{
+			//프로젝타일의 실제 중력으로 크로스헤어 지점에 떨어지는 각도를 구한다.
+			UProjectileMovementComponent* Movement = ShootedGravityProjectile->FindComponentByClass<UProjectileMovementComponent>();
+			FindTransformToShootProjectile(SpawnLocation, SpawnRotation, true, GravityProjectileSpeed, Movement ? Movement->GetGravityZ() : 0.f);
+			ShootedGravityProjectile->SetActorRotation(SpawnRotation);
+
 			ShootedGravityProjectile->StatComponent = DDCharacter->GetStatComponent();
 			ShootedGravityProjectile->SetOwner(DDCharacter);
-			ShootedGravityProjectile->Fire(ShootedGravityProjectile->GetActorForwardVector(), 1000.f);
-			GetWorld()->GetTimerManager().SetTimer(ShootedGravityProjectile->DestroyExploHandle, ShootedGravityProjectile, &AGravityProjectile::Destroy, 1, false);
+
+			UCombatProjectileSimSubsystem* ProjectileSim = GetWorld()->GetSubsystem<UCombatProjectileSimSubsystem>();
+			if (ProjectileSim && UCombatProjectileSimSubsystem::IsEnabled() && Movement)
+			{
+				//이동 컴포넌트 대신 배치 시뮬레이션이 움직이고, 액터는 보이는 용도로만 쓴다.
+				const UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(ShootedGravityProjectile->GetRootComponent());
+				FCombatProjectileSpawn Spawn;
+				Spawn.Location = ShootedGravityProjectile->GetActorLocation();
+				Spawn.Velocity = SpawnRotation.Vector() * GravityProjectileSpeed;
+				Spawn.GravityZ = Movement->GetGravityZ();
+				Spawn.Radius = Root ? Root->Bounds.SphereRadius : Spawn.Radius;
+				Spawn.LifeTime = GravityProjectileLifeTime;
+				if (Root)
+				{
+					Spawn.Channel = Root->GetCollisionObjectType();
+					Spawn.Responses = Root->GetCollisionResponseToChannels();
+				}
+				Spawn.Instigator = DDCharacter;
+				Spawn.Proxy = ShootedGravityProjectile;
+				//부딪히면 그 자리에서 터진다. 수명 종료는 아래 DestroyExploHandle이 처리한다.
+				Spawn.OnFinished = [WeakThis = TWeakObjectPtr<UCombatComponent>(this)](const FHitResult& Hit)
+				{
+					UCombatComponent* Self = WeakThis.Get();
+					if (!Self) return;
+
+					Self->GravityProjectileSim.Invalidate();
+					if (Hit.bBlockingHit && Self->bGravityProjectileShooted && IsValid(Self->ShootedGravityProjectile))
+					{
+						Self->DetonateGravityProjectile();
+					}
+				};
+
+				Movement->Deactivate();
+				ProjectileSim->Remove(GravityProjectileSim);
+				GravityProjectileSim = ProjectileSim->Launch(Spawn);
+			}
+			else
+			{
+				//배치 모드에서 쓰던 액터가 풀에서 돌아왔을 수 있다.
+				if (Movement && !Movement->IsActive())
+				{
+					Movement->Activate(true);
+				}
+				ShootedGravityProjectile->Fire(SpawnRotation.Vector(), GravityProjectileSpeed);
+			}
+			//수명이 끝나면 터뜨리고 풀에 돌려준다. 그 사이 다시 쐈으면 이 프로젝타일만 정리한다.
+			GetWorld()->GetTimerManager().SetTimer(ShootedGravityProjectile->DestroyExploHandle,
+				FTimerDelegate::CreateWeakLambda(this, [this, Projectile = ShootedGravityProjectile]()
+				{
+					if (Projectile == ShootedGravityProjectile)
+					{
+						DetonateGravityProjectile();
+					}
+					else if (IsValid(Projectile))
+					{
+						Projectile->Destroy();
+						ReleaseGravityProjectile(Projectile);
+					}
+				}),
+				GravityProjectileLifeTime, false);
 		}
 	}
 }
 
+void UCombatComponent::DetonateGravityProjectile()
+{
+	if (UCombatProjectileSimSubsystem* ProjectileSim = GetWorld()->GetSubsystem<UCombatProjectileSimSubsystem>())
+	{
+		ProjectileSim->Remove(GravityProjectileSim);
+	}
+	if (IsValid(ShootedGravityProjectile))
+	{
+		GetWorld()->GetTimerManager().ClearTimer(ShootedGravityProjectile->DestroyExploHandle);
+		ShootedGravityProjectile->Destroy();
+		ReleaseGravityProjectile(ShootedGravityProjectile);
+	}
+	ShootedGravityProjectile = nullptr;
+}
+
+void UCombatComponent::ReleaseGravityProjectile(AGravityProjectile* Projectile)
+{
+	//예비 풀에서 꺼낸 것이 아니면 풀이 무시한다.
+	if (UCombatProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UCombatProjectilePoolSubsystem>())
+	{
+		Pool->Release(ProjectileShooterComp, static_cast<uint8>(EDDCharacterPoolingProjectileType::BP_GravityProjectile), Projectile);
+	}
+}
+
+void UCombatComponent::RegisterProjectilePools()
+{
+	if (!GetOwner()->HasAuthority() || !DDCharacter || !ProjectileShooterComp) return;
+
+	UCombatProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UCombatProjectilePoolSubsystem>();
+	if (!Pool) return;
+
+	//장착한 보조 무기가 쏘는 프로젝타일만 미리 채운다.
+	//예비는 슈터 컴포넌트 풀을 거치지 않고 직접 스폰해, 슈터 풀이 같은 액터를 다시 내주지 않게 한다.
+	if (DDCharacter->SubWeaponMode == ESubWeaponMode::Sub_MagicWand && BP_GravityProjectile)
+	{
+		Pool->RegisterPool(ProjectileShooterComp, static_cast<uint8>(EDDCharacterPoolingProjectileType::BP_GravityProjectile), TEXT("GravityProjectile"),
+			[Class = BP_GravityProjectile, Owner = TWeakObjectPtr<ADDCharacter>(DDCharacter)](const FVector& Location, const FRotator& Rotation) -> AActor*
+			{
+				if (!Owner.IsValid()) return nullptr;
+
+				FActorSpawnParameters Params;
+				Params.Owner = Owner.Get();
+				Params.Instigator = Owner.Get();
+				Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+				return Owner->GetWorld()->SpawnActor<AGravityProjectile>(Class, Location, Rotation, Params);
+			});
+	}
+}
+
 void UCombatComponent::Stun(float Duration)
 {
-	if (!CanPlayAction(0)) return;
+	if (UCombatReplaySubsystem* Replay = GetReplayRecorder())
+	{
+		Replay->RecordCrowdControl(ReplaySlot, CombatCore::ECrowdControl::Stun, Duration);
+	}
+	if (!EnterCrowdControlState(ECombatActionState::Stun)) return;
 	
+	ApplyCrowdControl(CombatCore::ECrowdControl::Stun, Duration);
 	StopAllMontages();
-	SkillInterrupted(nullptr);
-	ResetBoolValByKnockbacked();
-	bStunned = true;
-	MC_StunMontage(true);
+	SendCosmetic(ECombatCosmetic::StunMontage, true);
 	
 	if (IngamePlayerController)
 	{
@@ -1029,18 +1500,17 @@ void UCombatComponent::Stun(float Duration)
 	}
 
 
-	FTimerDelegate TimerDelegate = FTimerDelegate::CreateWeakLambda(this, [this]()
+	ClearCombatTimer(StunTimerHandle);
+	StunTimerHandle = SetCombatTimer(Duration, [this]()
 	{
-		bStunned = false;
-		MC_StunMontage(false);
+		ExitCrowdControlState(ECombatActionState::Stun);
+		SendCosmetic(ECombatCosmetic::StunMontage, false, true);
 		if (IngamePlayerController)
 		{
 			IngamePlayerController->Client_BanSkillImage(false, true, true, true);
 			IngamePlayerController->Client_SetStunState(false);
 		}
 	});
-	
-	GetWorld()->GetTimerManager().SetTimer(StunTimerHandle, TimerDelegate, Duration, false);
 }
 
 void UCombatComponent::MC_StunMontage_Implementation(bool bInStunned)
@@ -1101,12 +1571,70 @@ void UCombatComponent::BeginPlay()
 		if (!StatComponent->OnDamagedDelegate.IsAlreadyBound(this, &UCombatComponent::OnDamaged))
 			StatComponent->OnDamagedDelegate.AddDynamic(this, &UCombatComponent::OnDamaged);
 		MY_LOG(LogTemp, Log, TEXT("On Damaged Dynamic binded"));
+
+		if (!OnLateBlockRefund.IsBoundToObject(this))
+			OnLateBlockRefund.AddUObject(this, &UCombatComponent::RefundLateBlockedDamage);
+	}
+
+	if (GetOwner()->HasAuthority())
+	{
+		if (UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>())
+		{
+			ReplaySlot = Replay->RegisterComponent(this);
+		}
+
+		if (UCombatVisibilitySubsystem* Visibility = GetWorld()->GetSubsystem<UCombatVisibilitySubsystem>())
+		{
+			VisibilitySlot = Visibility->Register(GetOwner(), ECombatTeam::Player);
+			Visibility->SetVisible(VisibilitySlot, !bStealthed);
+		}
+
+		//매치 시작 때 무기 구성에 맞춰 프로젝타일 예비 풀을 채운다.
+		RegisterProjectilePools();
 	}
 
+	PrewarmSkillActors();
+
 	SetComponentTickEnabled(false);
 	
 }
 
+void UCombatComponent::OnSubWeaponModeChanged()
+{
+	InvalidateStatCache();
+	RegisterProjectilePools();
+	PrewarmSkillActors();
+}
+
+void UCombatComponent::PrewarmSkillActors()
+{
+	//장판 스킬 액터는 첫 시전 전에 하나 만들어 둔다.
+	if (DDCharacter && DDCharacter->SubWeaponMode == ESubWeaponMode::Sub_DarkMagicOrb && (GetOwner()->HasAuthority() || DDCharacter->IsLocallyControlled()))
+	{
+		if (UCombatSkillActorPool* SkillPool = GetWorld()->GetSubsystem<UCombatSkillActorPool>())
+		{
+			SkillPool->Prewarm(BP_MagicOrbDecal, 1);
+		}
+	}
+}
+
+void UCombatComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseDarkMagicOrb();
+	FinishActiveDarkMagicOrb();
+
+	if (VisibilitySlot != INDEX_NONE)
+	{
+		if (UCombatVisibilitySubsystem* Visibility = GetWorld()->GetSubsystem<UCombatVisibilitySubsystem>())
+		{
+			Visibility->Unregister(VisibilitySlot);
+		}
+		VisibilitySlot = INDEX_NONE;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 
 void UCombatComponent::ResetAttackCombo()
 {
@@ -1128,7 +1656,11 @@ void UCombatComponent::ResetBeforeAttack()
 void UCombatComponent::StartQCoolTime()
 {
 	Client_StartQCoolTime();
-	GetWorld()->GetTimerManager().SetTimer(QCoolTimeHandle, this, &UCombatComponent::QReady, QCoolTime, false);
+	CooldownBook.Start(CombatCore::ECooldownSlot::Q, GetCombatTime(), QCoolTime);
+	SyncCombatBookFlags();
+	RecordAnalytics(ECombatAnalyticsKind::SkillUse, TEXT("SkillQ"), QCoolTime);
+	ClearCombatTimer(QCoolTimeHandle);
+	QCoolTimeHandle = SetCombatTimer(QCoolTime, [this]() { QReady(); });
 	//MY_LOG(LogTemp, Warning, TEXT("QCoolTimeStart : %f"), QCoolTime);
 }
 
@@ -1136,38 +1668,173 @@ void UCombatComponent::StartECoolTime()
 {
 	Client_StartECoolTime();
 
-	float NewECoolTime = ECoolTime;
+	const float NewECoolTime = GetEffectiveECoolTime();
+	
+	CooldownBook.Start(CombatCore::ECooldownSlot::E, GetCombatTime(), NewECoolTime);
+	SyncCombatBookFlags();
+	RecordAnalytics(ECombatAnalyticsKind::SkillUse, TEXT("SkillE"), NewECoolTime);
+	ClearCombatTimer(ECoolTimeHandle);
+	ECoolTimeHandle = SetCombatTimer(NewECoolTime, [this]() { EReady(); });
+	//MY_LOG(LogTemp, Warning, TEXT("ECoolTimeStart : %f"), ECoolTime);
+}
 
+float UCombatComponent::GetEffectiveECoolTime() const
+{
 	// 쌍검일 때 은신 대기시간이 줄어든다
-	if(DDCharacter->WeaponMode == EWeaponMode::DoubleSword)
+	if (DDCharacter && DDCharacter->WeaponMode == EWeaponMode::DoubleSword)
 	{
-		ECoolTime /= 3;
+		return ECoolTime / 3;
 	}
-	
-	GetWorld()->GetTimerManager().SetTimer(ECoolTimeHandle, this, &UCombatComponent::EReady, NewECoolTime, false);
-	//MY_LOG(LogTemp, Warning, TEXT("ECoolTimeStart : %f"), ECoolTime);
+	return ECoolTime;
 }
 
 void UCombatComponent::StartRCoolTime()
 {
 	Client_StartRCoolTime();
-	GetWorld()->GetTimerManager().SetTimer(RCoolTimeHandle, this, &UCombatComponent::RReady, RCoolTime, false);
+	CooldownBook.Start(CombatCore::ECooldownSlot::R, GetCombatTime(), RCoolTime);
+	SyncCombatBookFlags();
+	RecordAnalytics(ECombatAnalyticsKind::SkillUse, TEXT("SkillR"), RCoolTime);
+	ClearCombatTimer(RCoolTimeHandle);
+	RCoolTimeHandle = SetCombatTimer(RCoolTime, [this]() { RReady(); });
 	//MY_LOG(LogTemp, Warning, TEXT("RCoolTimeStart : %f"), RCoolTime);
 }
 
 void UCombatComponent::StartDashCoolTime()
 {
 	Client_StartDashCoolTime();
-	GetWorld()->GetTimerManager().SetTimer(DashCoolTimeHandle, this, &UCombatComponent::DashReady, DashCoolTime, false);
+	CooldownBook.Start(CombatCore::ECooldownSlot::Dash, GetCombatTime(), DashCoolTime);
+	SyncCombatBookFlags();
+	RecordAnalytics(ECombatAnalyticsKind::SkillUse, TEXT("Dash"), DashCoolTime);
+	ClearCombatTimer(DashCoolTimeHandle);
+	DashCoolTimeHandle = SetCombatTimer(DashCoolTime, [this]() { DashReady(); });
 }
 
 void UCombatComponent::StartBlockCoolTime()
 {
 	Client_StartBlockCoolTime();
-	GetWorld()->GetTimerManager().SetTimer(BlockCoolTimeHandle, this, &UCombatComponent::BlockReady, BlockCoolTime, false);
+	CooldownBook.Start(CombatCore::ECooldownSlot::Block, GetCombatTime(), BlockCoolTime);
+	SyncCombatBookFlags();
+	RecordAnalytics(ECombatAnalyticsKind::SkillUse, TEXT("Block"), BlockCoolTime);
+	ClearCombatTimer(BlockCoolTimeHandle);
+	BlockCoolTimeHandle = SetCombatTimer(BlockCoolTime, [this]() { BlockReady(); });
 	//MY_LOG(LogTemp, Warning, TEXT("BlockCoolTimeStart : %f"), BlockCoolTime);
 }
 
+void UCombatComponent::SyncCombatBookFlags()
+{
+	const double Now = GetCombatTime();
+	bQReady = CooldownBook.IsReady(CombatCore::ECooldownSlot::Q, Now);
+	bEReady = CooldownBook.IsReady(CombatCore::ECooldownSlot::E, Now);
+	bRReady = CooldownBook.IsReady(CombatCore::ECooldownSlot::R, Now);
+	bBlockReady = CooldownBook.IsReady(CombatCore::ECooldownSlot::Block, Now);
+	bDashReady = CooldownBook.IsReady(CombatCore::ECooldownSlot::Dash, Now);
+	bShocked = CrowdControlBook.IsActive(CombatCore::ECrowdControl::Shock, Now);
+}
+
+float UCombatComponent::GetRemainingCoolTime(CombatCore::ECooldownSlot Slot) const
+{
+	if (!GetWorld()) return 0.f;
+	return static_cast<float>(CooldownBook.GetRemaining(Slot, GetCombatTime()));
+}
+
+float UCombatComponent::GetRemainingCrowdControl(CombatCore::ECrowdControl Type) const
+{
+	if (!GetWorld()) return 0.f;
+	return static_cast<float>(CrowdControlBook.GetRemaining(Type, GetCombatTime()));
+}
+
+UCombatReplaySubsystem* UCombatComponent::GetReplayRecorder() const
+{
+	if (ReplaySlot == INDEX_NONE) return nullptr;
+
+	UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>();
+	return Replay && Replay->IsRecording() ? Replay : nullptr;
+}
+
+int32 UCombatComponent::DrawRandomRange(int32 Min, int32 Max)
+{
+	UCombatReplaySubsystem* Replay = ReplaySlot != INDEX_NONE ? GetWorld()->GetSubsystem<UCombatReplaySubsystem>() : nullptr;
+
+	int32 Value;
+	if (Replay && Replay->ConsumeRandom(ReplaySlot, Value))
+	{
+		return Value;
+	}
+	//재생 중에는 살아 있는 난수를 뽑지 않는다. 기록이 모자라면 desync로 세고 정해진 값을 쓴다.
+	if (Replay && Replay->IsReplaying())
+	{
+		return Min;
+	}
+
+	Value = FMath::RandRange(Min, Max);
+	if (Replay)
+	{
+		Replay->RecordRandom(ReplaySlot, Value);
+	}
+	return Value;
+}
+
+void UCombatComponent::ApplyCrowdControl(CombatCore::ECrowdControl Type, double Duration)
+{
+	const double Now = GetCombatTime();
+	CrowdControlBook.Apply(Type, Now, Duration);
+
+	//이미 걸려 있는 CC를 늘리면 처음 걸린 시각부터 잰다.
+	double& StartTime = CrowdControlStartTimes[static_cast<int32>(Type)];
+	if (StartTime < 0.0) StartTime = Now;
+}
+
+void UCombatComponent::ClearCrowdControl(CombatCore::ECrowdControl Type)
+{
+	if (Type == CombatCore::ECrowdControl::MAX) return;
+
+	CrowdControlBook.Clear(Type);
+
+	double& StartTime = CrowdControlStartTimes[static_cast<int32>(Type)];
+	if (StartTime < 0.0) return;
+
+	static const FName Names[] = { TEXT("Stun"), TEXT("Shock"), TEXT("KnockBack"), TEXT("BigKnockBack") };
+	static_assert(UE_ARRAY_COUNT(Names) == static_cast<int32>(CombatCore::ECrowdControl::MAX), "Names must match ECrowdControl");
+	RecordAnalytics(ECombatAnalyticsKind::CrowdControl, Names[static_cast<int32>(Type)], static_cast<float>(GetCombatTime() - StartTime), static_cast<uint8>(Type));
+	StartTime = -1.0;
+}
+
+void UCombatComponent::RecordAnalytics(ECombatAnalyticsKind Kind, FName Name, float Amount, uint8 Type)
+{
+	if (UCombatAnalyticsSubsystem* Analytics = GetWorld()->GetSubsystem<UCombatAnalyticsSubsystem>())
+	{
+		Analytics->Record(Kind, GetOwner(), Name, Amount, Type);
+	}
+}
+
+double UCombatComponent::GetCombatTime() const
+{
+	const UCombatClock* Clock = GetWorld() ? GetWorld()->GetSubsystem<UCombatClock>() : nullptr;
+	return Clock ? Clock->GetTime() : GetWorld()->GetTimeSeconds();
+}
+
+FCombatTimerHandle UCombatComponent::SetCombatTimer(float Seconds, TFunction<void()> Callback, bool bLoop)
+{
+	UCombatClock* Clock = GetWorld()->GetSubsystem<UCombatClock>();
+	if (!Clock)
+	{
+		MY_LOG(LogTemp, Error, TEXT("No CombatClock in this world"));
+		return FCombatTimerHandle();
+	}
+
+	const int32 Ticks = Clock->SecondsToTicks(Seconds);
+	return Clock->SetTimer(this, Ticks, MoveTemp(Callback), bLoop ? Ticks : 0);
+}
+
+void UCombatComponent::ClearCombatTimer(FCombatTimerHandle& Handle)
+{
+	if (UCombatClock* Clock = GetWorld() ? GetWorld()->GetSubsystem<UCombatClock>() : nullptr)
+	{
+		Clock->ClearTimer(Handle);
+	}
+	Handle.Invalidate();
+}
+
 void UCombatComponent::Client_StartQCoolTime_Implementation()
 {
 	
@@ -1186,7 +1853,7 @@ void UCombatComponent::Client_StartECoolTime_Implementation()
 	{
 		if(MyPC->IngameHUD && MyPC->IngameHUD->WBP_Skill_E)
 		{
-			MyPC->IngameHUD->WBP_Skill_E->StartCooldown(ECoolTime);
+			MyPC->IngameHUD->WBP_Skill_E->StartCooldown(GetEffectiveECoolTime());
 			//MY_LOG(LogTemp, Log, TEXT("ECoolTime %f"), ECoolTime);
 		}
 	}
@@ -1231,37 +1898,126 @@ void UCombatComponent::Client_StartDashCoolTime_Implementation()
 
 void UCombatComponent::QReady()
 {
-	bQReady = true;
+	CooldownBook.Finish(CombatCore::ECooldownSlot::Q, GetCombatTime());
+	SyncCombatBookFlags();
 	//MY_LOG(LogTemp, Error, TEXT("QReady"));
 }
 
 void UCombatComponent::EReady()
 {
-	bEReady = true;
+	CooldownBook.Finish(CombatCore::ECooldownSlot::E, GetCombatTime());
+	SyncCombatBookFlags();
 	//MY_LOG(LogTemp, Error, TEXT("EReady"));
 }
 
 void UCombatComponent::RReady()
 {
-	bRReady = true;
+	CooldownBook.Finish(CombatCore::ECooldownSlot::R, GetCombatTime());
+	SyncCombatBookFlags();
 	//MY_LOG(LogTemp, Error, TEXT("RReady"));
 }
 
 void UCombatComponent::BlockReady()
 {
-	bBlockReady = true;
+	CooldownBook.Finish(CombatCore::ECooldownSlot::Block, GetCombatTime());
+	SyncCombatBookFlags();
 	//MY_LOG(LogTemp, Error, TEXT("Block Ready"));
 }
 
 void UCombatComponent::DashReady()
 {
-	bDashReady = true;
+	CooldownBook.Finish(CombatCore::ECooldownSlot::Dash, GetCombatTime());
+	SyncCombatBookFlags();
 }
 
 void UCombatComponent::Block()
 {
-	FAction BlockAction(this, Attacking, FName("Block_Action"), FName("Block_Cancel"), FName("BlockEnd"), 3, 5, FName("Block"));
-	Server_TryPlayAction(BlockAction);
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	Server_Block(GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds());
+}
+
+void UCombatComponent::Server_Block_Implementation(double PressServerTime)
+{
+	//누른 시각은 측정된 핑 이상 과거일 수 없다.
+	const double Now = GetWorld()->GetTimeSeconds();
+	const APlayerState* PlayerState = DDCharacter ? DDCharacter->GetPlayerState() : nullptr;
+	const float MaxRewind = DDCharacter && !DDCharacter->IsLocallyControlled() && PlayerState
+		? FMath::Min(PlayerState->GetPingInMilliseconds() * 0.001f, BlockMaxRewind)
+		: 0.f;
+
+	//누른 시각은 이번 요청 안에서만 쓴다. Block_Action은 TryPlayAction_Internal 안에서 바로 실행되므로,
+	//받아들여지면 그때 읽고, 거절되면 다음 막기가 옛 시각을 쓰지 않도록 바로 지운다.
+	BlockPressTime = FMath::Clamp(PressServerTime, Now - MaxRewind, Now);
+	FAction BlockAction(this, Attacking, FName("Block_Action"), FName("Block_Cancel"), FName("BlockEnd"),
+		CombatAction::GetActionLevel(ECombatActionState::Block), CombatAction::GetCancelLevel(ECombatActionState::Block), FName("Block"));
+	const bool bAccepted = TryPlayAction_Internal(BlockAction);
+	BlockPressTime = 0.0;
+	bLastRequestAccepted = bAccepted;
+}
+
+void UCombatComponent::RecordIncomingDamage(AActor* DamageCauser, float Amount)
+{
+	if (Amount <= 0.f || !GetOwner()->HasAuthority()) return;
+
+	//되감기 범위 밖 기록은 버린다.
+	const double Now = GetWorld()->GetTimeSeconds();
+	RecentDamage.RemoveAll([Now](const FIncomingDamage& Damage) { return Now - Damage.Time > BlockMaxRewind; });
+	//맞은 순간 막기를 시작할 수 있었는지(행동 우선순위, 막기 쿨타임) 함께 남긴다.
+	const bool bBlockAllowed = CanEnterState(ECombatActionState::Block) && CooldownBook.IsReady(CombatCore::ECooldownSlot::Block, GetCombatTime());
+	RecentDamage.Add({ Now, DamageCauser, Amount, LastCrowdControlTime == Now, ActionState, bBlockAllowed });
+}
+
+void UCombatComponent::MarkCrowdControlHits()
+{
+	//스탯 컴포넌트가 CC를 피해 알림보다 먼저 걸 수도, 나중에 걸 수도 있어 양쪽에서 같은 프레임인지 본다.
+	const double Now = GetWorld()->GetTimeSeconds();
+	LastCrowdControlTime = Now;
+	for (FIncomingDamage& Damage : RecentDamage)
+	{
+		if (Damage.Time == Now) Damage.bCausedCrowdControl = true;
+	}
+}
+
+void UCombatComponent::RefundLateBlockedDamage(AActor* DamageCauser, float Amount)
+{
+	if (StatComponent)
+	{
+		StatComponent->Heal(Amount);
+	}
+}
+
+void UCombatComponent::ApplyReplayedDamage(float Damage, EAttackType DamageAttackType)
+{
+	if (!StatComponent) return;
+
+	StatComponent->ApplyDamage(nullptr, EDamageType::AdDamage, Damage, false, DamageAttackType, NAME_None);
+}
+
+void UCombatComponent::RefundDamageSince(double PressTime)
+{
+	//누른 뒤 처음으로 막기를 할 수 없던 피해부터는 되돌리지 않는다. 그 순간 공격 중이었거나 쿨타임이었다면
+	//누른 막기도 그때 받아들여질 수 없었다.
+	float Refunded = 0.f;
+	for (const FIncomingDamage& Damage : RecentDamage)
+	{
+		if (Damage.Time < PressTime) continue;
+		if (!Damage.bBlockAllowed)
+		{
+			COMBAT_ACTION_LOG(LogTemp, Log, TEXT("Late block stops at a hit taken in state %s"), *UEnum::GetValueAsString(Damage.ActionState));
+			break;
+		}
+		if (Damage.bCausedCrowdControl) continue;
+
+		OnLateBlockRefund.Broadcast(Damage.DamageCauser.Get(), Damage.Amount);
+		Refunded += Damage.Amount;
+	}
+	RecentDamage.Reset();
+
+	if (Refunded > 0.f)
+	{
+		SendCosmetic(ECombatCosmetic::BlockSuccess);
+		COMBAT_ACTION_LOG(LogTemp, Log, TEXT("Late block refunded %.1f damage"), Refunded);
+	}
 }
 
 void UCombatComponent::MC_Block_Implementation()
@@ -1280,15 +2036,11 @@ void UCombatComponent::MC_Block_Implementation()
 
 void UCombatComponent::BlockEnd()
 {
+	if (ActionState != ECombatActionState::Block) return;
 	if(StatComponent)
 	{
-		UBaseEffect* PlayerGuardEffect = StatComponent->FindEffectByName("PlayerGuard");
-		if(PlayerGuardEffect)
-		{
-			StatComponent->RemoveEffect(PlayerGuardEffect);
-		}
+		RemoveTrackedEffect(StatComponent, GuardEffectHandle);
 	}
-	bIsBlocking = false;
 	StartBlockCoolTime();
 	StopMontage(0.f, BlockMontage);
 	SetDefaultAction();
@@ -1297,91 +2049,107 @@ void UCombatComponent::BlockEnd()
 //넉백은 모든 몽타주를 중지시키고 캐릭터를 넘어트린다. 넉백 애니메이션 재생하는 동안 아무 행동도 할 수 없다.
 void UCombatComponent::KnockBackCharacter()
 {
-	if (!CanPlayAction(1)) return;
+	if (UCombatReplaySubsystem* Replay = GetReplayRecorder())
+	{
+		Replay->RecordCrowdControl(ReplaySlot, CombatCore::ECrowdControl::KnockBack, KnockBackDuration);
+	}
+	//진행 중인 액션을 취소하고 넉백 상태로 진입
+	if (!EnterCrowdControlState(ECombatActionState::KnockBack)) return;
 	//모든 몽타주 중지
+	ApplyCrowdControl(CombatCore::ECrowdControl::KnockBack, KnockBackDuration);
 	StopAllMontages();
-	//왜인지 모르게 방해가 브로드캐스트 안됨, 명시적 호출
-	ResetBoolValByKnockbacked();
 	
-	bKnockbacked = true;
-	KnockBackRandIndex = FMath::RandRange(0, 1);
+	KnockBackRandIndex = DrawRandomRange(0, 1);
 
 	MC_KnockBackMontage(KnockBackRandIndex);
 
-	FTimerDelegate TimerDelegate = FTimerDelegate::CreateWeakLambda(this, [this]
+	//혹시모를 초기화 코드
+	SetCombatTimer(KnockBackDuration, [this]
 	{
 		CL_SetbCanLook(true);
-		bKnockbacked = false;
+		ExitCrowdControlState(ECombatActionState::KnockBack);
 	});
-
-	//혹시모를 초기화 코드
-	FTimerHandle TimerHandle;
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, 0.5f, false);
 }
 
 void UCombatComponent::Attack_Action()
 {
 	ResetBeforeAttack();
-	bIsAttacking = true;
+	SetActionState(ECombatActionState::Attack);
 	MC_PlayAttackMontage(ComboCount);
 }
 
 void UCombatComponent::SkillQ_Action()
 {
-	bQReady = false;
-	bSkillQ = true;
-	bIsAttacking = false;
+	CooldownBook.Lock(CombatCore::ECooldownSlot::Q);
+	SyncCombatBookFlags();
+	SetActionState(ECombatActionState::SkillQ);
 		
 	MC_PlayQMontage();
 }
 
 void UCombatComponent::SkillE_Action()
 {
-	bEReady = false;
-	bSkillE = true;
-	bIsAttacking = false;
+	CooldownBook.Lock(CombatCore::ECooldownSlot::E);
+	SyncCombatBookFlags();
+	SetActionState(ECombatActionState::SkillE);
 		
 	MC_PlayEMontage();
 }
 
 void UCombatComponent::SkillR_Action()
 {
-	bRReady = false;
-	bSkillR = true;
-	bIsAttacking = false;
+	CooldownBook.Lock(CombatCore::ECooldownSlot::R);
+	SyncCombatBookFlags();
+	SetActionState(ECombatActionState::SkillR);
 		
 	MC_PlayRMontage();
 }
 
 void UCombatComponent::Dash_Action()
 {
-	bIsDashing = true;
-	bIsAttacking = false;
-	bDashReady = false;
+	SetActionState(ECombatActionState::Dash);
+	CooldownBook.Lock(CombatCore::ECooldownSlot::Dash);
+	SyncCombatBookFlags();
 
 	//Dash 중엔 방해를 받지 않는다.
-	MC_Dash(DashSide);
+	SendCosmetic(ECombatCosmetic::Dash, static_cast<uint8>(DashSide));
 }
 
 void UCombatComponent::Block_Action()
 {
-	if (bBlockReady)
+	if (CooldownBook.IsReady(CombatCore::ECooldownSlot::Block, GetCombatTime()))
 	{
-		bIsAttacking = false;
-		bIsBlocking = true;
-		bBlockReady = false;
+		SetActionState(ECombatActionState::Block);
+		CooldownBook.Lock(CombatCore::ECooldownSlot::Block);
+		SyncCombatBookFlags();
 		
-		//0.3초간 지속되는 Guard Effect 생성
+		//누른 시각부터 0.3초간 지속되는 Guard Effect 생성, 이미 지난 시간만큼 짧아진다.
+		const double Now = GetWorld()->GetTimeSeconds();
+		const double PressTime = BlockPressTime > 0.0 ? BlockPressTime : Now;
+		BlockPressTime = 0.0;
+
+		//이전 막기의 효과가 남아 있으면 떼고 핸들을 반납한 뒤 새로 붙인다.
+		RemoveTrackedEffect(StatComponent, GuardEffectHandle);
+
 		UGuardEffect* GuardEffect = NewObject<UGuardEffect>();
-		GuardEffect->Initialize(DDCharacter, 0.f, 0.3f);
+		COMBAT_COUNT(EffectsCreated, 1);
+		GuardEffect->Initialize(DDCharacter, 0.f, FMath::Max(GuardDuration - static_cast<float>(Now - PressTime), 0.05f));
 		StatComponent->ApplyEffect(GuardEffect);
+		GuardEffectHandle = EffectTable.Add(GuardEffect, ECombatEffectSlot::PlayerGuard);
+
+		//누른 뒤 막기가 서버에 도착하기 전에 처리된 피해
+		RefundDamageSince(PressTime);
 
 		//막기 애니메이션 지속 시간은 1초
-		FTimerHandle BlockDurationHandle;
-		GetWorld()->GetTimerManager().SetTimer(BlockDurationHandle, this, &UCombatComponent::BlockEnd, 1.f, false);
+		SetCombatTimer(1.f, [this]() { BlockEnd(); });
 		
 		MC_Block();
 	}
+	else
+	{
+		//쿨타임 중이면 막기 액션이 끝나지 않으므로 바로 기본 상태로 돌린다.
+		SetDefaultAction();
+	}
 }
 
 void UCombatComponent::MC_PlayQMontage_Implementation()
@@ -1426,27 +2194,24 @@ void UCombatComponent::MC_KnockBackMontage_Implementation(int RandNumber)
 
 void UCombatComponent::BigKnockBackCharacter()
 {
-	if (!CanPlayAction(0)) return;
+	if (UCombatReplaySubsystem* Replay = GetReplayRecorder())
+	{
+		Replay->RecordCrowdControl(ReplaySlot, CombatCore::ECrowdControl::BigKnockBack, BigKnockBackDuration);
+	}
+	if (!EnterCrowdControlState(ECombatActionState::BigKnockBack)) return;
 	
+	ApplyCrowdControl(CombatCore::ECrowdControl::BigKnockBack, BigKnockBackDuration);
 	StopAllMontages();
 	CL_SetbCanLook(false);
-	bBigKnockbacked = true;
-
-	ResetBoolValByKnockbacked();
 
 	MC_BigKnockBackMontage();
 
-	FTimerDelegate TimerDelegate = FTimerDelegate::CreateWeakLambda(this, [this]
+	//혹시모를 초기화 코드
+	SetCombatTimer(BigKnockBackDuration, [this]
 	{
 		CL_SetbCanLook(true);
-		ResetBoolValByKnockbacked();
-		
-		bBigKnockbacked = false;
+		ExitCrowdControlState(ECombatActionState::BigKnockBack);
 	});
-
-	//혹시모를 초기화 코드
-	FTimerHandle TimerHandle;
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, 2.2f, false);
 }
 
 void UCombatComponent::MC_BigKnockBackMontage_Implementation()
@@ -1460,24 +2225,30 @@ void UCombatComponent::MC_BigKnockBackMontage_Implementation()
 
 void UCombatComponent::ShockCharacter(float Duration)
 {
-	bShocked = true;
-	MC_ShockParticle(true);
+	if (UCombatReplaySubsystem* Replay = GetReplayRecorder())
+	{
+		Replay->RecordCrowdControl(ReplaySlot, CombatCore::ECrowdControl::Shock, Duration);
+	}
+	ApplyCrowdControl(CombatCore::ECrowdControl::Shock, Duration);
+	SyncCombatBookFlags();
+	MarkCrowdControlHits();
+	SendCosmetic(ECombatCosmetic::ShockParticle, true);
 	if (IngamePlayerController)
 	{
 		IngamePlayerController->Client_BanSkillImage(true, true, true, true);
 	}
 
-	FTimerDelegate TimerDelegate = FTimerDelegate::CreateWeakLambda(this, [this]()
+	ClearCombatTimer(ShockTimerHandle);
+	ShockTimerHandle = SetCombatTimer(Duration, [this]()
 	{
-		bShocked = false;
-		MC_ShockParticle(false);
+		ClearCrowdControl(CombatCore::ECrowdControl::Shock);
+		SyncCombatBookFlags();
+		SendCosmetic(ECombatCosmetic::ShockParticle, false, true);
 		if (IngamePlayerController)
 		{
 			IngamePlayerController->Client_BanSkillImage(false, true, true, true);
 		}
 	});
-	
-	GetWorld()->GetTimerManager().SetTimer(ShockTimerHandle, TimerDelegate, Duration, false);
 }
 
 void UCombatComponent::MC_ShockParticle_Implementation(bool bInShocked)
@@ -1497,6 +2268,37 @@ void UCombatComponent::MC_ShockParticle_Implementation(bool bInShocked)
 	}
 }
 
+void UCombatComponent::SendCosmetic(ECombatCosmetic Event, uint8 Param, bool bRequireDelivery)
+{
+	UCombatCosmeticRouter* Router = GetWorld()->GetSubsystem<UCombatCosmeticRouter>();
+	if (Router && Router->Dispatch(this, Event, Param, bRequireDelivery)) return;
+
+	switch (Event)
+	{
+	case ECombatCosmetic::Dash:					MC_Dash(static_cast<ENoWeaponDash>(Param));	break;
+	case ECombatCosmetic::BlockSuccess:			MC_BlockSuccess();							break;
+	case ECombatCosmetic::ShockParticle:		MC_ShockParticle(Param != 0);				break;
+	case ECombatCosmetic::StunMontage:			MC_StunMontage(Param != 0);					break;
+	case ECombatCosmetic::ConfirmGiveShield:	MC_ConfirmGiveShield();						break;
+	default:																				break;
+	}
+}
+
+void UCombatComponent::PlayCosmetic(ECombatCosmetic Event, uint8 Param)
+{
+	if (!DDCharacter) return;
+
+	switch (Event)
+	{
+	case ECombatCosmetic::Dash:					MC_Dash_Implementation(static_cast<ENoWeaponDash>(Param));	break;
+	case ECombatCosmetic::BlockSuccess:			MC_BlockSuccess_Implementation();							break;
+	case ECombatCosmetic::ShockParticle:		MC_ShockParticle_Implementation(Param != 0);				break;
+	case ECombatCosmetic::StunMontage:			MC_StunMontage_Implementation(Param != 0);					break;
+	case ECombatCosmetic::ConfirmGiveShield:	MC_ConfirmGiveShield_Implementation();						break;
+	default:																								break;
+	}
+}
+
 void UCombatComponent::MC_BlockSuccess_Implementation()
 {
 	FVector SpawnLocation = DDCharacter->GetMesh()->GetSocketLocation("SkillActorSpawn");
@@ -1515,8 +2317,7 @@ void UCombatComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Out
 	DOREPLIFETIME(UCombatComponent, DashCoolTime);
 	DOREPLIFETIME(UCombatComponent, AttackSpeed);
 	DOREPLIFETIME(UCombatComponent, bAimingToGiveShield);
-	DOREPLIFETIME(UCombatComponent, bSkillE);
-	DOREPLIFETIME(UCombatComponent, bIsAttacking);
+	DOREPLIFETIME(UCombatComponent, ActionState);
 	DOREPLIFETIME(UCombatComponent, bEReady);
 	DOREPLIFETIME(UCombatComponent, bQReady);
 	DOREPLIFETIME(UCombatComponent, bRReady);
@@ -1536,6 +2337,8 @@ void UCombatComponent::MC_SetWalkSpeed_Implementation(float walkspeed)
 bool UCombatComponent::SphereTrace(FVector StartLocation, FVector EndLocation, float SphereRadius,
 	TArray<FHitResult> &HitResults, bool bTraceCharacter)
 {
+	COMBAT_SCOPE_CYCLE(SphereTrace);
+
 	TArray<FHitResult> TempHitResults;
 
 	TArray<TEnumAsByte<EObjectTypeQuery>> types;
@@ -1566,6 +2369,7 @@ bool UCombatComponent::SphereTrace(FVector StartLocation, FVector EndLocation, f
 		FLinearColor::Green,                             // 디버그 구 색상
 		2.0f                                             // 디버그 지속 시간
 	);
+	COMBAT_COUNT(Queries, 1);
 
 	if (bHit)
 	{
@@ -1580,17 +2384,14 @@ bool UCombatComponent::SphereTrace(FVector StartLocation, FVector EndLocation, f
 			//중복 액터는 무시
 			if (AddedActors.Contains(HitActor)) continue;
 			
-			if ((bTraceCharacter && Cast<ADDCharacter>(HitActor)) ||
-				Cast<AMonsterBase>(HitActor) ||
-				Cast<ADamageableActor>(HitActor) ||
-				Cast<ASkillActorHaveStatComp>(HitActor) ||
-				Cast<ABuildingBase>(HitActor))
+			if (IsCombatTarget(HitActor, bTraceCharacter))
 			{
 				AddedActors.Add(HitActor);
 				HitResults.Add(HitResult);
 			}
 		}
 
+		COMBAT_COUNT(TargetsHit, AddedActors.Num());
 		if (HitResults.Num() > 0)
 		{
 			CrosshairHitReaction();
@@ -1600,6 +2401,190 @@ bool UCombatComponent::SphereTrace(FVector StartLocation, FVector EndLocation, f
 	return false;
 }
 
+bool UCombatComponent::IsCombatTarget(const AActor* Actor, bool bTraceCharacter)
+{
+	return (bTraceCharacter && Cast<ADDCharacter>(Actor)) ||
+		Cast<AMonsterBase>(Actor) ||
+		Cast<ADamageableActor>(Actor) ||
+		Cast<ASkillActorHaveStatComp>(Actor) ||
+		Cast<ABuildingBase>(Actor);
+}
+
+bool UCombatComponent::ReportLocalHits(FName ProfileName, FVector StartLocation, FVector EndLocation, float SphereRadius)
+{
+	if (!DDCharacter || !DDCharacter->IsLocallyControlled()) return false;
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_GameTraceChannel1);
+	ObjectParams.AddObjectTypesToQuery(ECC_GameTraceChannel9);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CombatReportLocalHits), false, DDCharacter);
+
+	TArray<FHitResult> HitResults;
+	GetWorld()->SweepMultiByObjectType(HitResults, StartLocation, EndLocation, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(SphereRadius), QueryParams);
+	COMBAT_COUNT(Queries, 1);
+
+	FCombatHitReport Report;
+	Report.ProfileName = ProfileName;
+	Report.Start = StartLocation;
+	Report.End = EndLocation;
+	Report.Radius = SphereRadius;
+
+	for (const FHitResult& HitResult : HitResults)
+	{
+		AActor* HitActor = HitResult.GetActor();
+		if (HitActor && IsCombatTarget(HitActor, false))
+		{
+			Report.Targets.AddUnique(HitActor);
+			if (Report.Targets.Num() >= MaxReportedTargets) break;
+		}
+	}
+	if (Report.Targets.Num() == 0) return false;
+
+	//다른 액터는 서버 상태보다 약 편도 지연만큼 늦게 보인다.
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const APlayerState* PlayerState = DDCharacter->GetPlayerState();
+	const double ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	const double HalfPing = PlayerState ? PlayerState->GetPingInMilliseconds() * 0.0005 : 0.0;
+	Report.ViewTime = ServerTime - HalfPing;
+
+	if (GetOwner()->HasAuthority())
+	{
+		ResolveReportedHits(Report);
+	}
+	else
+	{
+		Server_ReportHits(Report);
+	}
+	return true;
+}
+
+bool UCombatComponent::ReportActionHits(ECombatActionState Action)
+{
+	if (!DDCharacter || !DDCharacter->IsLocallyControlled()) return false;
+
+	for (const TPair<FName, FCombatHitProfile>& Pair : HitProfiles)
+	{
+		const FCombatHitProfile& Profile = Pair.Value;
+		if (Profile.Action != Action) continue;
+
+		//구의 앞 가장자리가 MaxReach에 닿도록 캐릭터 앞으로 스윕한다.
+		const FVector StartLocation = DDCharacter->GetActorLocation();
+		const FVector EndLocation = StartLocation + DDCharacter->GetActorForwardVector() * FMath::Max(Profile.MaxReach - Profile.MaxRadius, 0.f);
+		return ReportLocalHits(Pair.Key, StartLocation, EndLocation, Profile.MaxRadius);
+	}
+	return false;
+}
+
+void UCombatComponent::BeginHitSwing()
+{
+	HitSwing.Action = ActionState;
+	HitSwing.StartTime = GetWorld()->GetTimeSeconds();
+	HitSwing.NumReports = 0;
+	HitSwing.HitTargets.Reset();
+}
+
+void UCombatComponent::Server_ReportHits_Implementation(const FCombatHitReport& Report)
+{
+	ResolveReportedHits(Report);
+}
+
+int32 UCombatComponent::ResolveReportedHits(const FCombatHitReport& Report)
+{
+	if (!DDCharacter || CombatAction::IsCrowdControl(ActionState)) return 0;
+
+	const FCombatHitProfile* Profile = HitProfiles.Find(Report.ProfileName);
+	if (!Profile)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Unknown hit profile %s"), *Report.ProfileName.ToString());
+		return 0;
+	}
+
+	//지금 진행 중인 행동이 이 프로필의 행동이어야 한다.
+	if (ActionState != Profile->Action || HitSwing.Action != Profile->Action)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Rejected hit report %s, action %s is not in progress"), *Report.ProfileName.ToString(), *UEnum::GetValueAsString(Profile->Action));
+		return 0;
+	}
+
+	//보고는 클라이언트의 판정 구간보다 최대 왕복 지연만큼 늦게 도착한다. 지연은 되감기 최대 시간으로 자른다.
+	const APlayerState* PlayerState = DDCharacter->GetPlayerState();
+	const float Latency = DDCharacter->IsLocallyControlled() || !PlayerState
+		? 0.f
+		: FMath::Min(PlayerState->GetPingInMilliseconds() * 0.001f, UCombatRewindSubsystem::GetMaxRewindTime());
+	const double Elapsed = GetWorld()->GetTimeSeconds() - HitSwing.StartTime;
+	if (Elapsed < Profile->WindowStart || Elapsed > Profile->WindowEnd + Latency)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Rejected hit report %s, %.3f s is outside the hit window"), *Report.ProfileName.ToString(), Elapsed);
+		return 0;
+	}
+
+	if (++HitSwing.NumReports > MaxReportsPerSwing)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Rejected hit report %s, too many reports in one swing"), *Report.ProfileName.ToString());
+		return 0;
+	}
+
+	const UCombatRewindSubsystem* Rewind = GetWorld()->GetSubsystem<UCombatRewindSubsystem>();
+	const bool bRewind = Rewind && !DDCharacter->IsLocallyControlled();
+	const double ViewTime = bRewind ? Report.ViewTime : GetWorld()->GetTimeSeconds();
+	const float Tolerance = UCombatRewindSubsystem::GetTolerance();
+
+	//공격자 자신도 그 시각 위치에서 닿을 수 있는 스윕이어야 한다.
+	FVector AttackerLocation = DDCharacter->GetActorLocation();
+	if (bRewind)
+	{
+		float AttackerRadius = 0.f;
+		float AttackerHalfHeight = 0.f;
+		Rewind->GetRewoundCapsule(DDCharacter, ViewTime, AttackerLocation, AttackerRadius, AttackerHalfHeight);
+	}
+	if (Report.Radius > Profile->MaxRadius ||
+		FVector::Dist(AttackerLocation, Report.Start) > Profile->MaxReach + Tolerance ||
+		FVector::Dist(AttackerLocation, Report.End) > Profile->MaxReach + Tolerance)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Rejected hit report %s, sweep out of reach"), *Report.ProfileName.ToString());
+		return 0;
+	}
+
+	TArray<FCombatHitRequest, TInlineAllocator<MaxReportedTargets>> Hits;
+	const int32 NumTargets = FMath::Min(Report.Targets.Num(), MaxReportedTargets);
+	for (int32 Index = 0; Index < NumTargets; Index++)
+	{
+		AActor* Target = Report.Targets[Index];
+		if (!IsValid(Target) || Target == DDCharacter || !IsCombatTarget(Target, false)) continue;
+
+		//이번 스윙에서 이미 맞은 대상은 다시 맞지 않는다.
+		if (HitSwing.HitTargets.Contains(Target)) continue;
+
+		const bool bValid = bRewind
+			? Rewind->ValidateSweepHit(Target, ViewTime, Report.Start, Report.End, Report.Radius)
+			: true;
+		if (!bValid) continue;
+
+		HitSwing.HitTargets.Add(Target);
+
+		FCombatHitRequest& Hit = Hits.AddDefaulted_GetRef();
+		Hit.Target = Target;
+		Hit.AdScale = Profile->AdScale;
+		Hit.ApScale = Profile->ApScale;
+		Hit.bHasKnockback = Profile->bHasKnockback;
+		Hit.DamageType = Profile->DamageType;
+		Hit.AttackType = Profile->AttackType;
+		Hit.SkillName = Report.ProfileName;
+		Hit.HitEffectState = Profile->HitEffectState;
+	}
+
+	const int32 NumApplied = ApplyCombatDamageBatch(Hits);
+	COMBAT_COUNT(TargetsHit, NumApplied);
+	if (NumApplied > 0)
+	{
+		CrosshairHitReaction();
+	}
+	return NumApplied;
+}
+
 void UCombatComponent::CrosshairHitReaction()
 {
 	// Crosshair Reaction
@@ -1614,98 +2599,316 @@ void UCombatComponent::CrosshairHitReaction()
 
 void UCombatComponent::ApplyCombatDamage(AActor* TargetActor, float AdScale, float ApScale, bool bHasKnockback, EDamageType DamageType, EAttackType AttackType, FName SkillName, EHitEffectState HitEffectState, FVector HitLocation)
 {
-	UCharacterStatComponent* CharacterStatComponent = Cast<ADDCharacter>(GetOwner())->GetStatComponent();
-	if(!CharacterStatComponent) return;
+	COMBAT_SCOPE_CYCLE(ApplyCombatDamage);
+
+	if (!DDCharacter || !DDCharacter->GetStatComponent()) return;
+
+	FCombatHitRequest Hit;
+	Hit.Target = TargetActor;
+	Hit.AdScale = AdScale;
+	Hit.ApScale = ApScale;
+	Hit.bHasKnockback = bHasKnockback;
+	Hit.DamageType = DamageType;
+	Hit.AttackType = AttackType;
+	Hit.SkillName = SkillName;
+	Hit.HitEffectState = HitEffectState;
+	Hit.HitLocation = HitLocation;
+	ApplyCombatDamageBatch(MakeArrayView(&Hit, 1));
+}
+
+float UCombatComponent::GetCachedFinalDamage(EDamageType DamageType)
+{
+	const FCombatStatCache::ESlot Slot = DamageType == EDamageType::ApDamage ? FCombatStatCache::ESlot::AP : FCombatStatCache::ESlot::AD;
+	UCharacterStatComponent* StatComponent = DDCharacter->GetStatComponent();
+	return StatCache.Get(Slot, StatComponent->GetStatRevision(), [StatComponent, DamageType]()
+	{
+		return StatComponent->GetFinalDamage(DamageType);
+	});
+}
+
+float UCombatComponent::GetCachedMaxHealth()
+{
+	UCharacterStatComponent* StatComponent = DDCharacter->GetStatComponent();
+	return StatCache.Get(FCombatStatCache::ESlot::MaxHealth, StatComponent->GetStatRevision(), [StatComponent]()
+	{
+		return StatComponent->GetCurrentValue(EAttributeType::MaxHealth);
+	});
+}
+
+bool UCombatComponent::BuildSimLoadout(CombatCore::Sim::FLoadout& OutLoadout)
+{
+	using namespace CombatCore;
+	if (!DDCharacter) return false;
 
-	if(AttackType == EAttackType::NormalAttack)
+	Sim::FLoadout& Loadout = OutLoadout;
+	Loadout = Sim::FLoadout();
+	Loadout.Name = TCHAR_TO_UTF8(*FString::Printf(TEXT("%s+%s"),
+		*UEnum::GetDisplayValueAsText(DDCharacter->WeaponMode).ToString(),
+		*UEnum::GetDisplayValueAsText(DDCharacter->SubWeaponMode).ToString()));
+	Loadout.AD = GetCachedFinalDamage(EDamageType::AdDamage);
+	Loadout.AP = GetCachedFinalDamage(EDamageType::ApDamage);
+
+	const EDamageKind DamageKind = DDCharacter->WeaponMode == EWeaponMode::MagicWand ? EDamageKind::Ap : EDamageKind::Ad;
+
+	//기본 공격은 콤보 구간 하나가 한 번의 공격이다. AttackSpeed 배속으로 재생한다.
+	Sim::FActionSpec& Attack = Loadout.Actions[static_cast<int32>(Sim::EActionSlot::Attack)];
+	if (AttackAnimMontage.Num() > 0 && IsValid(AttackAnimMontage[0]))
 	{
-		DDCharacter->OnNormalAttackHit.Broadcast(TargetActor);
+		const UAnimMontage* Montage = AttackAnimMontage[0];
+		Attack.bEnabled = true;
+		Attack.State = EActionState::Attack;
+		Attack.Duration = Montage->GetPlayLength() / FMath::Max(1, Montage->GetNumSections()) / FMath::Max(AttackSpeed, KINDA_SMALL_NUMBER);
+		Attack.DamageKind = DamageKind;
 	}
-	
-	UMonsterStatComponent* MonsterStatComponent = nullptr;
-	if (AMonsterBase *MonsterBase = Cast<AMonsterBase>(TargetActor))
+
+	//스킬 계수는 초당 피해 배율이므로, 몽타주 1초마다 한 번 들어가는 타격으로 나눈다.
+	auto FillSkill = [&](Sim::EActionSlot Slot, int32 MontageIndex, EActionState State, ECooldownSlot CooldownSlot, float CoolTime, float AdRatio, float ApRatio)
+	{
+		if (!SkillAnimMontage.IsValidIndex(MontageIndex) || !IsValid(SkillAnimMontage[MontageIndex])) return;
+
+		Sim::FActionSpec& Spec = Loadout.Actions[static_cast<int32>(Slot)];
+		Spec.bEnabled = true;
+		Spec.State = State;
+		Spec.Duration = SkillAnimMontage[MontageIndex]->GetPlayLength();
+		Spec.Cooldown = CoolTime;
+		Spec.CooldownSlot = CooldownSlot;
+		Spec.Hits = FMath::Max(1, FMath::RoundToInt(Spec.Duration));
+		Spec.DamageKind = DamageKind;
+		Spec.AdScale = AdRatio;
+		Spec.ApScale = ApRatio;
+	};
+	FillSkill(Sim::EActionSlot::Q, Skill_Q, EActionState::SkillQ, ECooldownSlot::Q, QCoolTime, QAdRatio, QApRatio);
+	FillSkill(Sim::EActionSlot::E, Skill_E, EActionState::SkillE, ECooldownSlot::E, GetEffectiveECoolTime(), EAdRatio, EApRatio);
+	FillSkill(Sim::EActionSlot::R, Skill_R, EActionState::SkillR, ECooldownSlot::R, RCoolTime, RAdRatio, RApRatio);
+	return true;
+}
+
+/**
+ * 월드의 모든 캐릭터 무기 구성을 오프라인 시뮬레이터로 돌려 DPS, TTK 분포를 비교합니다.
+ * 같은 구성은 한 번만 돌리고, 결과는 로그와 Saved/CombatSim.csv에 남깁니다.
+ * 로드아웃은 게임 스레드에서 읽고, 시뮬레이션은 엔진 태스크(ParallelFor)로 나눠 돌리므로 결과는 나중에 로그로 나옵니다.
+ * 사용법 : Combat.Sim.Sweep [Fights=2000] [TargetHealth=5000] [EnemyCCInterval=6]
+ */
+static FAutoConsoleCommandWithWorldAndArgs SimSweepCommand(
+	TEXT("Combat.Sim.Sweep"),
+	TEXT("무기 구성별 DPS, TTK 분포를 오프라인 시뮬레이터로 계산합니다. [Fights] [TargetHealth] [EnemyCCInterval]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
 	{
-		MonsterStatComponent = MonsterBase->GetStatComponent();
+		if (!World) return;
 
-		//HitEffect 호출
-		if (HitLocation != FVector::ZeroVector)
+		const int32 NumFights = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+		CombatCore::Sim::FFightParams Params;
+		if (const UCombatClock* Clock = World->GetSubsystem<UCombatClock>())
 		{
-			FVector RelativeLocation = HitLocation - TargetActor->GetActorLocation();
-			//MY_LOG(LogTemp, Log, TEXT("RelativeLocation = %f, %f, %f"), RelativeLocation.X, RelativeLocation.Y, RelativeLocation.Z);
-			MonsterBase->GetHitEffectComponent()->Multicast_SpawnEffect(static_cast<int>(HitEffectState), nullptr, RelativeLocation);
+			Params.TickRate = Clock->GetTickRate();
 		}
-		else
-			MonsterBase->GetHitEffectComponent()->Multicast_SpawnEffect(static_cast<int>(HitEffectState), nullptr, TargetActor->GetActorLocation());
+		if (Args.Num() > 1) Params.TargetHealth = FMath::Max(1.f, FCString::Atof(*Args[1]));
+		if (Args.Num() > 2) Params.EnemyCCInterval = FMath::Max(0.f, FCString::Atof(*Args[2]));
+
+		std::vector<CombatCore::Sim::FLoadout> Loadouts;
+		TSet<FString> Seen;
+		for (TObjectIterator<UCombatComponent> It; It; ++It)
+		{
+			UCombatComponent* Component = *It;
+			CombatCore::Sim::FLoadout Loadout;
+			if (Component->GetWorld() != World || !Component->BuildSimLoadout(Loadout)) continue;
+
+			bool bAlreadySeen = false;
+			Seen.Add(UTF8_TO_TCHAR(Loadout.Name.c_str()), &bAlreadySeen);
+			if (!bAlreadySeen)
+			{
+				Loadouts.push_back(MoveTemp(Loadout));
+			}
+		}
+		if (Loadouts.empty()) LOG_RETURN(Warning, TEXT("Combat.Sim.Sweep: no combat components in this world"));
+
+		//시뮬레이션은 수 초 걸릴 수 있으므로 게임 스레드를 막지 않도록 태스크로 돌리고, 결과는 게임 스레드에서 남긴다.
+		//전투는 std::thread 대신 엔진 태스크 시스템의 ParallelFor로 나눈다.
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, [Loadouts = MoveTemp(Loadouts), Params, NumFights]()
+		{
+			const CombatCore::Sim::FParallelRunner Runner = [](int32_t NumChunks, const std::function<void(int32_t)>& Body)
+			{
+				ParallelFor(NumChunks, [&Body](int32 Chunk) { Body(Chunk); });
+			};
+
+			const double Start = FPlatformTime::Seconds();
+			std::vector<CombatCore::Sim::FSweepResult> Results = CombatCore::Sim::RunSweep(Loadouts, Params, NumFights, Runner);
+			const double ElapsedMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+			AsyncTask(ENamedThreads::GameThread, [Results = MoveTemp(Results), NumFights, ElapsedMs]()
+			{
+				for (const CombatCore::Sim::FSweepResult& Result : Results)
+				{
+					MY_LOG(LogTemp, Log, TEXT("Combat.Sim %s: DPS mean %.1f p5 %.1f p50 %.1f p95 %.1f, TTK mean %.2fs p5 %.2fs p50 %.2fs p95 %.2fs, timed out %d/%d"),
+						UTF8_TO_TCHAR(Result.Name.c_str()), Result.DPS.Mean, Result.DPS.P5, Result.DPS.P50, Result.DPS.P95,
+						Result.TimeToKill.Mean, Result.TimeToKill.P5, Result.TimeToKill.P50, Result.TimeToKill.P95, Result.NumTimedOut, Result.NumFights);
+				}
+				MY_LOG(LogTemp, Log, TEXT("Combat.Sim: %d loadouts x %d fights in %.1f ms"), static_cast<int32>(Results.size()), NumFights, ElapsedMs);
+
+				const FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CombatSim.csv"));
+				if (!FFileHelper::SaveStringToFile(FString(UTF8_TO_TCHAR(CombatCore::Sim::ToCsv(Results).c_str())), *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+				{
+					MY_LOG(LogTemp, Warning, TEXT("Combat.Sim: failed to write %s"), *Path);
+				}
+			});
+		});
+	}));
+
+void UCombatComponent::ClassifyHitTarget(FCombatHitRequest& Hit)
+{
+	if (AMonsterBase *MonsterBase = Cast<AMonsterBase>(Hit.Target))
+	{
+		Hit.Kind = FCombatHitRequest::ETargetKind::Monster;
+		Hit.Monster = MonsterBase;
+		Hit.MonsterStat = MonsterBase->GetStatComponent();
 	}
-	else if(ASkillActorHaveStatComp *SkillActorHaveStatComp = Cast<ASkillActorHaveStatComp>(TargetActor))
+	else if(ASkillActorHaveStatComp *SkillActorHaveStatComp = Cast<ASkillActorHaveStatComp>(Hit.Target))
 	{
-		MonsterStatComponent = SkillActorHaveStatComp->GetMonsterStatComponent();
+		Hit.Kind = FCombatHitRequest::ETargetKind::StatActor;
+		Hit.MonsterStat = SkillActorHaveStatComp->GetMonsterStatComponent();
 	}
-	else if (ADamageableActor *DamageableActor = Cast<ADamageableActor>(TargetActor))
+	else if (ADamageableActor *DamageableActor = Cast<ADamageableActor>(Hit.Target))
 	{
-		DamageableActor->Damaged(DDCharacter);
-		return;
+		Hit.Kind = FCombatHitRequest::ETargetKind::Damageable;
+		Hit.Damageable = DamageableActor;
 	}
 	else
 	{
-		return;
+		Hit.Kind = FCombatHitRequest::ETargetKind::None;
 	}
-	
-	float CharacterAD = CharacterStatComponent->GetFinalDamage(EDamageType::AdDamage);
-	float CharacterAP = CharacterStatComponent->GetFinalDamage(EDamageType::ApDamage);
 
-	if(DamageType == EDamageType::AdDamage)
+	//대상 측 피해 감소와 받는 피해 증가 버프는 해석 단계가 스탯 컴포넌트를 건드리지 않도록 여기서 읽어둔다.
+	//같은 몬스터를 여러 번 때려도 스탯 컴포넌트의 리비전이 그대로면 한 번만 계산한다.
+	if (UMonsterStatComponent* MonsterStat = Hit.MonsterStat)
+	{
+		const EDamageType DamageType = Hit.DamageType;
+		Hit.TargetDamageScale = MonsterStatCache.Get(MonsterStat, static_cast<uint8>(DamageType), MonsterStat->GetStatRevision(), [MonsterStat, DamageType]()
+		{
+			return MonsterStat->GetIncomingDamageScale(DamageType);
+		});
+	}
+}
+
+FCombatAttackerSnapshot UCombatComponent::GetAttackerSnapshot()
+{
+	FCombatAttackerSnapshot Attacker;
+	Attacker.AD = GetCachedFinalDamage(EDamageType::AdDamage);
+	Attacker.AP = GetCachedFinalDamage(EDamageType::ApDamage);
+	return Attacker;
+}
+
+FCombatFlushSinks UCombatComponent::GetFlushSinks() const
+{
+	FCombatFlushSinks Sinks;
+	Sinks.Threat = GetWorld()->GetSubsystem<UCombatThreatSubsystem>();
+	Sinks.EventBus = GetWorld()->GetSubsystem<UCombatEventBus>();
+	Sinks.Analytics = GetWorld()->GetSubsystem<UCombatAnalyticsSubsystem>();
+	return Sinks;
+}
+
+int32 UCombatComponent::ApplyCombatDamageBatch(TArrayView<FCombatHitRequest> Hits)
+{
+	COMBAT_SCOPE_CYCLE(ApplyCombatDamage);
+
+	if (Hits.Num() == 0 || !DDCharacter || !DDCharacter->GetStatComponent()) return 0;
+
+	//1. 게임 스레드 : 대상 분류와 대상 피해 배율, 공격자 스탯과 서브시스템은 배치마다 한 번만 읽는다.
+	if (MonsterStatCache.Num() > MaxMonsterStatCacheEntries)
 	{
-		MonsterStatComponent->ApplyDamage(GetOwner(), DamageType, CharacterAD * AdScale, bHasKnockback, AttackType, SkillName);
-		return;
+		MonsterStatCache.RemoveStale();
 	}
-	if(DamageType == EDamageType::ApDamage)
+	for (FCombatHitRequest& Hit : Hits)
 	{
-		MonsterStatComponent->ApplyDamage(GetOwner(), DamageType, CharacterAP * ApScale, bHasKnockback, AttackType, SkillName);
+		ClassifyHitTarget(Hit);
 	}
+	const FCombatAttackerSnapshot Attacker = GetAttackerSnapshot();
+
+	//2. 해석 : 히트마다 자기 슬롯에만 기록한다.
+	//Flush 중 델리게이트에서 다시 호출될 수 있으므로 버퍼는 호출마다 따로 둔다.
+	FCombatCommandBuffer CommandBuffer;
+	CommandBuffer.Reset(Hits.Num());
+	ParallelFor(Hits.Num(), [&Hits, &Attacker, &CommandBuffer](int32 Index)
+	{
+		CombatDamage::ResolveHit(Index, Hits[Index], Attacker, CommandBuffer);
+	}, Hits.Num() < CombatDamage::ParallelResolveThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	//3. 게임 스레드 : 부수 효과를 히트 순서대로 한 번에 실행
+	return CommandBuffer.Flush(Hits, DDCharacter, GetFlushSinks());
 }
 
 
 //화면 크로스헤어에 맞는 projectile의 발사 Rotation과 Location 값을 넣는다. 없을 시 멀리 있는 적을 맞추는 느낌으로 조정한다.
-bool UCombatComponent::FindTransformToShootProjectile(FVector& Location, FRotator& Rotation, const bool bHaveGravity) const
+bool UCombatComponent::GetCrosshairTarget(FVector& OutPoint) const
+{
+	if (CrosshairCache.Frame != GFrameCounter)
+	{
+		const FVector StartPos = DDCharacter->CameraComp->GetComponentLocation();
+		const FVector EndPos = StartPos + DDCharacter->CameraComp->GetForwardVector() * CrosshairTraceDistance;
+
+		FHitResult HitResult;
+		CrosshairCache.Frame = GFrameCounter;
+		CrosshairCache.bHit = GetWorld()->LineTraceSingleByChannel(HitResult, StartPos, EndPos, ECC_Visibility);
+		CrosshairCache.Point = CrosshairCache.bHit ? FVector(HitResult.ImpactPoint) : EndPos;
+		COMBAT_COUNT(Queries, 1);
+	}
+
+	OutPoint = CrosshairCache.Point;
+	return CrosshairCache.bHit;
+}
+
+bool UCombatComponent::FindTransformToShootProjectile(FVector& Location, FRotator& Rotation, const bool bHaveGravity, float ProjectileSpeed, float ProjectileGravityZ) const
 {
+	COMBAT_SCOPE_CYCLE(FindTransformToShootProjectile);
+
 	Location = DDCharacter->GetMesh()->GetSocketLocation("SkillActorSpawn");
-	
-	FVector StartPos = DDCharacter->CameraComp->GetComponentLocation();
-	FVector EndPos = StartPos + DDCharacter->CameraComp->GetForwardVector() * 5000.f;
-	
-	Rotation = (EndPos - Location).Rotation();
+
+	FVector EndPos;
+	const bool bHit = GetCrosshairTarget(EndPos);
 
 	if (bHaveGravity)
 	{
-		Rotation.Pitch += 3.f;
+		//크로스헤어 지점에 떨어지는 낮은 궤도, 사거리 밖이거나 수명 안에 닿지 못하면 아래에서 직선 조준 + 3도로 바꾼다.
+		const float Speed = ProjectileSpeed > 0.f ? ProjectileSpeed : GravityProjectileSpeed;
+		const float GravityZ = ProjectileGravityZ != 0.f ? ProjectileGravityZ : GetWorld()->GetGravityZ();
+		const CombatBallistics::FLaunchSolution Solution = CombatBallistics::SolveLaunch(Location, EndPos, Speed, GravityZ);
+
+		//닿지 못하는 궤도는 쓰지 않고, 기존처럼 크로스헤어 방향으로 약간 올려 쏜다.
+		const bool bReachable = Solution.bInRange && Solution.FlightTime <= GravityProjectileLifeTime;
+		if (bReachable)
+		{
+			Rotation = Solution.Direction.Rotation();
+		}
+		else
+		{
+			Rotation = (EndPos - Location).Rotation();
+			Rotation.Pitch += GravityProjectileFallbackPitch;
+		}
+
+		if (bDebugAim)
+		{
+			DrawDebugSphere(GetWorld(), EndPos, 25.f, 12, bReachable ? FColor::Green : FColor::Red, false, 1.0f, 0, 2.0f);
+			DrawDebugDirectionalArrow(GetWorld(), Location, Location + Rotation.Vector() * 300.f, 50.f, FColor::Green, false, 1.0f, 0, 3.f);
+		}
 		return true;
 	}
-	
-	FHitResult HitResult;
-	bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, StartPos, EndPos, ECC_Visibility);
+
 	if (bHit)
 	{
-		const float DistFromLocation = FVector::Dist(Location, HitResult.ImpactPoint);
+		const float DistFromLocation = FVector::Dist(Location, EndPos);
 
-		//MY_LOG(LogTemp, Log, TEXT("Dist From Hit Location  %f, Max : %f"), DistFromLocation, 1200.f);
-		if (DistFromLocation > 1200.f)
+		// 너무 가까운 경우엔 Rotation을 적절하게 설정해준다.
+		if (DistFromLocation <= 1200.f)
 		{
-			EndPos = HitResult.ImpactPoint;
-			Rotation = (EndPos - Location).Rotation();
+			EndPos = DDCharacter->CameraComp->GetComponentLocation() + DDCharacter->CameraComp->GetForwardVector() * 2000.f;
 		}
 
-		// 너무 가까운 경우엔 Rotation을 적절하게 설정해준다.
-		else
+		if (bDebugAim)
 		{
-			EndPos = StartPos + DDCharacter->CameraComp->GetForwardVector() * 2000.f;
-			Rotation = (EndPos - Location).Rotation();
+			DrawDebugSphere(GetWorld(), EndPos, 25.f, 12, FColor::Green, false, 1.0f, 0, 2.0f);
+			DrawDebugDirectionalArrow(GetWorld(), Location, EndPos, 50.f, FColor::Green, false, 1.0f, 0, 3.f);
 		}
-		
-		 DrawDebugSphere(GetWorld(), EndPos, 25.f, 12, FColor::Green, false, 1.0f, 0, 2.0f);
-		 DrawDebugDirectionalArrow(GetWorld(), Location, EndPos, 50.f, FColor::Green, false, 1.0f, 0, 3.f);
 	}
-	//else MY_LOG(LogTemp, Log, TEXT("No Hit"));
+	Rotation = (EndPos - Location).Rotation();
 
 	return bHit;
 }
@@ -1714,6 +2917,7 @@ bool UCombatComponent::FindTransformToShootProjectile(FVector& Location, FRotato
 // Called every frame
 void UCombatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	COMBAT_SCOPE_CYCLE(TickComponent);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	if (bAimingToGiveShield)
@@ -1729,7 +2933,8 @@ void UCombatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 		ETraceTypeQuery TraceType = UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_GameTraceChannel8);
 
 		FHitResult HitResult;
-		bool bHit = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), StartLocation, EndLocation, 50.f , TraceType, false,  ActorsToIgnore, EDrawDebugTrace::ForOneFrame, HitResult, true);
+		bool bHit = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), StartLocation, EndLocation, 50.f , TraceType, false,  ActorsToIgnore, bDebugAim ? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None, HitResult, true);
+		COMBAT_COUNT(Queries, 1);
 		if (bHit)
 		{
 			// Line Trace가 히트한 경우
@@ -1797,6 +3002,7 @@ void UCombatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 
 			FHitResult HitResult;
 			bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, StartLocation, EndLocation, ECC_Visibility, Params);
+			COMBAT_COUNT(Queries, 1);
 			if (bHit)
 			{
 				// Line Trace가 히트한 경우
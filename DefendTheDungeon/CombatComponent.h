@@ -3,23 +3,40 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CombatActionState.h"
+#include "CombatClock.h"
+#include "CombatCore.h"
+#include "CombatCosmeticRouter.h"
+#include "CombatDamageBatch.h"
+#include "CombatEffectHandle.h"
+#include "CombatJobScheduler.h"
+#include "CombatNetAccounting.h"
+#include "CombatProjectileSim.h"
+#include "CombatStatCache.h"
 #include "Ability/Effect/DamageEffect.h"
 #include "Component/Effect/HitEffectComponent.h"
 #include "Components/ActorComponent.h"
 #include "DefendTheDungeon/ETC/Enum/Enum.h"
+#include "UObject/ObjectKey.h"
 #include "CombatComponent.generated.h"
 
 
 DECLARE_DYNAMIC_DELEGATE(FActionCancelCalled);
 DECLARE_DYNAMIC_DELEGATE(FActionCalled);
 DECLARE_DYNAMIC_DELEGATE(FActionEnded);
+//늦게 도착한 막기로 되돌릴 피해, 체력 복구는 스탯 컴포넌트가 처리한다.
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnLateBlockRefund, AActor* /*DamageCauser*/, float /*Amount*/);
 
 
 class AIngamePlayerController;
+class UCombatBotDriverSubsystem;
+class UCombatReplaySubsystem;
 enum class EHitEffectState : uint8;
 class AGravityProjectile;
 enum class EAttackType : uint8;
 enum class EDamageType : uint8;
+enum class ECombatAnalyticsKind : uint8;
+namespace CombatCore::Sim { struct FLoadout; }
 class ADecalActor;
 class ADarkMagicOrbSkill;
 class UProjectileShooterComponent;
@@ -140,19 +157,108 @@ struct FAction
 	}
 };
 
+//클라이언트 히트 보고에 쓰는 공격 정보, 피해 배율은 클라이언트가 아닌 서버 설정에서 가져온다.
+USTRUCT(BlueprintType)
+struct FCombatHitProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	float AdScale = 1.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	float ApScale = 1.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	bool bHasKnockback = false;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	EDamageType DamageType = EDamageType::AdDamage;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	EAttackType AttackType = EAttackType::NormalAttack;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	EHitEffectState HitEffectState = EHitEffectState::None;
+
+	//허용하는 최대 스윕 반지름
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	float MaxRadius = 150.f;
+
+	//캐릭터 위치에서 스윕 끝까지 허용하는 최대 거리
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	float MaxReach = 400.f;
+
+	//이 히트를 낼 수 있는 행동, 기본 DetectedHit 계열 함수가 이 행동의 프로필로 보고한다.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	ECombatActionState Action = ECombatActionState::Attack;
+
+	//행동 시작부터 판정 구간 시작까지(초)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	float WindowStart = 0.f;
+
+	//행동 시작부터 판정 구간 끝까지(초), 서버는 여기에 연결의 핑을 더한 시각까지 보고를 받는다.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	float WindowEnd = 1.f;
+};
+
+//클라이언트가 자기 화면에서 맞힌 대상 목록
+USTRUCT()
+struct FCombatHitReport
+{
+	GENERATED_BODY()
+
+	//HitProfiles의 키
+	UPROPERTY()
+	FName ProfileName;
+
+	UPROPERTY()
+	FVector_NetQuantize Start;
+
+	UPROPERTY()
+	FVector_NetQuantize End;
+
+	UPROPERTY()
+	float Radius = 0.f;
+
+	//클라이언트가 대상을 본 시각(서버 시간 기준)
+	UPROPERTY()
+	double ViewTime = 0.0;
+
+	UPROPERTY()
+	TArray<AActor*> Targets;
+};
+
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class DEFENDTHEDUNGEON_API UCombatComponent : public UActorComponent
 {
 	GENERATED_BODY()
 	friend  AGravityProjectile;
+	//재생할 때 피해, CC 등 외부 입력을 다시 넣는다.
+	friend UCombatReplaySubsystem;
 
 protected:
 	
 	UCombatComponent();
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+	virtual void ProcessEvent(UFunction* Function, void* Parms) override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	//모든 CombatComponent가 보낸 RPC 수, 부하 측정용
+	static uint64 TotalRemoteCalls;
+
+	//Combat.Net.Accounting 프로퍼티 변경 감지용
+	FCombatNetAccounting::FShadowState NetShadowState;
+	
+public:
+	static uint64 GetTotalRemoteCalls() { return TotalRemoteCalls; }
+
+protected:
 	
 	UPROPERTY()
 	ADDCharacter *DDCharacter;
@@ -198,6 +304,12 @@ public:
 	//초기 세팅
 	void SetCharacter(ADDCharacter *AddCharacter) { DDCharacter = AddCharacter;}
 
+	/**
+	 * BeginPlay 뒤에 보조 무기(SubWeaponMode)를 바꾼 쪽이 호출합니다.
+	 * 새 무기가 쓰는 프로젝타일 예비 풀과 스킬 액터를 준비하고 스탯 캐시를 비웁니다.
+	 */
+	void OnSubWeaponModeChanged();
+
 	UFUNCTION(NetMulticast, Reliable)
 	void SetIngameplayerController();
 	
@@ -240,6 +352,10 @@ public:
 	Default	  Max(100)    Max(100)
 
 	* : 디른 어떤 액션도 할 수 있지만 취소 되진 않는다.
+
+ 컴포넌트 내장 행동의 우선순위는 CombatCore.h의 CombatCore::LevelTable에 정의되어 있으며,
+ 상태 간 전이 가능 여부는 컴파일 타임에 계산된 표(CombatCore::TransitionMatrix)로 검사한다.
+ 우선순위 판정 규칙 자체도 CombatCore::DecidePlay에 있고, 이 컴포넌트는 FAction을 변환해 위임한다.
  */
 
 private:
@@ -257,19 +373,94 @@ private:
 	bool CheckValidAction(const FAction &Action) const;
 	bool TryPlayAction_Internal(FAction &Action);
 
+	//지연 프로브, 가장 최근 Server_TryPlayAction/Server_Dash/Server_Block 판정 결과
+	bool bLastRequestAccepted = false;
+	TWeakObjectPtr<UCombatBotDriverSubsystem> LatencyProbeListener;
+
+	//막기 되감기
+	struct FIncomingDamage
+	{
+		double Time;
+		TWeakObjectPtr<AActor> DamageCauser;
+		float Amount;
+		//같은 프레임에 CC가 걸린 피해, CC는 되돌리지 않으므로 피해도 되돌리지 않는다.
+		bool bCausedCrowdControl;
+		//맞은 순간의 행동 상태
+		ECombatActionState ActionState;
+		//맞은 순간 막기 상태로 들어갈 수 있었고(CanEnterState) 막기 쿨타임이 끝나 있었는지
+		bool bBlockAllowed;
+	};
+	TArray<FIncomingDamage> RecentDamage;
+	//Server_Block이 판정하는 동안만 유효한 누른 시각
+	double BlockPressTime = 0.0;
+	double LastCrowdControlTime = -1.0;
+
+	//CC가 걸린 시각을 남기고, 같은 프레임에 받은 피해를 환불 대상에서 뺀다.
+	void MarkCrowdControlHits();
+
+	//OnLateBlockRefund 기본 처리, 되돌린 피해만큼 체력을 회복한다.
+	void RefundLateBlockedDamage(AActor* DamageCauser, float Amount);
+
+	//재생 : 기록된 피해를 스탯 컴포넌트에 다시 적용한다. 체력이 줄고 OnDamagedDelegate를 거쳐 OnDamaged가 불린다.
+	void ApplyReplayedDamage(float Damage, EAttackType DamageAttackType);
+
+	//막기 판정 시간, 누른 시각부터 잰다.
+	static constexpr float GuardDuration = 0.3f;
+
+	//PressTime 이후 막기가 가능했던 동안 받은 피해를 되돌리고, 되돌린 피해가 있으면 막기 성공 연출을 한 번 보낸다.
+	void RefundDamageSince(double PressTime);
+
+	FCombatStatCache StatCache;
+
+	//몬스터별 대상 피해 배율, 이 수를 넘으면 사라진 몬스터 항목을 정리한다.
+	FCombatMonsterStatCache MonsterStatCache;
+	static constexpr int32 MaxMonsterStatCacheEntries = 256;
+
+	//직접 붙인 효과의 핸들, FindEffectByName 대신 쓴다.
+	TCombatEffectTable<UBaseEffect> EffectTable;
+	FCombatEffectHandle GuardEffectHandle;
+	FCombatEffectHandle StealthEffectHandle;
+
+	//핸들을 반납하고 효과가 남아 있으면 스탯 컴포넌트에서 뗀다.
+	void RemoveTrackedEffect(UBaseStatComponent* FromStatComponent, FCombatEffectHandle& Handle);
+
+	//효과가 아직 스탯 컴포넌트에 붙어 있는지, 스스로 만료된 효과는 false
+	static bool IsEffectActive(UBaseStatComponent* InStatComponent, ECombatEffectSlot Slot, const UBaseEffect* Effect);
+
+	//히트 대상 종류와 스탯 컴포넌트, 대상 피해 배율을 채운다. 게임 스레드 전용
+	void ClassifyHitTarget(FCombatHitRequest& Hit);
+
+	//CombatCore 어댑터
+	static uint64 ToCoreFunctionKey(const FName& FunctionName);
+	static CombatCore::FActionDesc ToCoreAction(const FAction& Action);
+
 protected:
+	//현재 액션을 비우고 기본 상태로 돌아간다.
 	UFUNCTION()
-	void SetDefaultAction()
-	{
-		CurAction.Owner = nullptr;
-		CurAction.ActionLevel = ActionMax;
-		CurAction.CancelLevel = ActionMax;
-		CurAction.ActionName = FName();
-		CurAction.CancelFunctionName = CurAction.EndFunctionName = CurAction.PlayFunctionName = FName();
-
-		ActionCalled.Clear();
-		ActionCancelCalled.Clear();
-	}
+	void SetDefaultAction();
+
+	/**
+	 * 현재 행동 상태를 변경합니다. 상태에서 파생되는 불 변수들(bIsAttacking 등)은 이 함수에서만 갱신됩니다.
+	 * 서버에서 호출해야 하며, 클라이언트는 OnRep_ActionState로 동기화됩니다.
+	 */
+	void SetActionState(ECombatActionState NewState);
+
+	/**
+	 * 현재 액션을 취소 함수로 중단하고, CC 상태로 진입합니다.
+	 * CurAction의 우선순위도 CC 상태의 우선순위로 바뀌어, CC 중에는 낮은 우선순위 액션이 거절됩니다.
+	 * 
+	 * @return 현재 상태에서 CCState로 전이할 수 없으면 false 반환.
+	 */
+	bool EnterCrowdControlState(ECombatActionState CCState);
+
+	/**
+	 * CCState가 아직 유지 중이라면 기본 상태로 돌아갑니다.
+	 * CC 도중 더 높은 우선순위 상태로 바뀐 경우에는 아무것도 하지 않습니다.
+	 */
+	void ExitCrowdControlState(ECombatActionState CCState);
+
+	UFUNCTION()
+	void OnRep_ActionState();
 	
 public:
 	
@@ -287,6 +478,17 @@ public:
 	*/
 	bool CanPlayAction(const int32 ActionLevel) const;
 
+	/**
+	 * 현재 액션에서 NewState로 넘어갈 수 있는지 검사합니다.
+	 * 외부 액션과 CC도 CurAction.CancelLevel에 반영되므로, 서버 판정(TryPlayAction_Internal)과 같은 값 하나로 비교합니다.
+	 * 
+	 * @param NewState 캐릭터가 진입하려는 행동 상태입니다.
+	 * @return 전이 가능하면 true, 그렇지 않으면 false 반환.
+	 */
+	bool CanEnterState(ECombatActionState NewState) const { return CanPlayAction(CombatAction::GetActionLevel(NewState)); }
+
+	ECombatActionState GetActionState() const { return ActionState; }
+
 	/**
 	 * 클라이언트에서 액션 실행을 요청할 때 호출하는 서버 RPC 함수입니다.
 	 * 
@@ -334,6 +536,45 @@ public:
 	 */
 	FAction GetCurAction() const {return CurAction;}
 
+	/**
+	 * 입력 지연 측정용 프로브입니다. 봇 클라이언트가 클라이언트에서 받아들여진 액션 요청 바로 뒤에 보냅니다.
+	 * 같은 Reliable 채널이라 서버는 그 요청을 판정한 직후 이 프로브를 받으며, 판정 결과를 CL_LatencyProbeResult로 바로 돌려줍니다.
+	 * 시간은 보내지 않고, 클라이언트가 자기 시계로 왕복 시간을 잽니다.
+	 * 
+	 * @param Sequence 입력 번호, 0은 사용하지 않습니다.
+	 */
+	UFUNCTION(Server, Reliable)
+	void Server_LatencyProbe(int32 Sequence);
+
+	UFUNCTION(Client, Reliable)
+	void CL_LatencyProbeResult(int32 Sequence, bool bAccepted);
+
+	void SetLatencyProbeListener(UCombatBotDriverSubsystem* Listener) { LatencyProbeListener = Listener; }
+
+	/**
+	 * 행동 상태가 재생하는 몽타주인지 검사합니다.
+	 * @param State 검사할 행동 상태, Attack, Dash, SkillQ/E/R, Block만 지원합니다.
+	 * @param Montage 재생이 시작된 몽타주
+	 * @return State의 몽타주면 true
+	 */
+	bool IsActionMontage(ECombatActionState State, const UAnimMontage* Montage) const;
+
+	/**
+	 * 연출 전용 이벤트를 보냅니다. 서버에서만 호출합니다.
+	 * UCombatCosmeticRouter가 수신자별로 거리, 시야를 보고 Reliable/Unreliable/생략을 고르며, 라우터를 쓸 수 없으면 기존 멀티캐스트로 보냅니다.
+	 * 
+	 * @param Event 이벤트 종류
+	 * @param Param 이벤트 인자(대시 방향, 켜기 1/끄기 0)
+	 * @param bRequireDelivery 켜 둔 효과를 끄는 이벤트처럼 모두가 받아야 하면 true
+	 */
+	void SendCosmetic(ECombatCosmetic Event, uint8 Param = 0, bool bRequireDelivery = false);
+
+	//수신 측에서 연출을 재생합니다. UCombatCosmeticReceiver에서 호출
+	void PlayCosmetic(ECombatCosmetic Event, uint8 Param);
+
+	//블록 성공 연출, MC_BlockSuccess 대신 호출
+	void BlockSuccess() { SendCosmetic(ECombatCosmetic::BlockSuccess); }
+
 /*
  1. 행동 시작 함수
  플레이어 입력 시 호출되는 함수
@@ -370,10 +611,32 @@ public:
 	
 	void Stun(float Duration);
 	void Block();
+
+	/**
+	 * 클라이언트가 막기를 누른 시각과 함께 막기를 요청합니다.
+	 * 서버는 누른 시각을 그 연결의 핑과 Combat.Block.MaxRewind 중 짧은 쪽만큼까지 인정해, 그 시각부터 막기 판정 시간을 계산하고
+	 * 그 사이에 이미 처리된 피해는 OnLateBlockRefund로 되돌립니다. 스턴, 넉백이 걸린 피해는 되돌리지 않습니다.
+	 * 
+	 * @param PressServerTime 클라이언트가 막기를 누른 시각(서버 월드 시간 기준).
+	 */
+	UFUNCTION(Server, Reliable)
+	void Server_Block(double PressServerTime);
+
+	/**
+	 * 캐릭터가 받은 피해를 기록합니다. 스탯 컴포넌트가 피해를 적용한 뒤 OnDamaged에서 호출합니다.
+	 * 늦게 도착한 막기가 되감기 범위 안의 피해를 다시 판정할 때 씁니다.
+	 */
+	void RecordIncomingDamage(AActor* DamageCauser, float Amount);
+
+	FOnLateBlockRefund OnLateBlockRefund;
 	void ShockCharacter(float Duration);
 	void BigKnockBackCharacter();
 	void KnockBackCharacter();
 
+	//넉백 애니메이션 동안 행동할 수 없는 시간
+	static constexpr float KnockBackDuration = 0.5f;
+	static constexpr float BigKnockBackDuration = 2.2f;
+
 /*
  2. 액션 함수
 //TryPlayAction에서 유효 검사를 모두 통과 시, 처음 실행하는 함수
@@ -535,6 +798,61 @@ public:
 	bool SphereTrace(FVector StartLocation, FVector EndLocation, float SphereRadius, TArray<FHitResult> &HitResults, bool bTraceCharacter = false);
 	
 	void CrosshairHitReaction();
+
+	//SphereTrace 결과로 받는 대상인지
+	static bool IsCombatTarget(const AActor* Actor, bool bTraceCharacter);
+
+	/**
+	 * 로컬 화면 기준으로 스윕해 맞은 대상을 서버에 보고합니다. 소유 클라이언트에서 호출합니다.
+	 * 서버는 UCombatRewindSubsystem으로 대상을 보고 시각으로 되감아 검증한 뒤 ApplyCombatDamage를 적용합니다.
+	 * 서버(리슨 서버 호스트 포함)에서 호출하면 되감기 없이 바로 처리합니다.
+	 * 
+	 * @param ProfileName HitProfiles에 등록된 공격 이름.
+	 * @param StartLocation 스윕 시작 위치.
+	 * @param EndLocation 스윕 종료 위치.
+	 * @param SphereRadius 스윕 구 반경.
+	 * 
+	 * @return 맞은 대상이 있어 보고했으면 true.
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool ReportLocalHits(FName ProfileName, FVector StartLocation, FVector EndLocation, float SphereRadius);
+
+	UFUNCTION(Server, Reliable)
+	void Server_ReportHits(const FCombatHitReport& Report);
+
+	//보고된 히트를 검증하고 피해를 적용한다. 적용한 대상 수를 반환.
+	int32 ResolveReportedHits(const FCombatHitReport& Report);
+
+	/**
+	 * 행동에 등록된 히트 프로필로 캐릭터 앞을 스윕해 보고합니다. 기본 DetectedHit 계열 함수에서 호출합니다.
+	 * 프로필이 없는 행동은 아무것도 하지 않으므로, 서버 SphereTrace로 판정하는 하위 클래스는 그대로 동작합니다.
+	 * @param Action 판정 중인 행동
+	 * @return 보고했으면 true
+	 */
+	bool ReportActionHits(ECombatActionState Action);
+
+	//서버에서 행동이 시작될 때 히트 판정 스윙을 새로 연다.
+	void BeginHitSwing();
+
+	//공격 이름별 히트 설정, ReportLocalHits에서 쓴다.
+	UPROPERTY(EditDefaultsOnly, Category="Combat|Hit")
+	TMap<FName, FCombatHitProfile> HitProfiles;
+
+	//보고 하나에 허용하는 최대 대상 수
+	static constexpr int32 MaxReportedTargets = 16;
+
+	//스윙 하나에 받는 최대 보고 수, 넘는 보고는 버린다.
+	static constexpr int32 MaxReportsPerSwing = 8;
+
+	//서버에서 현재 행동의 히트 판정 기록, 대상은 스윙마다 한 번만 맞는다.
+	struct FHitSwing
+	{
+		ECombatActionState Action = ECombatActionState::Idle;
+		double StartTime = 0.0;
+		int32 NumReports = 0;
+		TSet<TObjectKey<AActor>> HitTargets;
+	};
+	FHitSwing HitSwing;
 	
 	/**
 	 * 대상 액터에 공격 피해를 적용하는 함수입니다.
@@ -549,24 +867,88 @@ public:
 	 * @param HitEffectState 피격 이펙트 상태.
 	 * @param HitLocation 피격 위치 정보 (ZeroVector면 액터 위치 기준).
 	 * 
-	 * 일반 공격일 경우 캐릭터의 OnNormalAttackHit 델리게이트를 브로드캐스트합니다.
+	 * 일반 공격일 경우 캐릭터의 OnNormalAttackHit 델리게이트를 브로드캐스트하고, 이벤트 버스에 FCombatNormalAttackHitEvent를 보냅니다.
 	 * 대상이 몬스터라면 피격 위치를 기준으로 피격 이펙트를 재생하며, 넉백 여부와 공격 타입, 스킬명도 전달합니다.
 	 * ADamageableActor 유형 대상이면 별도 Damaged 함수를 호출하고 피해 적용 과정을 종료합니다.
 	 * 대상이 지정된 타입이 아니면 피해 적용을 하지 않고 리턴합니다.
 	 */
 	void ApplyCombatDamage(AActor* TargetActor, float AdScale = 1.f, float ApScale = 1.f, bool bHasKnockback = false, EDamageType DamageType = EDamageType::AdDamage, EAttackType AttackType = EAttackType::NormalAttack, FName SkillName = TEXT("None"), EHitEffectState HitEffectState = EHitEffectState::None, FVector HitLocation = FVector::ZeroVector);
 
+	/**
+	 * 여러 히트의 피해를 한 번에 적용합니다.
+	 * 대상 분류와 스탯 읽기는 게임 스레드에서 하고, 최종 피해 계산은 히트가 많으면 ParallelFor로 나눈 뒤,
+	 * 기록된 부수 효과를 게임 스레드에서 히트 순서대로 한 번에 실행합니다.
+	 * 
+	 * @param Hits Target과 공격 정보를 채운 히트 목록, 대상 분류 정보가 채워진다.
+	 * @return 피해를 적용한 대상 수.
+	 */
+	int32 ApplyCombatDamageBatch(TArrayView<FCombatHitRequest> Hits);
+
+	//피해 계산에 쓰는 공격자 스탯
+	FCombatAttackerSnapshot GetAttackerSnapshot();
+
+	//피해 결과를 알릴 서브시스템
+	FCombatFlushSinks GetFlushSinks() const;
+
+	/**
+	 * 캐릭터 최종 공격력을 캐시에서 읽습니다. 스탯 컴포넌트의 리비전이 바뀌었거나 InvalidateStatCache가 불렸을 때만 다시 계산합니다.
+	 * 
+	 * @param DamageType AdDamage 또는 ApDamage
+	 */
+	float GetCachedFinalDamage(EDamageType DamageType);
+	float GetCachedMaxHealth();
+
+	/**
+	 * 현재 무기, 보조 무기 구성을 오프라인 전투 시뮬레이터(CombatSim.h) 로드아웃으로 옮깁니다.
+	 * 쿨타임, 스킬 계수, 최종 공격력, 몽타주 길이를 게임과 같은 값으로 읽습니다.
+	 * @return 캐릭터가 없으면 false
+	 */
+	bool BuildSimLoadout(CombatCore::Sim::FLoadout& OutLoadout);
+
+	//스탯 컴포넌트 밖에서 최종 스탯에 영향을 주는 값(무기 구성 등)을 바꾼 뒤 호출합니다. 스탯 컴포넌트의 변경은 리비전으로 알아서 반영됩니다.
+	void InvalidateStatCache() { StatCache.Invalidate(); }
+
+	//이 컴포넌트가 붙인 효과 중 종류별 최근 효과, 없거나 반납했으면 nullptr
+	UBaseEffect* FindTrackedEffect(ECombatEffectSlot Slot) const;
+
 	/**
 	 * 화면 크로스헤어에 맞춰 발사할 프로젝타일의 위치와 회전 값을 계산합니다.
 	 * 
 	 * @param Location 프로젝타일이 생성될 위치. 캐릭터의 "SkillActorSpawn" 소켓 위치를 기본으로 사용합니다.
 	 * @param Rotation 프로젝타일의 발사 회전 값. 크로스헤어가 가리키는 방향 또는 맞춤 위치를 기반으로 설정됩니다.
-	 * @param bHaveGravity 프로젝타일에 중력 영향 여부. 중력 영향을 받는 경우 발사 각도를 약간 조정합니다.
+	 * @param bHaveGravity 프로젝타일에 중력 영향 여부. 중력 영향을 받는 경우 크로스헤어 지점에 떨어지도록 탄도 각도를 계산합니다.
+	 *                     사거리 밖이거나 수명 안에 닿지 못하면 크로스헤어 방향으로 약간 올려 쏩니다.
+	 * @param ProjectileSpeed 중력 프로젝타일 발사 속력, 0이면 GravityProjectileSpeed
+	 * @param ProjectileGravityZ 중력 프로젝타일 중력 가속도 Z, 0이면 월드 중력
 	 * 
-	 * @return 발사 경로 상에 충돌체가 감지되면 true, 아니면 false 반환.
+	 * @return 발사 경로 상에 충돌체가 감지되면 true, 아니면 false 반환. 중력 프로젝타일은 항상 true.
 	 */
-	bool FindTransformToShootProjectile(FVector &Location, FRotator &Rotation, const bool bHaveGravity = false) const;
-	
+	bool FindTransformToShootProjectile(FVector &Location, FRotator &Rotation, const bool bHaveGravity = false, float ProjectileSpeed = 0.f, float ProjectileGravityZ = 0.f) const;
+
+	/**
+	 * 크로스헤어가 가리키는 지점을 반환합니다. 트레이스는 프레임마다 한 번만 하고 같은 프레임의 다른 호출은 결과를 재사용합니다.
+	 * 
+	 * @param OutPoint 맞은 지점, 맞지 않았으면 카메라 앞 CrosshairTraceDistance 지점
+	 * @return 충돌체가 감지되면 true
+	 */
+	bool GetCrosshairTarget(FVector& OutPoint) const;
+
+	static constexpr float CrosshairTraceDistance = 5000.f;
+	static constexpr float GravityProjectileSpeed = 1000.f;
+	//중력 프로젝타일은 발사 후 이 시간이 지나면 터진다(DestroyExploHandle).
+	static constexpr float GravityProjectileLifeTime = 1.f;
+	//탄도 해가 없을 때 직선 조준에 더하는 피치, 기존 중력 프로젝타일 조준과 같다.
+	static constexpr float GravityProjectileFallbackPitch = 3.f;
+
+private:
+	//프레임 단위 크로스헤어 트레이스 캐시
+	struct FCrosshairCache
+	{
+		uint64 Frame = MAX_uint64;
+		FVector Point = FVector::ZeroVector;
+		bool bHit = false;
+	};
+	mutable FCrosshairCache CrosshairCache;
 
 public:
 /* E 스킬 구현 */
@@ -596,9 +978,21 @@ public:
 	//암흑 마법 오브 스킬 : 범위 디버프
 	void DarkMagicOrbSkill();
 	void DarkMagicOrbSkillRun();
+	//조준 중인 미리보기 장판을 스킬 액터 풀에 돌려준다.
+	void ReleaseDarkMagicOrb();
+	//확정된 장판의 판정을 멈추고, 나이아가라가 끝나면 풀에 돌려준다.
+	void FinishActiveDarkMagicOrb();
 
 	//지팡이 스킬 : 중력구체
 	void GravityProjectile();
+	//날아가는 중력구체를 그 자리에서 터뜨린다.
+	void DetonateGravityProjectile();
+	//터진 중력구체를 예비 풀에 돌려준다.
+	void ReleaseGravityProjectile(AGravityProjectile* Projectile);
+	//장착한 무기 구성이 쓰는 프로젝타일 예비 풀을 등록한다. 서버에서만, 이미 있으면 무시
+	void RegisterProjectilePools();
+	//장착한 보조 무기가 쓰는 스킬 액터를 미리 만들어 둔다.
+	void PrewarmSkillActors();
 	
 	
 	//없앨 함수들 목록
@@ -620,24 +1014,28 @@ public:
  행동 검사 시 사용
  */
 protected:
+	//모든 캐릭터 공통 : 현재 행동 상태. 아래 행동 불 변수들은 이 값에서 파생된다.
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing=OnRep_ActionState)
+	ECombatActionState ActionState = ECombatActionState::Idle;
+	
 	//모든 캐릭터 공통 : 대쉬 애니메이션 실행 중 true.
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(BlueprintReadOnly)
 	bool bIsDashing = false;
 	
 	//모든 캐릭터 공통 : 공격 애니메이션 or 공격 관련 코드 실행 중 true.
-	UPROPERTY(BlueprintReadWrite, Replicated)
+	UPROPERTY(BlueprintReadOnly)
 	bool bIsAttacking = false;
 	
 	//모든 캐릭터 공통 : SkillQ 수행 중 true.
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(BlueprintReadOnly)
 	bool bSkillQ = false;
 
 	//모든 캐릭터 공통 : SKillE 수행 중 true.
-	UPROPERTY(BlueprintReadWrite, Replicated)
+	UPROPERTY(BlueprintReadOnly)
 	bool bSkillE = false;
 	
 	//모든 캐릭터 공통 : SKillR 수행 중 true.
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(BlueprintReadOnly)
 	bool bSkillR = false;
 
 	//모든 캐릭터 공통 : 스킬 준비 완료시 true.
@@ -669,19 +1067,19 @@ protected:
 	UPROPERTY(BlueprintReadWrite)
 	bool bGravityProjectileShooted = false;
 
-	UPROPERTY(BlueprintReadWrite)
-	bool bIsBlocking;
+	UPROPERTY(BlueprintReadOnly)
+	bool bIsBlocking = false;
 
 	UPROPERTY(BlueprintReadWrite)
 	bool bShocked = false;
 
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(BlueprintReadOnly)
 	bool bStunned = false;
 
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(BlueprintReadOnly)
 	bool bKnockbacked = false;
 
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(BlueprintReadOnly)
 	bool bBigKnockbacked = false;
 	
 public:
@@ -705,9 +1103,20 @@ public:
     bool IsKnockbacked() const { return bKnockbacked; }
     bool IsBigKnockbacked() const { return bBigKnockbacked; }
 
-public:
+	//몬스터 인지는 UCombatVisibilitySubsystem의 일괄 조회를 쓴다.
 	bool CanBeSeen() const {return !bStealthed;}
 
+protected:
+	//UCombatVisibilitySubsystem의 비트 번호, 서버에서만 유효
+	int32 VisibilitySlot = INDEX_NONE;
+
+	//UCombatReplaySubsystem의 슬롯, 서버에서만 유효
+	int32 ReplaySlot = INDEX_NONE;
+	//녹화 중일 때만 반환한다.
+	UCombatReplaySubsystem* GetReplayRecorder() const;
+	//bStealthed가 바뀔 때만 호출한다. 보임 비트셋을 고치고 은신 이벤트를 보낸다.
+	void UpdateVisibility();
+
 
 protected:
 /*******************************************************************/
@@ -753,17 +1162,84 @@ public:
 
 	void SetQCoolTime(const float InCoolTime) {QCoolTime = InCoolTime;}
 	void SetECoolTime(const float InCoolTime) {ECoolTime = InCoolTime;}
+
+	/**
+	 * 무기 보정을 반영한 E 스킬 쿨타임. 쌍검이면 1/3로 줄어든다.
+	 * 실제 쿨타임, HUD 표시, 시뮬레이터 로드아웃이 모두 이 값을 쓴다.
+	 * @return 초 단위 쿨타임
+	 */
+	float GetEffectiveECoolTime() const;
 	void SetRCoolTime(const float InCoolTime) {RCoolTime = InCoolTime;}
 	void SetDashCoolTime(const float InCoolTime) {DashCoolTime = InCoolTime;}
 	void SetBlockCoolTime(const float InCoolTime) {BlockCoolTime = InCoolTime;}
 
+	/**
+	 * 남은 쿨타임을 반환합니다. 서버에서만 유효합니다.
+	 * @param Slot 검사할 쿨타임 슬롯.
+	 * @return 남은 시간(초), 준비 완료 시 0.
+	 */
+	float GetRemainingCoolTime(CombatCore::ECooldownSlot Slot) const;
+
+	/**
+	 * 남은 CC 시간을 반환합니다. 서버에서만 유효합니다.
+	 * @param Type 검사할 CC 종류.
+	 * @return 남은 시간(초), 걸려있지 않으면 0.
+	 */
+	float GetRemainingCrowdControl(CombatCore::ECrowdControl Type) const;
+
+	/**
+	 * 쿨타임, CC 판정에 쓰는 전투 시간을 반환합니다.
+	 * @return 전투 시계(UCombatClock)의 틱 시간(초), 시계가 없는 월드면 월드 시간.
+	 */
+	double GetCombatTime() const;
+
+	/**
+	 * 전투 분석 기록을 남깁니다. Combat.Analytics가 꺼져 있으면 아무것도 하지 않습니다.
+	 * @param Kind 기록 종류
+	 * @param Name 스킬 또는 CC 이름
+	 * @param Amount 쿨타임, CC 시간 등 종류별 값
+	 * @param Type CC 종류 등 보조 분류
+	 */
+	void RecordAnalytics(ECombatAnalyticsKind Kind, FName Name, float Amount, uint8 Type = 0);
+
+	/**
+	 * 서버 난수를 뽑습니다. 녹화 중이면 기록하고, 재생 중이면 기록된 값을 돌려줍니다.
+	 * 전투 결과에 영향을 주는 난수는 FMath 대신 이 함수를 씁니다.
+	 */
+	int32 DrawRandomRange(int32 Min, int32 Max);
+
 protected:
+	/**
+	 * 전투 시계에 타이머를 등록합니다. 초는 가장 가까운 틱으로 반올림됩니다.
+	 * @param Seconds 지연 시간(초)
+	 * @param Callback 실행할 함수, 컴포넌트가 사라지면 실행하지 않는다.
+	 * @param bLoop 같은 간격으로 반복할지
+	 */
+	FCombatTimerHandle SetCombatTimer(float Seconds, TFunction<void()> Callback, bool bLoop = false);
+	void ClearCombatTimer(FCombatTimerHandle& Handle);
+
 	void QReady();
 	void EReady();
 	void RReady();
 	void BlockReady();
 	void DashReady();
 
+	//쿨타임, CC 상태의 기준. bQReady, bShocked 등 복제용 불 변수는 SyncCombatBookFlags에서만 여기서 읽어 갱신한다.
+	CombatCore::FCooldownBook CooldownBook;
+	CombatCore::FCrowdControlBook CrowdControlBook;
+
+	//기록을 바꾼 뒤 호출해 복제용 불 변수를 맞춘다.
+	void SyncCombatBookFlags();
+
+	//CC를 걸고, 처음 걸린 시각을 실제 유지 시간 측정용으로 남긴다.
+	void ApplyCrowdControl(CombatCore::ECrowdControl Type, double Duration);
+
+	//CC를 풀고, 걸려 있던 실제 시간을 분석 기록으로 남긴다.
+	void ClearCrowdControl(CombatCore::ECrowdControl Type);
+
+	//CC 종류별 걸린 시각(전투 시계), 걸려 있지 않으면 음수
+	double CrowdControlStartTimes[static_cast<int32>(CombatCore::ECrowdControl::MAX)] = { -1.0, -1.0, -1.0, -1.0 };
+
 /*******************************************************************/
 /*
  액션 스텟 (Action Stat)
@@ -822,8 +1298,14 @@ public:
 	//Object
 	UPROPERTY()
 	AGravityProjectile *ShootedGravityProjectile;
+	//Combat.Projectile.Batched일 때 중력구체의 배치 시뮬레이션 핸들
+	FCombatProjectileHandle GravityProjectileSim;
+	//조준 중인 미리보기 장판
 	UPROPERTY()
 	ADarkMagicOrbSkill *DecalMagicOrbSkill;
+	//확정되어 판정 중인 장판, 다시 시전해 새 미리보기를 조준해도 바뀌지 않는다.
+	UPROPERTY()
+	ADarkMagicOrbSkill *ActiveDarkMagicOrb;
 	UPROPERTY()
 	ADDCharacter *OverlayedCharacter;
 	UPROPERTY()
@@ -835,20 +1317,22 @@ public:
 	UParticleSystemComponent *ShockComp;
 
 	//TimerHandler
-	FTimerHandle StealthHandle;
-	FTimerHandle DarkMagicOrbHandle;
+	//전투 판정 타이머는 전투 시계 틱 단위
+	FCombatTimerHandle StealthHandle;
+	//장판 주기 판정은 시전자마다 위상을 흩어 돌리는 반복 작업
+	FCombatJobHandle DarkMagicOrbJob;
 	
 	FTimerHandle AttackComboHandle;
 	FTimerHandle SkillComboHandle;
 
-	FTimerHandle QCoolTimeHandle;
-	FTimerHandle ECoolTimeHandle;
-	FTimerHandle RCoolTimeHandle;
-	FTimerHandle BlockCoolTimeHandle;
-	FTimerHandle DashCoolTimeHandle;
+	FCombatTimerHandle QCoolTimeHandle;
+	FCombatTimerHandle ECoolTimeHandle;
+	FCombatTimerHandle RCoolTimeHandle;
+	FCombatTimerHandle BlockCoolTimeHandle;
+	FCombatTimerHandle DashCoolTimeHandle;
 	
-	FTimerHandle StunTimerHandle;
-	FTimerHandle ShockTimerHandle;
+	FCombatTimerHandle StunTimerHandle;
+	FCombatTimerHandle ShockTimerHandle;
 
 	//Materials
 	UPROPERTY()
@@ -866,9 +1350,15 @@ public:
 
 	//Info
 	FVector DecalLocation;
+	//확정된 장판의 판정 위치
+	FVector ActiveDarkMagicOrbLocation;
 	
 	//stored integer, float
-	float DarkMagicOrbTime = 0.f;
+	//장판 판정 횟수, 0.2초마다 20번(4초)
+	int32 DarkMagicOrbPulse = 0;
+	static constexpr int32 DarkMagicOrbPulseCount = 20;
+	static constexpr float DarkMagicOrbPulseInterval = 0.2f;
+	static constexpr float StealthDuration = 10.f;
 	int ComboCount = 0;
 
 	UPROPERTY(Replicated)
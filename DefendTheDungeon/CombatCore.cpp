@@ -0,0 +1,23 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatCore.h"
+
+namespace CombatCore
+{
+	EPlayDecision DecidePlay(const FActionDesc& Current, FActionDesc& Requested, FActionBindings& OutBindings)
+	{
+		Requested.ActionLevel = ClampLevel(Requested.ActionLevel);
+		Requested.CancelLevel = ClampLevel(Requested.CancelLevel);
+
+		if (!CanPlayAction(Requested.ActionLevel, Current.CancelLevel)) return EPlayDecision::Denied;
+
+		//전 액션과 동일한 경우, 바인딩을 건너뛴다.
+		if (Current == Requested) return EPlayDecision::Replay;
+
+		//취소, 엔드 함수가 비워져 있을 땐, 기본 상태로 돌아간다 생각한다.
+		OutBindings.bBindCancel = Requested.CancelFunction != 0;
+		OutBindings.bBindEnd = Requested.EndFunction != 0;
+		return EPlayDecision::Replace;
+	}
+}
@@ -0,0 +1,317 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*
+ 엔진 독립 전투 규칙
+ UCombatComponent의 행동 우선순위 판정, 취소/엔드 함수 위임, 쿨타임, CC 기록을 엔진 타입 없이 구현한다.
+ 언리얼 헤더를 포함하지 않으므로 에디터 없이도 빌드하고 검사할 수 있다.
+ UCombatComponent는 FAction을 FActionDesc로 바꿔 이 규칙에 위임하는 얇은 어댑터 역할만 한다.
+ 쿨타임, CC 상태는 FCooldownBook, FCrowdControlBook이 기준이며, 컴포넌트의 타이머는 이 기록을 갱신할 시점만 알려준다.
+ 저장소 최상위 CMakeLists.txt로 단위 테스트(Tests/CombatCoreTests.cpp)와 벤치마크를 따로 빌드한다.
+ */
+namespace CombatCore
+{
+	//Action Max, UCombatComponent::ActionMax와 같다.
+	static constexpr int32_t ActionMax = 100;
+
+	/*******************************************************************/
+	/* 행동 상태 우선순위 표 */
+
+	//ECombatActionState와 같은 순서여야 한다. CombatActionState.h에서 검사한다.
+	enum class EActionState : uint8_t
+	{
+		Idle,
+		Attack,
+		Dash,
+		SkillQ,
+		SkillE,
+		SkillR,
+		Block,
+		KnockBack,
+		BigKnockBack,
+		Stun,
+		MAX
+	};
+
+	static constexpr int32_t NumStates = static_cast<int32_t>(EActionState::MAX);
+
+	//상태별 우선순위, UCombatComponent.h의 행동 우선순위 표와 같다. 낮을수록 높은 우선순위.
+	struct FStateLevels
+	{
+		int32_t ActionLevel;
+		int32_t CancelLevel;
+		bool bCrowdControl;
+	};
+
+	/*
+	 행동 우선순위 표
+				ActionLev	CancelLev
+		Idle		100			100
+		Attack		4			3
+		Dash		3			2
+		SkillQ/E/R	3			2
+		Block		3			5
+		KnockBack	1			1
+		BigKnockBack 0			0
+		Stun		0			1
+	 */
+	inline constexpr FStateLevels LevelTable[] =
+	{
+		/* Idle */			{ 100, 100, false },
+		/* Attack */		{ 4, 3, false },
+		/* Dash */			{ 3, 2, false },
+		/* SkillQ */		{ 3, 2, false },
+		/* SkillE */		{ 3, 2, false },
+		/* SkillR */		{ 3, 2, false },
+		/* Block */			{ 3, 5, false },
+		/* KnockBack */		{ 1, 1, true },
+		/* BigKnockBack */	{ 0, 0, true },
+		/* Stun */			{ 0, 1, true },
+	};
+	static_assert(sizeof(LevelTable) / sizeof(LevelTable[0]) == NumStates, "LevelTable must have one row per EActionState");
+
+	constexpr int32_t GetActionLevel(EActionState State) { return LevelTable[static_cast<int32_t>(State)].ActionLevel; }
+	constexpr int32_t GetCancelLevel(EActionState State) { return LevelTable[static_cast<int32_t>(State)].CancelLevel; }
+	constexpr bool IsCrowdControl(EActionState State) { return LevelTable[static_cast<int32_t>(State)].bCrowdControl; }
+
+	//ActionLevel이 현재 CancelLevel보다 높은 우선순위(작거나 같은 값)이면 true
+	constexpr bool CanPlayAction(int32_t ActionLevel, int32_t CurCancelLevel)
+	{
+		return ActionLevel <= CurCancelLevel;
+	}
+
+	//From 상태에서 To 상태로 넘어갈 수 있는지 미리 계산한 표
+	struct FTransitionMatrix
+	{
+		bool bAllowed[NumStates][NumStates];
+	};
+
+	constexpr FTransitionMatrix BuildTransitionMatrix()
+	{
+		FTransitionMatrix Matrix{};
+		for (int32_t From = 0; From < NumStates; ++From)
+		{
+			for (int32_t To = 0; To < NumStates; ++To)
+			{
+				Matrix.bAllowed[From][To] = CanPlayAction(LevelTable[To].ActionLevel, LevelTable[From].CancelLevel);
+			}
+		}
+		return Matrix;
+	}
+
+	inline constexpr FTransitionMatrix TransitionMatrix = BuildTransitionMatrix();
+
+	constexpr bool CanTransition(EActionState From, EActionState To)
+	{
+		return TransitionMatrix.bAllowed[static_cast<int32_t>(From)][static_cast<int32_t>(To)];
+	}
+
+	/*
+	 기획 문서의 전이 규칙을 손으로 옮긴 기대 표, 행이 From, 열이 To
+	 LevelTable을 고치면 이 표와 어긋나 컴파일이 멈추므로, 규칙이 바뀐 것이 맞는지 확인하고 같이 고친다.
+	 */
+	inline constexpr bool ExpectedTransitions[NumStates][NumStates] =
+	{
+		//				Idle	Attack	Dash	Q		E		R		Block	KB		BigKB	Stun
+		/* Idle */		{ 1,	1,		1,		1,		1,		1,		1,		1,		1,		1 },
+		/* Attack */	{ 0,	0,		1,		1,		1,		1,		1,		1,		1,		1 },
+		/* Dash */		{ 0,	0,		0,		0,		0,		0,		0,		1,		1,		1 },
+		/* SkillQ */	{ 0,	0,		0,		0,		0,		0,		0,		1,		1,		1 },
+		/* SkillE */	{ 0,	0,		0,		0,		0,		0,		0,		1,		1,		1 },
+		/* SkillR */	{ 0,	0,		0,		0,		0,		0,		0,		1,		1,		1 },
+		/* Block */		{ 0,	1,		1,		1,		1,		1,		1,		1,		1,		1 },
+		/* KB */		{ 0,	0,		0,		0,		0,		0,		0,		1,		1,		1 },
+		/* BigKB */		{ 0,	0,		0,		0,		0,		0,		0,		0,		1,		1 },
+		/* Stun */		{ 0,	0,		0,		0,		0,		0,		0,		1,		1,		1 },
+	};
+
+	//모든 상태 쌍에 대해 우선순위 표로 계산한 전이가 기대 표와 같은지 검사한다.
+	constexpr bool VerifyTransitionMatrix()
+	{
+		for (int32_t From = 0; From < NumStates; ++From)
+		{
+			for (int32_t To = 0; To < NumStates; ++To)
+			{
+				if (CanTransition(static_cast<EActionState>(From), static_cast<EActionState>(To)) != ExpectedTransitions[From][To]) return false;
+			}
+		}
+		return true;
+	}
+
+	static_assert(VerifyTransitionMatrix(), "Combat action transition matrix does not match the documented rules");
+	static_assert(CanTransition(EActionState::Attack, EActionState::Dash), "Dash must cancel Attack");
+	static_assert(!CanTransition(EActionState::SkillQ, EActionState::SkillE), "A skill must not cancel another skill");
+	static_assert(CanTransition(EActionState::SkillQ, EActionState::Stun), "Stun must cancel a skill");
+	static_assert(CanTransition(EActionState::Block, EActionState::Attack), "Block must be cancellable by Attack");
+	static_assert(!CanTransition(EActionState::Stun, EActionState::Attack), "Attack is not allowed while stunned");
+
+	/*******************************************************************/
+	/* 액션 판정 */
+
+	/**
+	 * FAction의 엔진 독립 표현입니다.
+	 * 함수 이름은 FName 대신 정수 키로 보관하며, 0은 함수 없음(NAME_None)을 뜻합니다.
+	 */
+	struct FActionDesc
+	{
+		const void* Owner = nullptr;
+		uint8_t ActionType = 0;
+		uint64_t PlayFunction = 0;
+		uint64_t CancelFunction = 0;
+		uint64_t EndFunction = 0;
+		int32_t ActionLevel = ActionMax;
+		int32_t CancelLevel = ActionMax;
+
+		//ActionName은 비교하지 않는다. FAction::operator==와 같다.
+		bool operator==(const FActionDesc& Other) const
+		{
+			return ActionLevel == Other.ActionLevel
+				&& CancelLevel == Other.CancelLevel
+				&& Owner == Other.Owner
+				&& ActionType == Other.ActionType
+				&& PlayFunction == Other.PlayFunction
+				&& CancelFunction == Other.CancelFunction
+				&& EndFunction == Other.EndFunction;
+		}
+		bool operator!=(const FActionDesc& Other) const { return !(*this == Other); }
+	};
+
+	constexpr int32_t ClampLevel(int32_t Level)
+	{
+		return Level < 0 ? 0 : (Level > ActionMax ? ActionMax : Level);
+	}
+
+	enum class EPlayDecision : uint8_t
+	{
+		//우선순위가 낮아 거절
+		Denied,
+		//현재 액션을 취소하고 새 액션을 바인딩한 뒤 실행
+		Replace,
+		//현재 액션과 같으므로 바인딩을 유지한 채 다시 실행
+		Replay,
+	};
+
+	//Replace 시 어떤 함수를 바인딩할지 나타낸다. 함수가 비어 있으면 기본 상태로 돌아간다고 본다.
+	struct FActionBindings
+	{
+		bool bBindCancel = false;
+		bool bBindEnd = false;
+	};
+
+	/**
+	 * 요청된 액션의 우선순위를 보정하고, 현재 액션과 비교해 실행 여부를 결정합니다.
+	 *
+	 * @param Current 현재 실행 중인 액션.
+	 * @param Requested 실행하려는 액션. ActionLevel, CancelLevel이 [0, ActionMax]로 보정됩니다.
+	 * @param OutBindings Replace일 때 새로 바인딩할 취소/엔드 함수 정보.
+	 */
+	EPlayDecision DecidePlay(const FActionDesc& Current, FActionDesc& Requested, FActionBindings& OutBindings);
+
+	/*******************************************************************/
+	/* 피해 공식 */
+
+	//EDamageType의 AdDamage, ApDamage에 대응한다.
+	enum class EDamageKind : uint8_t
+	{
+		Ad,
+		Ap,
+	};
+
+	//타격 한 번의 피해, 공격력 * 공격 배율 * 대상 피해 배율
+	constexpr float ScaleDamage(EDamageKind Kind, float AD, float AP, float AdScale, float ApScale, float TargetDamageScale)
+	{
+		return Kind == EDamageKind::Ad ? AD * AdScale * TargetDamageScale : AP * ApScale * TargetDamageScale;
+	}
+
+	/*******************************************************************/
+	/* 쿨타임, CC 기록 */
+
+	enum class ECooldownSlot : uint8_t
+	{
+		Q,
+		E,
+		R,
+		Block,
+		Dash,
+		MAX
+	};
+
+	/**
+	 * 슬롯별 쿨타임 종료 시각을 기록합니다. 시각 단위는 호출자가 정하며(초, 틱 등) 일관되기만 하면 됩니다.
+	 */
+	class FCooldownBook
+	{
+	public:
+		void Start(ECooldownSlot Slot, double Now, double Duration) { ReadyTime[Index(Slot)] = Now + Duration; }
+		void Finish(ECooldownSlot Slot, double Now) { ReadyTime[Index(Slot)] = Now; }
+		//사용 중이라 쿨타임 시작 전까지 쓸 수 없다. Start나 Finish로 풀린다.
+		void Lock(ECooldownSlot Slot) { ReadyTime[Index(Slot)] = std::numeric_limits<double>::infinity(); }
+		bool IsReady(ECooldownSlot Slot, double Now) const { return Now >= ReadyTime[Index(Slot)]; }
+		//Lock 중이면 무한대
+		double GetRemaining(ECooldownSlot Slot, double Now) const
+		{
+			const double Remaining = ReadyTime[Index(Slot)] - Now;
+			return Remaining > 0.0 ? Remaining : 0.0;
+		}
+		void Reset() { for (double& Time : ReadyTime) Time = 0.0; }
+
+	private:
+		static constexpr size_t Index(ECooldownSlot Slot) { return static_cast<size_t>(Slot); }
+		double ReadyTime[static_cast<size_t>(ECooldownSlot::MAX)] = {};
+	};
+
+	enum class ECrowdControl : uint8_t
+	{
+		Stun,
+		Shock,
+		KnockBack,
+		BigKnockBack,
+		MAX
+	};
+
+	//CC 행동 상태에 대응하는 CC 종류, CC 상태가 아니면 MAX
+	constexpr ECrowdControl ToCrowdControl(EActionState State)
+	{
+		switch (State)
+		{
+		case EActionState::Stun: return ECrowdControl::Stun;
+		case EActionState::KnockBack: return ECrowdControl::KnockBack;
+		case EActionState::BigKnockBack: return ECrowdControl::BigKnockBack;
+		default: return ECrowdControl::MAX;
+		}
+	}
+
+	/**
+	 * CC 종류별 해제 시각을 기록합니다.
+	 * 같은 CC가 다시 걸리면 더 늦게 끝나는 쪽으로 갱신합니다.
+	 */
+	class FCrowdControlBook
+	{
+	public:
+		//새 CC로 해제 시각이 늦춰지면 true 반환.
+		bool Apply(ECrowdControl Type, double Now, double Duration)
+		{
+			double& End = EndTime[Index(Type)];
+			if (Now + Duration <= End) return false;
+			End = Now + Duration;
+			return true;
+		}
+		void Clear(ECrowdControl Type) { if (Type != ECrowdControl::MAX) EndTime[Index(Type)] = 0.0; }
+		bool IsActive(ECrowdControl Type, double Now) const { return Now < EndTime[Index(Type)]; }
+		double GetRemaining(ECrowdControl Type, double Now) const
+		{
+			const double Remaining = EndTime[Index(Type)] - Now;
+			return Remaining > 0.0 ? Remaining : 0.0;
+		}
+		void Reset() { for (double& Time : EndTime) Time = 0.0; }
+
+	private:
+		static constexpr size_t Index(ECrowdControl Type) { return static_cast<size_t>(Type); }
+		double EndTime[static_cast<size_t>(ECrowdControl::MAX)] = {};
+	};
+}
@@ -0,0 +1,175 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatCosmeticRouter.h"
+
+#include "CombatComponent.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	bool bRouteEnabled = true;
+	FAutoConsoleVariableRef CVarRoute(TEXT("Combat.Cosmetic.Route"), bRouteEnabled, TEXT("연출 RPC를 수신자별로 골라 보냅니다. 0이면 멀티캐스트를 씁니다."));
+
+	float FullDistance = 2500.f;
+	FAutoConsoleVariableRef CVarFullDistance(TEXT("Combat.Cosmetic.FullDistance"), FullDistance, TEXT("이 거리 안에서 보이면 Reliable로 보냅니다."));
+
+	float CullDistance = 6000.f;
+	FAutoConsoleVariableRef CVarCullDistance(TEXT("Combat.Cosmetic.CullDistance"), CullDistance, TEXT("이 거리 밖이면 보내지 않습니다."));
+
+	bool bLineOfSight = true;
+	FAutoConsoleVariableRef CVarLineOfSight(TEXT("Combat.Cosmetic.LineOfSight"), bLineOfSight, TEXT("가까운 수신자도 가려져 있으면 Unreliable로 낮춥니다."));
+
+	//시야 중심에서 약 100도 밖이면 화면 밖으로 본다.
+	constexpr float ViewConeCos = -0.17f;
+}
+
+UCombatCosmeticReceiver::UCombatCosmeticReceiver()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UCombatCosmeticReceiver::CL_PlayCosmetic_Implementation(UCombatComponent* Source, ECombatCosmetic Event, uint8 Param)
+{
+	//소스 캐릭터가 이 클라이언트에 없으면(연관성 밖) 무시
+	if (Source) Source->PlayCosmetic(Event, Param);
+}
+
+void UCombatCosmeticReceiver::CL_PlayCosmeticUnreliable_Implementation(UCombatComponent* Source, ECombatCosmetic Event, uint8 Param)
+{
+	if (Source) Source->PlayCosmetic(Event, Param);
+}
+
+bool UCombatCosmeticRouter::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatCosmeticRouter::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	PostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &UCombatCosmeticRouter::OnPostLogin);
+}
+
+void UCombatCosmeticRouter::Deinitialize()
+{
+	FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginHandle);
+	Super::Deinitialize();
+}
+
+void UCombatCosmeticRouter::OnPostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	//첫 이벤트 전에 클라이언트에 수신 컴포넌트가 만들어지도록 접속 시점에 붙인다.
+	if (!NewPlayer || NewPlayer->GetWorld() != GetWorld() || NewPlayer->IsLocalController()) return;
+
+	bool bCreated = false;
+	FindOrAddReceiver(NewPlayer, bCreated);
+}
+
+UCombatCosmeticReceiver* UCombatCosmeticRouter::FindOrAddReceiver(APlayerController* PlayerController, bool& bOutCreated)
+{
+	bOutCreated = false;
+	if (UCombatCosmeticReceiver* Receiver = PlayerController->FindComponentByClass<UCombatCosmeticReceiver>())
+	{
+		return Receiver;
+	}
+
+	UCombatCosmeticReceiver* Receiver = NewObject<UCombatCosmeticReceiver>(PlayerController, TEXT("CombatCosmeticReceiver"));
+	Receiver->RegisterComponent();
+	bOutCreated = true;
+	return Receiver;
+}
+
+ECombatCosmeticTier UCombatCosmeticRouter::SelectTier(const APlayerController* Recipient, const AActor* SourceActor) const
+{
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Recipient->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const FVector SourceLocation = SourceActor->GetActorLocation();
+	const float DistSquared = FVector::DistSquared(ViewLocation, SourceLocation);
+	if (DistSquared > FMath::Square(CullDistance)) return ECombatCosmeticTier::Skip;
+	if (DistSquared > FMath::Square(FullDistance)) return ECombatCosmeticTier::Unreliable;
+
+	//가깝더라도 화면 밖이거나 가려져 있으면 놓쳐도 티가 나지 않는다.
+	const FVector ToSource = (SourceLocation - ViewLocation).GetSafeNormal();
+	if ((ViewRotation.Vector() | ToSource) < ViewConeCos) return ECombatCosmeticTier::Unreliable;
+
+	if (bLineOfSight)
+	{
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(CombatCosmeticLOS), false, SourceActor);
+		Params.AddIgnoredActor(Recipient->GetPawn());
+		if (GetWorld()->LineTraceTestByChannel(ViewLocation, SourceLocation, ECC_Visibility, Params))
+		{
+			return ECombatCosmeticTier::Unreliable;
+		}
+	}
+	return ECombatCosmeticTier::Reliable;
+}
+
+bool UCombatCosmeticRouter::Dispatch(UCombatComponent* Source, ECombatCosmetic Event, uint8 Param, bool bRequireDelivery)
+{
+	UWorld* World = GetWorld();
+	const ENetMode NetMode = World->GetNetMode();
+	if (!bRouteEnabled || NetMode == NM_Standalone || NetMode == NM_Client) return false;
+
+	AActor* SourceActor = Source->GetOwner();
+	if (!SourceActor || !SourceActor->HasAuthority()) return false;
+
+	//서버는 데디케이티드여도 항상 재생한다. 대시 루트 모션, 방패 End 섹션의 노티파이, 스턴 몽타주가 서버의 상태 종료를 이끈다.
+	Source->PlayCosmetic(Event, Param);
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* Recipient = It->Get();
+		if (!Recipient || Recipient->IsLocalController()) continue;
+
+		bool bCreated = false;
+		UCombatCosmeticReceiver* Receiver = FindOrAddReceiver(Recipient, bCreated);
+		if (bCreated)
+		{
+			//클라이언트에 아직 컴포넌트가 없으므로 이번 이벤트는 건너뛴다.
+			Counters.Skipped++;
+			continue;
+		}
+
+		//소유 클라이언트는 자신의 입력 결과라 항상 받아야 한다.
+		const ECombatCosmeticTier Tier = bRequireDelivery || Recipient->GetPawn() == SourceActor
+			? ECombatCosmeticTier::Reliable
+			: SelectTier(Recipient, SourceActor);
+
+		switch (Tier)
+		{
+		case ECombatCosmeticTier::Reliable:
+			Receiver->CL_PlayCosmetic(Source, Event, Param);
+			Counters.Reliable++;
+			break;
+		case ECombatCosmeticTier::Unreliable:
+			Receiver->CL_PlayCosmeticUnreliable(Source, Event, Param);
+			Counters.Unreliable++;
+			break;
+		default:
+			Counters.Skipped++;
+			break;
+		}
+	}
+	return true;
+}
+
+static FAutoConsoleCommandWithWorld CosmeticStatsCommand(
+	TEXT("Combat.Cosmetic.Stats"),
+	TEXT("연출 이벤트의 등급별 전송 횟수를 출력합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const UCombatCosmeticRouter* Router = World ? World->GetSubsystem<UCombatCosmeticRouter>() : nullptr;
+		if (!Router) return;
+
+		const UCombatCosmeticRouter::FCounters& Counters = Router->GetCounters();
+		MY_LOG(LogTemp, Log, TEXT("Combat cosmetic, Reliable %llu, Unreliable %llu, Skipped %llu"), Counters.Reliable, Counters.Unreliable, Counters.Skipped);
+	}));
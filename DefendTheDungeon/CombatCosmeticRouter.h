@@ -0,0 +1,98 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatCosmeticRouter.generated.h"
+
+class AGameModeBase;
+class APlayerController;
+class UCombatComponent;
+
+//라우터로 보내는 연출 이벤트
+//Dash, StunMontage, ConfirmGiveShield는 몽타주가 서버의 상태 종료도 이끌므로 서버에서는 항상 재생하고, 클라이언트 전송만 등급을 고른다.
+UENUM()
+enum class ECombatCosmetic : uint8
+{
+	Dash,
+	BlockSuccess,
+	ShockParticle,
+	StunMontage,
+	ConfirmGiveShield,
+};
+
+//수신자별 전송 등급
+enum class ECombatCosmeticTier : uint8
+{
+	Skip,
+	Unreliable,
+	Reliable,
+};
+
+/**
+ * 플레이어 컨트롤러에 붙어 연출 이벤트를 받는 컴포넌트입니다.
+ * 멀티캐스트는 수신자를 고를 수 없으므로, 연결마다 이 컴포넌트의 Client RPC로 보냅니다.
+ */
+UCLASS(ClassGroup=(Combat))
+class DEFENDTHEDUNGEON_API UCombatCosmeticReceiver : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCombatCosmeticReceiver();
+
+	UFUNCTION(Client, Reliable)
+	void CL_PlayCosmetic(UCombatComponent* Source, ECombatCosmetic Event, uint8 Param);
+
+	UFUNCTION(Client, Unreliable)
+	void CL_PlayCosmeticUnreliable(UCombatComponent* Source, ECombatCosmetic Event, uint8 Param);
+};
+
+/**
+ * 연출 이벤트 라우터입니다. 서버에서 수신자마다 거리, 시야, 중요도로 전송 등급을 고릅니다.
+ *	- 소유 클라이언트 : 항상 Reliable (루트 모션 몽타주 등 자신의 입력 결과)
+ *	- Combat.Cosmetic.FullDistance 이내이고 보이는 위치 : Reliable
+ *	- Combat.Cosmetic.CullDistance 이내, 또는 가깝지만 가려진 위치 : Unreliable
+ *	- 그 밖 : 보내지 않음
+ * 켜진 효과를 끄는 이벤트는 bRequireDelivery로 거리와 관계없이 Reliable로 보내 효과가 남지 않게 합니다.
+ * Combat.Cosmetic.Route 0 이면 기존 멀티캐스트를 그대로 씁니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatCosmeticRouter : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * 서버에서 연출 이벤트를 재생하고 원격 수신자별로 보냅니다. 서버에서만 호출합니다.
+	 * @param Source 이벤트를 재생할 컴포넌트
+	 * @param Event 이벤트 종류
+	 * @param Param 이벤트 인자(대시 방향, 켜기/끄기 등)
+	 * @param bRequireDelivery true면 모든 수신자에게 Reliable로 보낸다.
+	 * @return 라우터가 처리했으면 true, false면 호출 측이 멀티캐스트로 보낸다.
+	 */
+	bool Dispatch(UCombatComponent* Source, ECombatCosmetic Event, uint8 Param, bool bRequireDelivery);
+
+	//등급별 전송 횟수, Combat.Cosmetic.Stats로 출력
+	struct FCounters
+	{
+		uint64 Reliable = 0;
+		uint64 Unreliable = 0;
+		uint64 Skipped = 0;
+	};
+	const FCounters& GetCounters() const { return Counters; }
+
+private:
+	ECombatCosmeticTier SelectTier(const APlayerController* Recipient, const AActor* SourceActor) const;
+	void OnPostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer);
+	static UCombatCosmeticReceiver* FindOrAddReceiver(APlayerController* PlayerController, bool& bOutCreated);
+
+	FDelegateHandle PostLoginHandle;
+	FCounters Counters;
+};
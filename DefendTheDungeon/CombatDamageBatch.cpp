@@ -0,0 +1,106 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatDamageBatch.h"
+
+#include "CombatAnalytics.h"
+#include "CombatEventBus.h"
+#include "CombatThreat.h"
+#include "DefendTheDungeon/Ability/StatComponent/MonsterStatComponent.h"
+#include "DefendTheDungeon/Actor/Damageable/DamageableActor.h"
+#include "DefendTheDungeon/Character/DDCharacter.h"
+#include "DefendTheDungeon/Character/Monster/MonsterBase.h"
+
+void FCombatCommandBuffer::Reset(int32 NumSlots)
+{
+	Slots.Reset();
+	Slots.SetNum(NumSlots);
+}
+
+void CombatDamage::ResolveHit(int32 Index, const FCombatHitRequest& Hit, const FCombatAttackerSnapshot& Attacker, FCombatCommandBuffer& CommandBuffer)
+{
+	if (Hit.AttackType == EAttackType::NormalAttack)
+	{
+		CommandBuffer.Add(Index, FCombatCommandBuffer::ECommand::NormalAttackHit);
+	}
+
+	switch (Hit.Kind)
+	{
+	case FCombatHitRequest::ETargetKind::Monster:
+		CommandBuffer.Add(Index, FCombatCommandBuffer::ECommand::HitEffect);
+		[[fallthrough]];
+	case FCombatHitRequest::ETargetKind::StatActor:
+		if (Hit.MonsterStat && (Hit.DamageType == EDamageType::AdDamage || Hit.DamageType == EDamageType::ApDamage))
+		{
+			CommandBuffer.Add(Index, FCombatCommandBuffer::ECommand::ApplyDamage, ResolveDamage(Attacker, Hit));
+		}
+		break;
+	case FCombatHitRequest::ETargetKind::Damageable:
+		CommandBuffer.Add(Index, FCombatCommandBuffer::ECommand::DamageableHit);
+		break;
+	default:
+		break;
+	}
+}
+
+int32 FCombatCommandBuffer::Flush(TArrayView<const FCombatHitRequest> Hits, ADDCharacter* Character, const FCombatFlushSinks& Sinks)
+{
+	check(IsInGameThread());
+	check(Hits.Num() == Slots.Num());
+
+	int32 NumDamaged = 0;
+	for (int32 Index = 0; Index < Slots.Num(); Index++)
+	{
+		const FCombatHitRequest& Hit = Hits[Index];
+		//앞선 명령으로 대상이 사라졌을 수 있다.
+		if (!IsValid(Hit.Target)) continue;
+
+		for (const FCommand& Command : Slots[Index])
+		{
+			switch (Command.Type)
+			{
+			case ECommand::NormalAttackHit:
+				//트리 밖 리스너가 버스로 옮길 때까지 캐릭터 델리게이트도 함께 부른다.
+				Character->OnNormalAttackHit.Broadcast(Hit.Target);
+				if (Sinks.EventBus)
+				{
+					Sinks.EventBus->Publish(FCombatNormalAttackHitEvent{ Character, Hit.Target });
+				}
+				break;
+			case ECommand::HitEffect:
+				if (Hit.HitLocation != FVector::ZeroVector)
+				{
+					Hit.Monster->GetHitEffectComponent()->Multicast_SpawnEffect(static_cast<int>(Hit.HitEffectState), nullptr, Hit.HitLocation - Hit.Target->GetActorLocation());
+				}
+				else
+				{
+					Hit.Monster->GetHitEffectComponent()->Multicast_SpawnEffect(static_cast<int>(Hit.HitEffectState), nullptr, Hit.Target->GetActorLocation());
+				}
+				break;
+			case ECommand::DamageableHit:
+				Hit.Damageable->Damaged(Character);
+				NumDamaged++;
+				break;
+			case ECommand::ApplyDamage:
+				//대상 측 배율은 해석 단계에서 이미 곱했으므로 스탯 컴포넌트가 다시 감소시키지 않는 경로로 넣는다.
+				Hit.MonsterStat->ApplyResolvedDamage(Character, Hit.DamageType, Command.Amount, Hit.bHasKnockback, Hit.AttackType, Hit.SkillName);
+				if (Sinks.Threat && Hit.Monster)
+				{
+					Sinks.Threat->AddDamageThreat(Hit.Monster, Character, Command.Amount);
+				}
+				if (Sinks.Analytics)
+				{
+					Sinks.Analytics->Record(ECombatAnalyticsKind::Damage, Character, Hit.SkillName, Command.Amount,
+						static_cast<uint8>(Hit.AttackType), static_cast<uint8>(Hit.DamageType));
+				}
+				NumDamaged++;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	Slots.Reset();
+	return NumDamaged;
+}
@@ -0,0 +1,138 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatCore.h"
+#include "Ability/Effect/DamageEffect.h"
+#include "Component/Effect/HitEffectComponent.h"
+
+class ADamageableActor;
+class ADDCharacter;
+class UCombatAnalyticsSubsystem;
+class UCombatEventBus;
+class AMonsterBase;
+class UCombatThreatSubsystem;
+class UMonsterStatComponent;
+
+/*
+ 피해 일괄 처리
+ 1. 게임 스레드 : 대상 분류, 공격자 스탯과 대상 피해 배율 스냅샷 (CombatComponent::ApplyCombatDamageBatch)
+ 2. 해석 : 순수 데이터로 최종 피해 계산, 히트마다 자기 슬롯에 명령 기록. 히트가 많으면 ParallelFor로 나눈다.
+ 3. 게임 스레드 : 명령 버퍼를 히트 순서대로 한 번에 실행 (피해 적용, 위협, 이벤트, 멀티캐스트)
+ */
+
+//피해 계산에 필요한 공격자 스탯, 배치마다 한 번 읽는다.
+struct FCombatAttackerSnapshot
+{
+	float AD = 0.f;
+	float AP = 0.f;
+};
+
+//히트 하나, 1단계에서 채운다.
+struct FCombatHitRequest
+{
+	enum class ETargetKind : uint8
+	{
+		None,
+		Monster,
+		StatActor,
+		Damageable,
+	};
+
+	AActor* Target = nullptr;
+	AMonsterBase* Monster = nullptr;
+	UMonsterStatComponent* MonsterStat = nullptr;
+	ADamageableActor* Damageable = nullptr;
+	ETargetKind Kind = ETargetKind::None;
+
+	float AdScale = 1.f;
+	float ApScale = 1.f;
+	//대상이 받는 피해 배율 (피해 감소, DD_IncreasedDamageReduce_10 같은 버프), 1단계에서 대상 스탯 컴포넌트에서 읽는다.
+	float TargetDamageScale = 1.f;
+	bool bHasKnockback = false;
+	EDamageType DamageType = EDamageType::AdDamage;
+	EAttackType AttackType = EAttackType::NormalAttack;
+	FName SkillName = TEXT("None");
+	EHitEffectState HitEffectState = EHitEffectState::None;
+	FVector HitLocation = FVector::ZeroVector;
+};
+
+namespace CombatDamage
+{
+	//이 수보다 히트가 적으면 해석 단계를 게임 스레드에서 바로 돈다. 작업 예약 비용이 계산보다 크다.
+	constexpr int32 ParallelResolveThreshold = 16;
+
+	//최종 피해, 스레드 안전
+	inline float ResolveDamage(const FCombatAttackerSnapshot& Attacker, const FCombatHitRequest& Hit)
+	{
+		switch (Hit.DamageType)
+		{
+		case EDamageType::AdDamage:	return CombatCore::ScaleDamage(CombatCore::EDamageKind::Ad, Attacker.AD, Attacker.AP, Hit.AdScale, Hit.ApScale, Hit.TargetDamageScale);
+		case EDamageType::ApDamage:	return CombatCore::ScaleDamage(CombatCore::EDamageKind::Ap, Attacker.AD, Attacker.AP, Hit.AdScale, Hit.ApScale, Hit.TargetDamageScale);
+		default:					return 0.f;
+		}
+	}
+}
+
+//히트 결과를 알릴 곳, 없는 항목은 건너뛴다.
+struct FCombatFlushSinks
+{
+	//몬스터에게 준 피해를 위협으로 기록
+	UCombatThreatSubsystem* Threat = nullptr;
+	//일반 공격 적중 이벤트
+	UCombatEventBus* EventBus = nullptr;
+	//스킬, 공격 종류별 피해 기록
+	UCombatAnalyticsSubsystem* Analytics = nullptr;
+};
+
+/**
+ * 게임 스레드에서 실행할 부수 효과를 모아두는 명령 버퍼입니다.
+ * 히트마다 슬롯이 따로 있어 해석 단계에서 잠금 없이 기록하고, Flush는 히트 순서대로 실행합니다.
+ */
+class DEFENDTHEDUNGEON_API FCombatCommandBuffer
+{
+public:
+	enum class ECommand : uint8
+	{
+		NormalAttackHit,
+		HitEffect,
+		DamageableHit,
+		ApplyDamage,
+	};
+
+	struct FCommand
+	{
+		ECommand Type;
+		float Amount;
+	};
+
+	void Reset(int32 NumSlots);
+
+	//해석 단계에서 호출, Slot은 히트 인덱스
+	void Add(int32 Slot, ECommand Type, float Amount = 0.f) { Slots[Slot].Add({ Type, Amount }); }
+
+	/**
+	 * 기록된 명령을 실행합니다. 게임 스레드에서만 호출합니다.
+	 * @param Hits 슬롯과 같은 순서의 히트 요청
+	 * @param Character 공격한 캐릭터
+	 * @param Sinks 위협, 이벤트, 분석 기록을 보낼 곳
+	 * @return 피해를 적용한 대상 수
+	 */
+	int32 Flush(TArrayView<const FCombatHitRequest> Hits, ADDCharacter* Character, const FCombatFlushSinks& Sinks);
+
+private:
+	TArray<TArray<FCommand, TInlineAllocator<4>>> Slots;
+};
+
+namespace CombatDamage
+{
+	/**
+	 * 히트 하나의 최종 피해를 계산하고 부수 효과를 명령 버퍼에 기록합니다. 엔진 상태를 건드리지 않으므로 워커 스레드에서 불러도 됩니다.
+	 * @param Index 히트 인덱스, 명령 버퍼의 슬롯
+	 * @param Hit 대상 분류와 대상 피해 배율이 채워진 히트
+	 * @param Attacker 공격자 스탯
+	 * @param CommandBuffer 기록할 명령 버퍼
+	 */
+	DEFENDTHEDUNGEON_API void ResolveHit(int32 Index, const FCombatHitRequest& Hit, const FCombatAttackerSnapshot& Attacker, FCombatCommandBuffer& CommandBuffer);
+}
@@ -0,0 +1,152 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+/*
+ 효과 핸들
+ CombatComponent가 직접 붙인 효과를 이름 검색(FindEffectByName) 없이 다시 찾기 위한 표.
+ - ApplyEffect 직후 Add로 핸들을 받아 두고, Resolve/Release로 O(1)에 꺼낸다.
+ - 슬롯을 다시 쓰면 세대(Generation)가 올라가므로 오래된 핸들은 무효가 된다.
+ - 효과 종류(ECombatEffectSlot)별 최근 핸들도 배열로 바로 찾을 수 있다.
+ - 효과는 스탯 컴포넌트 안에서 스스로 만료될 수 있고, GC 전까지 약한 포인터는 살아 있다.
+   그래서 꺼낸 효과를 쓰기 전에 스탯 컴포넌트에 아직 붙어 있는지 확인한다(UCombatComponent::IsEffectActive).
+ */
+
+//효과 종류, 종류별 조회에 쓴다.
+enum class ECombatEffectSlot : uint8
+{
+	PlayerGuard,
+	StealthHeist,
+	MAX
+};
+
+namespace CombatEffect
+{
+	//스탯 컴포넌트의 FindEffectByName에 쓰는 효과 이름
+	inline const TCHAR* GetEffectName(ECombatEffectSlot Slot)
+	{
+		switch (Slot)
+		{
+		case ECombatEffectSlot::PlayerGuard:	return TEXT("PlayerGuard");
+		case ECombatEffectSlot::StealthHeist:	return TEXT("StealthHeist");
+		default:								return TEXT("None");
+		}
+	}
+}
+
+struct FCombatEffectHandle
+{
+	uint16 Index = 0;
+	//0은 비어 있는 핸들
+	uint16 Generation = 0;
+
+	bool IsSet() const { return Generation != 0; }
+	void Invalidate() { Generation = 0; }
+};
+
+template <typename EffectType>
+class TCombatEffectTable
+{
+public:
+	/**
+	 * 적용한 효과를 등록하고 핸들을 돌려줍니다. 같은 종류의 이전 핸들은 종류별 조회에서 덮어씁니다.
+	 */
+	FCombatEffectHandle Add(EffectType* Effect, ECombatEffectSlot Slot)
+	{
+		uint16 Index;
+		if (FreeIndices.Num() > 0)
+		{
+			Index = FreeIndices.Pop();
+		}
+		else
+		{
+			Index = static_cast<uint16>(Entries.AddDefaulted());
+		}
+
+		FEntry& Entry = Entries[Index];
+		Entry.Effect = Effect;
+		Entry.Slot = Slot;
+		Entry.bUsed = true;
+
+		const FCombatEffectHandle Handle{ Index, Entry.Generation };
+		BySlot[static_cast<int32>(Slot)] = Handle;
+		return Handle;
+	}
+
+	//핸들이 가리키는 효과, 세대가 다르거나 효과가 사라졌으면 nullptr
+	EffectType* Resolve(const FCombatEffectHandle& Handle) const
+	{
+		if (!Handle.IsSet() || !Entries.IsValidIndex(Handle.Index)) return nullptr;
+
+		const FEntry& Entry = Entries[Handle.Index];
+		return Entry.bUsed && Entry.Generation == Handle.Generation ? Entry.Effect.Get() : nullptr;
+	}
+
+	/**
+	 * 핸들을 반납하고 효과를 돌려줍니다. 반납한 슬롯의 세대를 올려 같은 핸들을 다시 쓸 수 없게 합니다.
+	 * @return 아직 살아 있는 효과, 없으면 nullptr
+	 */
+	EffectType* Release(FCombatEffectHandle& Handle)
+	{
+		EffectType* Effect = Resolve(Handle);
+		if (Handle.IsSet() && Entries.IsValidIndex(Handle.Index) && Entries[Handle.Index].Generation == Handle.Generation)
+		{
+			FEntry& Entry = Entries[Handle.Index];
+			FCombatEffectHandle& SlotHandle = BySlot[static_cast<int32>(Entry.Slot)];
+			if (SlotHandle.Index == Handle.Index && SlotHandle.Generation == Handle.Generation)
+			{
+				SlotHandle.Invalidate();
+			}
+
+			Entry.Effect.Reset();
+			Entry.bUsed = false;
+			//0은 빈 핸들이므로 건너뛴다.
+			Entry.Generation = Entry.Generation == MAX_uint16 ? 1 : Entry.Generation + 1;
+			FreeIndices.Add(Handle.Index);
+		}
+		Handle.Invalidate();
+		return Effect;
+	}
+
+	//핸들이 가리키는 효과 종류, 무효한 핸들이면 MAX
+	ECombatEffectSlot GetSlot(const FCombatEffectHandle& Handle) const
+	{
+		if (!Handle.IsSet() || !Entries.IsValidIndex(Handle.Index)) return ECombatEffectSlot::MAX;
+
+		const FEntry& Entry = Entries[Handle.Index];
+		return Entry.bUsed && Entry.Generation == Handle.Generation ? Entry.Slot : ECombatEffectSlot::MAX;
+	}
+
+	//종류별 최근 효과의 핸들
+	FCombatEffectHandle GetHandle(ECombatEffectSlot Slot) const { return BySlot[static_cast<int32>(Slot)]; }
+
+	EffectType* FindBySlot(ECombatEffectSlot Slot) const { return Resolve(GetHandle(Slot)); }
+
+	//모든 핸들을 반납한다. 세대는 유지되므로 이전 핸들은 계속 무효다.
+	void Reset()
+	{
+		for (int32 Index = 0; Index < Entries.Num(); Index++)
+		{
+			if (!Entries[Index].bUsed) continue;
+
+			FCombatEffectHandle Handle{ static_cast<uint16>(Index), Entries[Index].Generation };
+			Release(Handle);
+		}
+	}
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<EffectType> Effect;
+		uint16 Generation = 1;
+		ECombatEffectSlot Slot = ECombatEffectSlot::MAX;
+		bool bUsed = false;
+	};
+
+	TArray<FEntry> Entries;
+	TArray<uint16> FreeIndices;
+	FCombatEffectHandle BySlot[static_cast<int32>(ECombatEffectSlot::MAX)];
+};
@@ -0,0 +1,86 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatEventBus.h"
+
+#include "CombatStats.h"
+
+bool UCombatEventBus::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+TStatId UCombatEventBus::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatEventBus, STATGROUP_Tickables);
+}
+
+void UCombatEventBus::Tick(float DeltaTime)
+{
+	COMBAT_SCOPE_CYCLE(EventBus);
+
+	int32 NumDelivered = 0;
+	NumDelivered += DamagedChannel.Flush();
+	NumDelivered += NormalAttackHitChannel.Flush();
+	NumDelivered += StealthChannel.Flush();
+	COMBAT_COUNT(EventsDelivered, NumDelivered);
+}
+
+/*******************************************************************/
+/* UCombatEventBlueprintAdapter */
+
+bool UCombatEventBlueprintAdapter::IsRelevant(const TObjectKey<AActor>& A, const TObjectKey<AActor>& B) const
+{
+	if (!bOnlyOwnerEvents) return true;
+
+	const TObjectKey<AActor> OwnerKey(GetOwner());
+	return A == OwnerKey || B == OwnerKey;
+}
+
+void UCombatEventBlueprintAdapter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UCombatEventBus* Bus = GetWorld()->GetSubsystem<UCombatEventBus>();
+	if (!Bus) return;
+
+	DamagedSubscription = Bus->Subscribe<FCombatDamagedEvent>([this](TArrayView<const FCombatDamagedEvent> Events)
+	{
+		for (const FCombatDamagedEvent& Event : Events)
+		{
+			if (!IsRelevant(Event.Victim, Event.Instigator)) continue;
+			OnDamaged.Broadcast(Event.Victim.ResolveObjectPtr(), Event.Instigator.ResolveObjectPtr(), Event.Damage);
+		}
+	});
+
+	NormalAttackHitSubscription = Bus->Subscribe<FCombatNormalAttackHitEvent>([this](TArrayView<const FCombatNormalAttackHitEvent> Events)
+	{
+		for (const FCombatNormalAttackHitEvent& Event : Events)
+		{
+			if (!IsRelevant(Event.Attacker, Event.Target)) continue;
+			OnNormalAttackHit.Broadcast(Event.Attacker.ResolveObjectPtr(), Event.Target.ResolveObjectPtr());
+		}
+	});
+
+	StealthSubscription = Bus->Subscribe<FCombatStealthEvent>([this](TArrayView<const FCombatStealthEvent> Events)
+	{
+		for (const FCombatStealthEvent& Event : Events)
+		{
+			if (!IsRelevant(Event.Character, Event.Character)) continue;
+			OnStealthChanged.Broadcast(Event.Character.ResolveObjectPtr(), Event.bStealthed);
+		}
+	});
+}
+
+void UCombatEventBlueprintAdapter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatEventBus* Bus = GetWorld()->GetSubsystem<UCombatEventBus>())
+	{
+		Bus->Unsubscribe<FCombatDamagedEvent>(DamagedSubscription);
+		Bus->Unsubscribe<FCombatNormalAttackHitEvent>(NormalAttackHitSubscription);
+		Bus->Unsubscribe<FCombatStealthEvent>(StealthSubscription);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
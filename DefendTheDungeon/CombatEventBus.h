@@ -0,0 +1,270 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Ability/Effect/DamageEffect.h"
+#include "Components/ActorComponent.h"
+#include "Containers/Queue.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatEventBus.generated.h"
+
+/*
+ 전투 이벤트 버스
+ 다이나믹 멀티캐스트 델리게이트(ProcessEvent) 대신 쓰는 네이티브 이벤트 전달.
+ CombatComponent는 일반 공격 적중, 은신 변경을 이 버스로 보내고, 트리 밖 리스너가 옮길 때까지 캐릭터의 OnNormalAttackHit, OnCharacterStealthed도 함께 부른다.
+ - 이벤트 종류마다 타입이 있는 채널이 있고, 구독자는 연속 배열에 들어 있다.
+ - Publish는 쌓기만 하고, 프레임마다 한 번 채널별로 모아서 구독자에게 TArrayView로 넘긴다.
+ - 게임 스레드 밖 소비자는 AddAsyncConsumer로 MPSC 큐를 받아 자기 스레드에서 꺼낸다.
+ - 이벤트의 액터는 TObjectKey라 다른 스레드에서도 복사, 비교할 수 있다. 풀기(ResolveObjectPtr)는 게임 스레드에서만.
+ 블루프린트는 UCombatEventBlueprintAdapter 컴포넌트로 바인딩한다.
+ */
+
+struct FCombatDamagedEvent
+{
+	TObjectKey<AActor> Victim;
+	TObjectKey<AActor> Instigator;
+	float Damage = 0.f;
+	EAttackType AttackType = EAttackType::NormalAttack;
+};
+
+struct FCombatNormalAttackHitEvent
+{
+	TObjectKey<AActor> Attacker;
+	TObjectKey<AActor> Target;
+};
+
+//은신 변경, 다음 버스 Flush에 전달되므로 캐릭터의 OnCharacterStealthed보다 한 틱 늦다.
+struct FCombatStealthEvent
+{
+	TObjectKey<AActor> Character;
+	bool bStealthed = false;
+};
+
+struct FCombatEventSubscription
+{
+	uint32 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Invalidate() { Id = 0; }
+};
+
+//게임 스레드 밖 소비자용 큐, 버스가 넣고 소비자 스레드가 꺼낸다.
+template <typename EventType>
+using TCombatEventQueue = TQueue<EventType, EQueueMode::Mpsc>;
+
+template <typename EventType>
+class TCombatEventChannel
+{
+public:
+	using FCallback = TFunction<void(TArrayView<const EventType>)>;
+
+	void Publish(const EventType& Event) { Pending.Add(Event); }
+
+	//전달 중에는 배열이 다시 할당되면 실행 중인 콜백이 사라지므로 Flush 끝에 붙인다.
+	void Subscribe(uint32 Id, FCallback Callback)
+	{
+		if (bFlushing)
+		{
+			AddedSubscribers.Add({ Id, MoveTemp(Callback) });
+		}
+		else
+		{
+			Subscribers.Add({ Id, MoveTemp(Callback) });
+		}
+	}
+
+	//전달 중일 수 있으므로 표시만 하고 Flush 끝에서 지운다.
+	void Unsubscribe(uint32 Id)
+	{
+		for (FSubscriber& Subscriber : Subscribers)
+		{
+			if (Subscriber.Id == Id)
+			{
+				Subscriber.Id = 0;
+				bHasRemoved = true;
+			}
+		}
+		AddedSubscribers.RemoveAll([Id](const FSubscriber& Subscriber) { return Subscriber.Id == Id; });
+	}
+
+	TSharedRef<TCombatEventQueue<EventType>, ESPMode::ThreadSafe> AddAsyncConsumer()
+	{
+		TSharedRef<TCombatEventQueue<EventType>, ESPMode::ThreadSafe> Queue = MakeShared<TCombatEventQueue<EventType>, ESPMode::ThreadSafe>();
+		AsyncConsumers.Add(Queue);
+		return Queue;
+	}
+
+	//쌓인 이벤트를 한 번에 전달한다. 전달 중 Publish한 이벤트는 다음 Flush로 넘어간다.
+	int32 Flush()
+	{
+		if (Pending.Num() == 0) return 0;
+
+		Delivering.Reset();
+		Swap(Pending, Delivering);
+
+		const TArrayView<const EventType> Events(Delivering);
+		//전달 중 추가된 구독자는 이번 묶음을 받지 않는다.
+		bFlushing = true;
+		for (const FSubscriber& Subscriber : Subscribers)
+		{
+			if (Subscriber.Id == 0) continue;
+			Subscriber.Callback(Events);
+		}
+		bFlushing = false;
+
+		//큐를 들고 있는 소비자가 우리뿐이면 소비자가 떠난 것이다.
+		AsyncConsumers.RemoveAll([](const TSharedRef<TCombatEventQueue<EventType>, ESPMode::ThreadSafe>& Queue)
+		{
+			return Queue.IsUnique();
+		});
+		for (const TSharedRef<TCombatEventQueue<EventType>, ESPMode::ThreadSafe>& Queue : AsyncConsumers)
+		{
+			for (const EventType& Event : Delivering)
+			{
+				Queue->Enqueue(Event);
+			}
+		}
+
+		if (bHasRemoved)
+		{
+			Subscribers.RemoveAll([](const FSubscriber& Subscriber) { return Subscriber.Id == 0; });
+			bHasRemoved = false;
+		}
+		if (AddedSubscribers.Num() > 0)
+		{
+			Subscribers.Append(MoveTemp(AddedSubscribers));
+			AddedSubscribers.Reset();
+		}
+		return Events.Num();
+	}
+
+private:
+	struct FSubscriber
+	{
+		uint32 Id;
+		FCallback Callback;
+	};
+
+	TArray<EventType> Pending;
+	TArray<EventType> Delivering;
+	TArray<FSubscriber> Subscribers;
+	//Flush 중에 들어온 구독, Flush 끝에 Subscribers로 옮긴다.
+	TArray<FSubscriber> AddedSubscribers;
+	TArray<TSharedRef<TCombatEventQueue<EventType>, ESPMode::ThreadSafe>> AsyncConsumers;
+	bool bHasRemoved = false;
+	bool bFlushing = false;
+};
+
+/**
+ * 전투 이벤트 버스 서브시스템입니다. 게임 스레드에서 Publish, Subscribe하고 Tick에서 채널별로 전달합니다.
+ * 새 이벤트 종류는 구조체, 채널 멤버, GetChannel 특수화를 하나씩 추가합니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatEventBus : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	template <typename EventType>
+	void Publish(const EventType& Event)
+	{
+		check(IsInGameThread());
+		GetChannel<EventType>().Publish(Event);
+	}
+
+	/**
+	 * 이벤트 종류를 구독합니다. 프레임마다 그 프레임의 이벤트를 한 번에 받습니다.
+	 * @param Callback 이벤트 묶음을 받을 함수
+	 * @return 해제에 쓰는 구독 핸들
+	 */
+	template <typename EventType>
+	FCombatEventSubscription Subscribe(typename TCombatEventChannel<EventType>::FCallback Callback)
+	{
+		check(IsInGameThread());
+		const FCombatEventSubscription Subscription{ NextSubscriptionId++ };
+		GetChannel<EventType>().Subscribe(Subscription.Id, MoveTemp(Callback));
+		return Subscription;
+	}
+
+	template <typename EventType>
+	void Unsubscribe(FCombatEventSubscription& Subscription)
+	{
+		if (Subscription.IsValid())
+		{
+			GetChannel<EventType>().Unsubscribe(Subscription.Id);
+		}
+		Subscription.Invalidate();
+	}
+
+	/**
+	 * 게임 스레드 밖 소비자를 추가합니다. 돌려받은 큐를 놓으면 소비자도 해제됩니다.
+	 * @return 버스가 이벤트를 넣어 줄 MPSC 큐, 소비자 스레드에서 Dequeue한다.
+	 */
+	template <typename EventType>
+	TSharedRef<TCombatEventQueue<EventType>, ESPMode::ThreadSafe> AddAsyncConsumer()
+	{
+		check(IsInGameThread());
+		return GetChannel<EventType>().AddAsyncConsumer();
+	}
+
+private:
+	template <typename EventType>
+	TCombatEventChannel<EventType>& GetChannel();
+
+	TCombatEventChannel<FCombatDamagedEvent> DamagedChannel;
+	TCombatEventChannel<FCombatNormalAttackHitEvent> NormalAttackHitChannel;
+	TCombatEventChannel<FCombatStealthEvent> StealthChannel;
+	uint32 NextSubscriptionId = 1;
+};
+
+template <>
+inline TCombatEventChannel<FCombatDamagedEvent>& UCombatEventBus::GetChannel<FCombatDamagedEvent>() { return DamagedChannel; }
+template <>
+inline TCombatEventChannel<FCombatNormalAttackHitEvent>& UCombatEventBus::GetChannel<FCombatNormalAttackHitEvent>() { return NormalAttackHitChannel; }
+template <>
+inline TCombatEventChannel<FCombatStealthEvent>& UCombatEventBus::GetChannel<FCombatStealthEvent>() { return StealthChannel; }
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnCombatDamagedBP, AActor*, Victim, AActor*, InstigatorActor, float, Damage);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCombatNormalAttackHitBP, AActor*, Attacker, AActor*, Target);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCombatStealthBP, AActor*, Character, bool, bStealthed);
+
+/**
+ * 블루프린트용 어댑터 컴포넌트입니다. 버스를 구독해 이벤트마다 다이나믹 델리게이트로 다시 브로드캐스트합니다.
+ * 리플렉션 비용은 이 컴포넌트를 붙인 곳에서만 듭니다.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class DEFENDTHEDUNGEON_API UCombatEventBlueprintAdapter : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable, Category="Combat|Events")
+	FOnCombatDamagedBP OnDamaged;
+
+	UPROPERTY(BlueprintAssignable, Category="Combat|Events")
+	FOnCombatNormalAttackHitBP OnNormalAttackHit;
+
+	UPROPERTY(BlueprintAssignable, Category="Combat|Events")
+	FOnCombatStealthBP OnStealthChanged;
+
+	//켜면 소유 액터가 관련된 이벤트만 전달한다.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Combat|Events")
+	bool bOnlyOwnerEvents = true;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	bool IsRelevant(const TObjectKey<AActor>& A, const TObjectKey<AActor>& B) const;
+
+	FCombatEventSubscription DamagedSubscription;
+	FCombatEventSubscription NormalAttackHitSubscription;
+	FCombatEventSubscription StealthSubscription;
+};
@@ -0,0 +1,163 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatJobScheduler.h"
+
+#include "CombatStats.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	float JobBudgetMs = 1.0f;
+	FAutoConsoleVariableRef CVarJobBudgetMs(TEXT("Combat.Jobs.BudgetMs"), JobBudgetMs, TEXT("프레임당 반복 전투 작업 예산(ms), 넘으면 Critical이 아닌 작업을 다음 틱으로 미룹니다."));
+
+	constexpr double GoldenRatioFraction = 0.6180339887;
+}
+
+bool UCombatJobScheduler::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatJobScheduler::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//전투 시계의 틱마다 한 번 돈다. 같은 틱의 다른 타이머와는 등록 순서대로 실행된다.
+	Clock = Collection.InitializeDependency<UCombatClock>();
+	if (Clock)
+	{
+		StepTimer = Clock->SetTimer(this, 1, [this]() { RunDueJobs(); }, 1);
+	}
+	else
+	{
+		MY_LOG(LogTemp, Error, TEXT("No CombatClock in this world, combat jobs will not run"));
+	}
+}
+
+void UCombatJobScheduler::Deinitialize()
+{
+	if (Clock)
+	{
+		Clock->ClearTimer(StepTimer);
+	}
+	Jobs.Reset();
+	Super::Deinitialize();
+}
+
+FCombatJobHandle UCombatJobScheduler::Register(const UObject* Owner, float Interval, ECombatJobPriority Priority, TFunction<void()> Job)
+{
+	check(Interval > 0.f);
+	if (!Clock) return FCombatJobHandle();
+
+	const int32 IntervalTicks = Clock->SecondsToTicks(Interval);
+
+	//첫 실행을 주기 안의 서로 다른 위상에 두어 같은 주기 작업이 한 틱에 몰리지 않게 한다.
+	NextPhase = FMath::Fractional(NextPhase + GoldenRatioFraction);
+	const int32 PhaseTicks = FMath::FloorToInt32(NextPhase * 0.5 * IntervalTicks);
+
+	FJob& NewJob = Jobs.AddDefaulted_GetRef();
+	NewJob.Id = NextId++;
+	NewJob.Owner = Owner;
+	NewJob.Function = MoveTemp(Job);
+	NewJob.IntervalTicks = IntervalTicks;
+	NewJob.Priority = Priority;
+	NewJob.NextRunTick = Clock->GetTick() + IntervalTicks + PhaseTicks;
+
+	return FCombatJobHandle{ NewJob.Id };
+}
+
+void UCombatJobScheduler::Unregister(FCombatJobHandle& Handle)
+{
+	if (!Handle.IsValid()) return;
+
+	//작업 실행 도중일 수 있으므로 표시만 하고 RunDueJobs 끝에서 지운다.
+	for (FJob& Job : Jobs)
+	{
+		if (Job.Id == Handle.Id)
+		{
+			Job.bRemoved = true;
+			break;
+		}
+	}
+	Handle.Invalidate();
+}
+
+void UCombatJobScheduler::RunDueJobs()
+{
+	COMBAT_SCOPE_CYCLE(JobScheduler);
+
+	if (BudgetFrame != GFrameCounter)
+	{
+		BudgetFrame = GFrameCounter;
+		FrameCycles = 0;
+	}
+
+	const int64 Now = Clock->GetTick();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint64 BudgetCycles = static_cast<uint64>(JobBudgetMs / FPlatformTime::GetSecondsPerCycle64() / 1000.0);
+
+	int32 NumRun = 0;
+	int32 NumDeferred = 0;
+
+	//작업 안에서 등록하면 배열이 커질 수 있으므로 시작 시점의 개수만, 인덱스로 접근한다.
+	const int32 NumJobs = Jobs.Num();
+	for (int32 Index = 0; Index < NumJobs; Index++)
+	{
+		if (Jobs[Index].bRemoved) continue;
+		if (!Jobs[Index].Owner.IsValid())
+		{
+			Jobs[Index].bRemoved = true;
+			continue;
+		}
+		if (Jobs[Index].NextRunTick > Now) continue;
+
+		const bool bOverBudget = FrameCycles + (FPlatformTime::Cycles64() - StartCycles) >= BudgetCycles;
+		const int32 MaxDeferTicks = Jobs[Index].Priority == ECombatJobPriority::Cosmetic ? MaxCosmeticDeferTicks : MaxNormalDeferTicks;
+		const bool bMustRun = Jobs[Index].Priority == ECombatJobPriority::Critical || Jobs[Index].DeferredTicks >= MaxDeferTicks;
+		if (bOverBudget && !bMustRun)
+		{
+			Jobs[Index].DeferredTicks++;
+			NumDeferred++;
+			if (Jobs[Index].Priority == ECombatJobPriority::Cosmetic)
+			{
+				Stats.CosmeticDeferrals++;
+			}
+			continue;
+		}
+
+		Stats.MaxDeferTicks = FMath::Max(Stats.MaxDeferTicks, Jobs[Index].DeferredTicks);
+		Jobs[Index].DeferredTicks = 0;
+		//원래 일정 기준으로 다음 실행 틱을 잡아 주기가 밀리지 않게 한다.
+		Jobs[Index].NextRunTick = FMath::Max(Jobs[Index].NextRunTick + Jobs[Index].IntervalTicks, Now + 1);
+
+		//작업이 배열을 바꿀 수 있으므로 복사해서 호출
+		const TFunction<void()> Function = Jobs[Index].Function;
+		Function();
+		NumRun++;
+	}
+
+	Jobs.RemoveAll([](const FJob& Job) { return Job.bRemoved; });
+
+	FrameCycles += FPlatformTime::Cycles64() - StartCycles;
+	Stats.Runs += NumRun;
+	Stats.Deferrals += NumDeferred;
+	Stats.MaxFrameMs = FMath::Max(Stats.MaxFrameMs, FPlatformTime::ToMilliseconds64(FrameCycles));
+	COMBAT_COUNT(JobsRun, NumRun);
+	COMBAT_COUNT(JobsDeferred, NumDeferred);
+}
+
+static FAutoConsoleCommandWithWorld JobStatsCommand(
+	TEXT("Combat.Jobs.Stats"),
+	TEXT("반복 전투 작업의 실행, 지연 통계를 출력합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const UCombatJobScheduler* Scheduler = World ? World->GetSubsystem<UCombatJobScheduler>() : nullptr;
+		if (!Scheduler) return;
+
+		const UCombatJobScheduler::FStats& Stats = Scheduler->GetStats();
+		MY_LOG(LogTemp, Log, TEXT("Combat jobs, Runs %llu, Deferrals %llu (Cosmetic %llu), MaxDeferTicks %d, MaxFrameMs %.3f"),
+			Stats.Runs, Stats.Deferrals, Stats.CosmeticDeferrals, Stats.MaxDeferTicks, Stats.MaxFrameMs);
+	}));
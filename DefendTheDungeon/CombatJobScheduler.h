@@ -0,0 +1,106 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatClock.h"
+#include "CombatJobScheduler.generated.h"
+
+//작업 우선순위, 예산을 넘으면 Critical이 아닌 작업부터 다음 틱으로 미룬다.
+enum class ECombatJobPriority : uint8
+{
+	//게임플레이 판정, 미루지 않는다.
+	Critical,
+	//주기 판정, 늦어도 MaxNormalDeferTicks 안에 실행
+	Normal,
+	//연출 피드백, 늦어도 MaxCosmeticDeferTicks 안에 실행
+	Cosmetic,
+};
+
+struct FCombatJobHandle
+{
+	uint32 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Invalidate() { Id = 0; }
+};
+
+/**
+ * 반복 전투 작업 스케줄러입니다. 전투 시계(UCombatClock)의 틱 위에서 돕니다.
+ * 전투 시계 타이머는 같은 틱에 만기된 작업을 그 틱에 모두 실행하므로, 같은 주기의 시전자가 많으면 그 프레임만 튑니다.
+ *	- 등록할 때 주기 안에서 위상을 흩어 같은 주기의 작업이 서로 다른 틱에 돌게 한다.
+ *	- 한 프레임에 쓴 시간이 예산(Combat.Jobs.BudgetMs)을 넘으면 Normal, Cosmetic 작업을 다음 틱으로 미룬다. Cosmetic이 더 오래 밀린다.
+ *	- 미뤄도 실행 주기는 밀리지 않는다. 다음 실행 틱은 원래 일정 기준으로 잡으므로 반복 횟수는 그대로다.
+ * 통계는 stat combat 의 Jobs Run, Jobs Deferred 와 Combat.Jobs.Stats 로 확인합니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatJobScheduler : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * 반복 작업을 등록합니다.
+	 * @param Owner 작업 소유 객체, 사라지면 작업도 자동으로 해제된다.
+	 * @param Interval 실행 주기(초), 전투 시계 틱으로 반올림한다.
+	 * @param Priority 우선순위
+	 * @param Job 실행할 함수
+	 * @return 해제에 쓰는 핸들
+	 */
+	FCombatJobHandle Register(const UObject* Owner, float Interval, ECombatJobPriority Priority, TFunction<void()> Job);
+
+	//작업을 해제합니다. 작업 안에서 자기 자신을 해제해도 된다.
+	void Unregister(FCombatJobHandle& Handle);
+
+	struct FStats
+	{
+		uint64 Runs = 0;
+		uint64 Deferrals = 0;
+		uint64 CosmeticDeferrals = 0;
+		//미뤄진 작업이 실행될 때까지 기다린 최대 틱 수
+		int32 MaxDeferTicks = 0;
+		//한 프레임에 작업에 쓴 최대 시간
+		double MaxFrameMs = 0.0;
+	};
+	const FStats& GetStats() const { return Stats; }
+
+	//예산과 관계없이 실행하기 전까지 미룰 수 있는 최대 틱 수
+	static constexpr int32 MaxNormalDeferTicks = 2;
+	static constexpr int32 MaxCosmeticDeferTicks = 8;
+
+private:
+	struct FJob
+	{
+		uint32 Id;
+		TWeakObjectPtr<const UObject> Owner;
+		TFunction<void()> Function;
+		int64 NextRunTick;
+		int32 IntervalTicks;
+		ECombatJobPriority Priority;
+		int32 DeferredTicks = 0;
+		bool bRemoved = false;
+	};
+
+	//전투 시계가 틱마다 부른다.
+	void RunDueJobs();
+
+	UPROPERTY()
+	TObjectPtr<UCombatClock> Clock;
+	FCombatTimerHandle StepTimer;
+
+	TArray<FJob> Jobs;
+	uint32 NextId = 1;
+	//위상 분산용, 등록할 때마다 황금비만큼 돈다.
+	double NextPhase = 0.0;
+
+	//예산은 프레임 단위, 한 프레임에 시계가 여러 틱을 따라잡아도 같은 예산을 나눠 쓴다.
+	uint64 BudgetFrame = MAX_uint64;
+	uint64 FrameCycles = 0;
+
+	FStats Stats;
+};
@@ -0,0 +1,293 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatLoadTestDirector.h"
+
+#include "CombatComponent.h"
+#include "CombatReplay.h"
+#include "CombatStats.h"
+#include "DefendTheDungeon/Character/DDCharacter.h"
+#include "DefendTheDungeon/Character/Monster/MonsterBase.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "Engine/NetDriver.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	float Percentile(const TArray<float>& Sorted, float P)
+	{
+		if (Sorted.Num() == 0) return 0.f;
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(P * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+
+	uint64 GetOutBytes(const UWorld* World)
+	{
+		const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		return NetDriver ? static_cast<uint64>(NetDriver->OutTotalBytes) : 0;
+	}
+}
+
+ACombatLoadTestDirector::ACombatLoadTestDirector()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	bReplicates = false;
+}
+
+void ACombatLoadTestDirector::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//서버에서만 동작한다.
+	if (!HasAuthority())
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	if (!CharacterClass || !MonsterClass)
+	{
+		SetActorTickEnabled(false);
+		LOG_RETURN(Error, TEXT("CombatLoadTestDirector needs CharacterClass and MonsterClass"));
+	}
+
+	ParseCommandLine();
+	SpawnCombatants();
+	MY_LOG(LogTemp, Log, TEXT("Combat load test started, Characters %d, Monsters %d"), Characters.Num(), Monsters.Num());
+}
+
+void ACombatLoadTestDirector::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//측정 도중 종료되어도 그때까지의 결과는 남긴다.
+	if (bMeasuring && !bFinished)
+	{
+		FinishTest();
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACombatLoadTestDirector::ParseCommandLine()
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("CombatLoadTestPlayers="), NumCharacters);
+	FParse::Value(CommandLine, TEXT("CombatLoadTestMonsters="), NumMonsters);
+	FParse::Value(CommandLine, TEXT("CombatLoadTestDuration="), TestDuration);
+	FParse::Value(CommandLine, TEXT("CombatLoadTestCsv="), CsvPath);
+
+	FString ModeName;
+	if (FParse::Value(CommandLine, TEXT("CombatLoadTestWeapon="), ModeName))
+	{
+		const int64 Value = StaticEnum<EWeaponMode>()->GetValueByNameString(ModeName);
+		if (Value != INDEX_NONE) WeaponMode = static_cast<EWeaponMode>(Value);
+		else MY_LOG(LogTemp, Warning, TEXT("Unknown WeaponMode %s"), *ModeName);
+	}
+	if (FParse::Value(CommandLine, TEXT("CombatLoadTestSubWeapon="), ModeName))
+	{
+		const int64 Value = StaticEnum<ESubWeaponMode>()->GetValueByNameString(ModeName);
+		if (Value != INDEX_NONE) SubWeaponMode = static_cast<ESubWeaponMode>(Value);
+		else MY_LOG(LogTemp, Warning, TEXT("Unknown SubWeaponMode %s"), *ModeName);
+	}
+
+	NumCharacters = FMath::Max(NumCharacters, 0);
+	NumMonsters = FMath::Max(NumMonsters, 0);
+}
+
+void ACombatLoadTestDirector::SpawnCombatants()
+{
+	UWorld* World = GetWorld();
+	const FVector Center = GetActorLocation();
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 i = 0; i < NumCharacters; i++)
+	{
+		//캐릭터는 안쪽 원에 고르게 배치
+		const float Angle = 2.f * PI * i / FMath::Max(NumCharacters, 1);
+		const FVector Location = Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * SpawnRadius * 0.25f;
+
+		//무기 모드는 BeginPlay 전에 정하고, 스폰이 끝난 뒤 그 모드의 준비(풀 등록 등)를 다시 돌린다.
+		const FTransform Transform(FRotator(0.f, FMath::RadiansToDegrees(Angle), 0.f), Location);
+		ADDCharacter* Character = World->SpawnActorDeferred<ADDCharacter>(CharacterClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+		if (!Character) continue;
+
+		Character->WeaponMode = WeaponMode;
+		Character->SubWeaponMode = SubWeaponMode;
+		Character->FinishSpawning(Transform);
+
+		Character->SpawnDefaultController();
+		Character->GetCombatComponent()->OnSubWeaponModeChanged();
+		Character->GetCombatComponent()->ResetValue();
+
+		Characters.Add(Character);
+		//캐릭터마다 시작 단계와 시각을 어긋나게 해서 한 프레임에 몰리지 않게 한다.
+		NextStep.Add(static_cast<uint8>(i % static_cast<int32>(ECombatLoadTestStep::MAX)));
+		NextStepTime.Add(StepInterval * i / FMath::Max(NumCharacters, 1));
+	}
+
+	for (int32 i = 0; i < NumMonsters; i++)
+	{
+		const FVector2D Offset = FMath::RandPointInCircle(SpawnRadius);
+		const FVector Location = Center + FVector(Offset.X, Offset.Y, 0.f);
+
+		if (AMonsterBase* Monster = World->SpawnActor<AMonsterBase>(MonsterClass, Location, FRotator::ZeroRotator, SpawnParameters))
+		{
+			Monster->SpawnDefaultController();
+			Monsters.Add(Monster);
+		}
+	}
+}
+
+void ACombatLoadTestDirector::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished) return;
+
+	ElapsedTime += DeltaSeconds;
+
+	if (!bMeasuring && ElapsedTime >= WarmupDuration)
+	{
+		bMeasuring = true;
+		StartRemoteCalls = UCombatComponent::GetTotalRemoteCalls();
+		StartOutBytes = GetOutBytes(GetWorld());
+		CombatFunctionTiming::Reset();
+		CombatFunctionTiming::bEnabled = true;
+	}
+
+	if (bMeasuring)
+	{
+		//대기 시간을 뺀 실제 프레임 비용
+		FrameTimes.Add(static_cast<float>((FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0));
+	}
+
+	//녹화 재생 중에는 기록된 입력만 넣는다.
+	const UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>();
+	const bool bReplaying = Replay && Replay->IsReplaying();
+
+	for (int32 i = 0; i < Characters.Num() && !bReplaying; i++)
+	{
+		if (!IsValid(Characters[i]) || ElapsedTime < NextStepTime[i]) continue;
+
+		const ECombatLoadTestStep Step = static_cast<ECombatLoadTestStep>(NextStep[i]);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		RunStep(Characters[i], Step);
+		if (bMeasuring)
+		{
+			StepCycles[NextStep[i]] += FPlatformTime::Cycles64() - StartCycles;
+			StepCounts[NextStep[i]]++;
+		}
+
+		NextStep[i] = (NextStep[i] + 1) % static_cast<uint8>(ECombatLoadTestStep::MAX);
+		NextStepTime[i] += StepInterval;
+	}
+
+	if (ElapsedTime >= WarmupDuration + TestDuration)
+	{
+		FinishTest();
+		FGenericPlatformMisc::RequestExit(false);
+	}
+}
+
+void ACombatLoadTestDirector::RunStep(ADDCharacter* Character, ECombatLoadTestStep Step)
+{
+	UCombatComponent* CombatComponent = Character->GetCombatComponent();
+	if (!CombatComponent) return;
+
+	//서버에서 Server RPC를 호출하면 바로 실행된다.
+	switch (Step)
+	{
+	case ECombatLoadTestStep::Attack:
+		CombatComponent->Attack();
+		break;
+	case ECombatLoadTestStep::Dash:
+		CombatComponent->Server_Dash(ENoWeaponDash::Front);
+		break;
+	case ECombatLoadTestStep::SkillE:
+		//E 스킬 시전 후 AN_ESkill 대신 보조무기 스킬을 직접 호출하고, 조준형 스킬은 바로 확정한다.
+		if (CombatComponent->SkillE())
+		{
+			CombatComponent->SubWeaponSkill();
+			CombatComponent->Server_Skill_Confirm_SubWeapon();
+		}
+		break;
+	case ECombatLoadTestStep::Block:
+		CombatComponent->Block();
+		break;
+	case ECombatLoadTestStep::Stun:
+		CombatComponent->Stun(StepInterval);
+		break;
+	default:
+		break;
+	}
+}
+
+void ACombatLoadTestDirector::FinishTest()
+{
+	bFinished = true;
+	CombatFunctionTiming::bEnabled = false;
+	EndRemoteCalls = UCombatComponent::GetTotalRemoteCalls();
+	EndOutBytes = GetOutBytes(GetWorld());
+	WriteCsv();
+}
+
+void ACombatLoadTestDirector::WriteCsv() const
+{
+	const FString FullPath = FPaths::IsRelative(CsvPath) ? FPaths::Combine(FPaths::ProjectSavedDir(), CsvPath) : CsvPath;
+	const bool bWriteHeader = !IFileManager::Get().FileExists(*FullPath);
+
+	TArray<float> Sorted = FrameTimes;
+	Sorted.Sort();
+
+	const float MeasuredTime = FMath::Max(ElapsedTime - WarmupDuration, KINDA_SMALL_NUMBER);
+	const UEnum* StepEnum = StaticEnum<ECombatLoadTestStep>();
+
+	FString Csv;
+	if (bWriteHeader)
+	{
+		Csv += TEXT("Characters,Monsters,WeaponMode,SubWeaponMode,Frames,FrameP50Ms,FrameP95Ms,FrameP99Ms,FrameMaxMs");
+		for (int32 i = 0; i < static_cast<int32>(ECombatLoadTestStep::MAX); i++)
+		{
+			Csv += FString::Printf(TEXT(",%sAvgUs,%sCount"), *StepEnum->GetNameStringByIndex(i), *StepEnum->GetNameStringByIndex(i));
+		}
+		for (int32 i = 0; i < static_cast<int32>(CombatFunctionTiming::EFunction::MAX); i++)
+		{
+			const TCHAR* Name = CombatFunctionTiming::GetName(static_cast<CombatFunctionTiming::EFunction>(i));
+			Csv += FString::Printf(TEXT(",%sMsPerSec,%sAvgUs,%sCallsPerSec"), Name, Name, Name);
+		}
+		Csv += TEXT(",RemoteCallsPerSec,OutKBytesPerSec\n");
+	}
+
+	Csv += FString::Printf(TEXT("%d,%d,%s,%s,%d,%.3f,%.3f,%.3f,%.3f"),
+		Characters.Num(), Monsters.Num(),
+		*StaticEnum<EWeaponMode>()->GetNameStringByValue(static_cast<int64>(WeaponMode)),
+		*StaticEnum<ESubWeaponMode>()->GetNameStringByValue(static_cast<int64>(SubWeaponMode)),
+		Sorted.Num(), Percentile(Sorted, 0.5f), Percentile(Sorted, 0.95f), Percentile(Sorted, 0.99f),
+		Sorted.Num() > 0 ? Sorted.Last() : 0.f);
+
+	for (int32 i = 0; i < static_cast<int32>(ECombatLoadTestStep::MAX); i++)
+	{
+		const double AvgUs = StepCounts[i] > 0 ? FPlatformTime::ToMilliseconds64(StepCycles[i]) * 1000.0 / StepCounts[i] : 0.0;
+		Csv += FString::Printf(TEXT(",%.2f,%u"), AvgUs, StepCounts[i]);
+	}
+
+	//함수별 서버 CPU 시간, 초당 누적 ms와 호출당 평균
+	for (const CombatFunctionTiming::FTotal& Total : CombatFunctionTiming::Totals)
+	{
+		const double TotalMs = FPlatformTime::ToMilliseconds64(Total.Cycles);
+		Csv += FString::Printf(TEXT(",%.3f,%.2f,%.1f"), TotalMs / MeasuredTime, Total.Calls > 0 ? TotalMs * 1000.0 / Total.Calls : 0.0, Total.Calls / MeasuredTime);
+	}
+
+	Csv += FString::Printf(TEXT(",%.1f,%.2f\n"),
+		(EndRemoteCalls - StartRemoteCalls) / MeasuredTime,
+		(EndOutBytes - StartOutBytes) / 1024.f / MeasuredTime);
+
+	if (!FFileHelper::SaveStringToFile(Csv, *FullPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		MY_LOG(LogTemp, Error, TEXT("Failed to write combat load test csv %s"), *FullPath);
+		return;
+	}
+	MY_LOG(LogTemp, Log, TEXT("Combat load test written to %s"), *FullPath);
+}
@@ -0,0 +1,120 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "DefendTheDungeon/ETC/Enum/Enum.h"
+#include "CombatLoadTestDirector.generated.h"
+
+class ADDCharacter;
+class AMonsterBase;
+
+//로드 테스트 스크립트 한 단계
+UENUM()
+enum class ECombatLoadTestStep : uint8
+{
+	Attack,
+	Dash,
+	SkillE,
+	Block,
+	Stun,
+	MAX UMETA(Hidden)
+};
+
+/**
+ * UCombatComponent 부하 측정용 디렉터 액터입니다.
+ * 로드 테스트 맵에 배치하고, 데디케이티드 서버를 -nullrhi로 실행하면
+ * 캐릭터 N명과 몬스터 M마리를 소환해 정해진 행동(Attack, Dash, SkillE, Block, Stun)을 반복시키고,
+ * 종료 시 프레임 시간 백분위, 함수별(COMBAT_SCOPE_CYCLE 구간) CPU 시간, 단계별 CPU 시간, RPC 수, 송신 대역폭을 CSV 한 줄로 기록합니다.
+ *
+ * 실행 예시
+ *	DefendTheDungeonServer CombatLoadTestMap -nullrhi -unattended -log
+ *		-CombatLoadTestPlayers=16 -CombatLoadTestMonsters=200
+ *		-CombatLoadTestWeapon=DoubleSword -CombatLoadTestSubWeapon=Sub_DarkMagicOrb
+ *		-CombatLoadTestDuration=60 -CombatLoadTestCsv=Profiling/CombatLoadTest.csv
+ *
+ * 상대 경로는 Saved 폴더 기준입니다. 캐릭터는 지연 스폰으로 무기 모드를 먼저 정한 뒤 BeginPlay가 돌게 합니다.
+ * CSV는 이어 쓰기 때문에, 인원 수를 바꿔가며 여러 번 실행하면 스케일링 곡선이 한 파일에 쌓입니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API ACombatLoadTestDirector : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACombatLoadTestDirector();
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	TSubclassOf<ADDCharacter> CharacterClass;
+
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	TSubclassOf<AMonsterBase> MonsterClass;
+
+	//커맨드 라인 -CombatLoadTestPlayers= 로 덮어쓸 수 있다.
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	int32 NumCharacters = 8;
+
+	//커맨드 라인 -CombatLoadTestMonsters= 로 덮어쓸 수 있다.
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	int32 NumMonsters = 50;
+
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	EWeaponMode WeaponMode;
+
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	ESubWeaponMode SubWeaponMode;
+
+	//측정 시간(초), 끝나면 CSV를 쓰고 서버를 종료한다.
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	float TestDuration = 60.f;
+
+	//처음 몇 초는 소환, 로딩 히치가 섞이므로 측정하지 않는다.
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	float WarmupDuration = 5.f;
+
+	//캐릭터마다 다음 행동까지의 간격(초)
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	float StepInterval = 0.5f;
+
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	float SpawnRadius = 2000.f;
+
+	//Saved 폴더 기준 상대 경로, 또는 절대 경로
+	UPROPERTY(EditAnywhere, Category="LoadTest")
+	FString CsvPath = TEXT("Profiling/CombatLoadTest.csv");
+
+private:
+	void ParseCommandLine();
+	void SpawnCombatants();
+	void RunStep(ADDCharacter* Character, ECombatLoadTestStep Step);
+	void FinishTest();
+	void WriteCsv() const;
+
+	UPROPERTY()
+	TArray<ADDCharacter*> Characters;
+
+	UPROPERTY()
+	TArray<AMonsterBase*> Monsters;
+
+	//캐릭터별 다음 스크립트 단계, 다음 실행 시각
+	TArray<uint8> NextStep;
+	TArray<float> NextStepTime;
+
+	//측정 값
+	TArray<float> FrameTimes;
+	uint64 StepCycles[static_cast<int32>(ECombatLoadTestStep::MAX)] = {};
+	uint32 StepCounts[static_cast<int32>(ECombatLoadTestStep::MAX)] = {};
+	uint64 StartRemoteCalls = 0;
+	uint64 StartOutBytes = 0;
+	uint64 EndRemoteCalls = 0;
+	uint64 EndOutBytes = 0;
+	float ElapsedTime = 0.f;
+	bool bMeasuring = false;
+	bool bFinished = false;
+};
@@ -0,0 +1,319 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatNetAccounting.h"
+
+#include "Components/ActorComponent.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/UnrealNetwork.h"
+
+namespace
+{
+	bool bAccountingEnabled = false;
+	FAutoConsoleVariableRef CVarAccounting(TEXT("Combat.Net.Accounting"), bAccountingEnabled, TEXT("CombatComponent의 RPC, 프로퍼티별 송신 비트를 연결별로 집계합니다."));
+
+	//예산 검사 주기(초)
+	constexpr double WindowSeconds = 1.0;
+
+	//프로퍼티 핸들 등 변경 하나에 붙는 헤더 추정치
+	constexpr uint64 PropertyHeaderBits = 8;
+
+	//리플리케이션 직렬화 크기 추정, 패키지 맵 없이 계산하므로 오브젝트는 NetGUID 크기로 본다.
+	uint64 EstimatePropertyBits(const FProperty* Property, const void* Value)
+	{
+		if (Property->IsA<FBoolProperty>()) return 1;
+		if (Property->IsA<FObjectPropertyBase>()) return 32;
+		if (const FNameProperty* NameProperty = CastField<FNameProperty>(Property))
+		{
+			//하드코딩된 이름은 인덱스로, 나머지는 문자열과 번호로 보낸다.
+			const FName Name = NameProperty->GetPropertyValue(Value);
+			return Name.ToEName() ? 16 : (Name.GetStringLength() + 1) * 8 + 32;
+		}
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			uint64 Bits = 0;
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				if (It->HasAnyPropertyFlags(CPF_RepSkip)) continue;
+				Bits += EstimatePropertyBits(*It, It->ContainerPtrToValuePtr<void>(Value));
+			}
+			return Bits;
+		}
+		return static_cast<uint64>(Property->GetSize()) * 8;
+	}
+
+	//리플리케이션 조건으로 이 연결에 보내는지 판단한다. 커스텀 조건(ACTIVE_OVERRIDE)은 보낸다고 본다.
+	bool ShouldSendTo(ELifetimeCondition Condition, bool bOwner, bool bInitial)
+	{
+		switch (Condition)
+		{
+		case COND_InitialOnly: return bInitial;
+		case COND_OwnerOnly:
+		case COND_AutonomousOnly: return bOwner;
+		case COND_SkipOwner:
+		case COND_SimulatedOnly: return !bOwner;
+		case COND_InitialOrOwner: return bInitial || bOwner;
+		case COND_Never: return false;
+		default: return true;
+		}
+	}
+
+	FString GetConnectionName(const UNetConnection* Connection)
+	{
+		if (Connection->PlayerController) return Connection->PlayerController->GetName();
+		return Connection->GetName();
+	}
+}
+
+FCombatNetAccounting& FCombatNetAccounting::Get()
+{
+	static FCombatNetAccounting Instance;
+	return Instance;
+}
+
+bool FCombatNetAccounting::IsEnabled()
+{
+	return bAccountingEnabled;
+}
+
+FCombatNetAccounting::FShadowState::~FShadowState()
+{
+	for (int32 Index = 0; Index < Values.Num(); Index++)
+	{
+		Properties[Index]->DestroyValue(Values[Index].GetData());
+	}
+}
+
+uint64 FCombatNetAccounting::GetSentBits(const UNetConnection* Connection)
+{
+	//아직 패킷으로 나가지 않은 비트까지 포함
+	return static_cast<uint64>(Connection->OutTotalBytes) * 8 + Connection->SendBuffer.GetNumBits();
+}
+
+void FCombatNetAccounting::GatherConnections(const UActorComponent* Component, const UFunction* Function, TArray<UNetConnection*>& OutConnections) const
+{
+	const AActor* Owner = Component->GetOwner();
+	if (!Owner) return;
+
+	const UNetDriver* NetDriver = Owner->GetNetDriver();
+	if (NetDriver && NetDriver->IsServer() && Function->HasAnyFunctionFlags(FUNC_NetMulticast))
+	{
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection && Connection->FindActorChannelRef(Owner))
+			{
+				OutConnections.Add(Connection);
+			}
+		}
+		return;
+	}
+
+	if (UNetConnection* Connection = Owner->GetNetConnection())
+	{
+		OutConnections.Add(Connection);
+	}
+}
+
+void FCombatNetAccounting::BeginRPC(const UActorComponent* Component, const UFunction* Function)
+{
+	PendingRPC.Reset();
+
+	TArray<UNetConnection*> Targets;
+	GatherConnections(Component, Function, Targets);
+	for (UNetConnection* Connection : Targets)
+	{
+		PendingRPC.Emplace(Connection, GetSentBits(Connection));
+	}
+}
+
+void FCombatNetAccounting::EndRPC(const UActorComponent* Component, const UFunction* Function)
+{
+	for (const TPair<TWeakObjectPtr<UNetConnection>, uint64>& Pending : PendingRPC)
+	{
+		UNetConnection* Connection = Pending.Key.Get();
+		if (!Connection) continue;
+
+		const uint64 SentBits = GetSentBits(Connection);
+		Record(Connection, Function->GetFName(), true, SentBits > Pending.Value ? SentBits - Pending.Value : 0);
+	}
+	PendingRPC.Reset();
+}
+
+void FCombatNetAccounting::RecordPropertyChanges(const UActorComponent* Component, FShadowState& Shadow)
+{
+	if (!Shadow.bInitialized)
+	{
+		Shadow.bInitialized = true;
+
+		TArray<FLifetimeProperty> LifetimeProps;
+		Component->GetLifetimeReplicatedProps(LifetimeProps);
+
+		for (TFieldIterator<FProperty> It(Component->GetClass()); It; ++It)
+		{
+			if (!It->HasAnyPropertyFlags(CPF_Net)) continue;
+
+			const FLifetimeProperty* Lifetime = LifetimeProps.FindByPredicate([RepIndex = It->RepIndex](const FLifetimeProperty& Prop) { return Prop.RepIndex == RepIndex; });
+			const ELifetimeCondition Condition = Lifetime ? Lifetime->Condition : COND_None;
+			if (Condition == COND_Never) continue;
+
+			TArray<uint8>& Value = Shadow.Values.AddDefaulted_GetRef();
+			Value.SetNumZeroed(It->GetSize());
+			It->InitializeValue(Value.GetData());
+			Shadow.Properties.Add(*It);
+			Shadow.Conditions.Add(static_cast<uint8>(Condition));
+		}
+		//첫 리플리케이션은 전부 보내므로 초기값과 비교하게 둔다.
+	}
+
+	const AActor* Owner = Component->GetOwner();
+	const UNetDriver* NetDriver = Owner ? Owner->GetNetDriver() : nullptr;
+	if (!NetDriver || !NetDriver->IsServer()) return;
+
+	TArray<UNetConnection*, TInlineAllocator<16>> Targets;
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection && Connection->FindActorChannelRef(Owner))
+		{
+			Targets.Add(Connection);
+		}
+	}
+	const UNetConnection* OwnerConnection = Owner->GetNetConnection();
+	const bool bInitial = !Shadow.bSentInitial && Targets.Num() > 0;
+	if (bInitial) Shadow.bSentInitial = true;
+
+	for (int32 Index = 0; Index < Shadow.Properties.Num(); Index++)
+	{
+		const FProperty* Property = Shadow.Properties[Index];
+		const void* Current = Property->ContainerPtrToValuePtr<void>(Component);
+		void* Previous = Shadow.Values[Index].GetData();
+		if (Property->Identical(Current, Previous)) continue;
+
+		Property->CopyCompleteValue(Previous, Current);
+		if (Targets.Num() == 0) continue;
+
+		const ELifetimeCondition Condition = static_cast<ELifetimeCondition>(Shadow.Conditions[Index]);
+		const uint64 Bits = EstimatePropertyBits(Property, Current) + PropertyHeaderBits;
+		for (UNetConnection* Connection : Targets)
+		{
+			if (ShouldSendTo(Condition, Connection == OwnerConnection, bInitial))
+			{
+				Record(Connection, Property->GetFName(), false, Bits);
+			}
+		}
+	}
+}
+
+void FCombatNetAccounting::Record(UNetConnection* Connection, FName Name, bool bRPC, uint64 Bits)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	FConnectionStats* Stats = Connections.Find(Connection);
+	if (!Stats)
+	{
+		Stats = &Connections.Add(Connection);
+		Stats->Name = GetConnectionName(Connection);
+		Stats->WindowStart = Now;
+	}
+
+	if (Now - Stats->WindowStart >= WindowSeconds)
+	{
+		CloseWindow(*Stats, Now);
+	}
+
+	FEntry& Entry = Stats->Entries.FindOrAdd(Name);
+	Entry.bRPC = bRPC;
+	Entry.Count++;
+	Entry.TotalBits += Bits;
+	Entry.WindowBits += Bits;
+	Stats->WindowTotalBits += Bits;
+}
+
+void FCombatNetAccounting::CloseWindow(FConnectionStats& Stats, double Now)
+{
+	const UCombatNetBudgetSettings* Settings = GetDefault<UCombatNetBudgetSettings>();
+	const double Elapsed = Now - Stats.WindowStart;
+
+	for (TPair<FName, FEntry>& Pair : Stats.Entries)
+	{
+		FEntry& Entry = Pair.Value;
+		const uint64 BitsPerSecond = static_cast<uint64>(Entry.WindowBits / Elapsed);
+		Entry.PeakBitsPerSecond = FMath::Max(Entry.PeakBitsPerSecond, BitsPerSecond);
+		Entry.WindowBits = 0;
+
+		const float* Budget = Settings->BudgetBitsPerSecond.Find(Pair.Key);
+		const float Limit = Budget ? *Budget : Settings->DefaultBudgetBitsPerSecond;
+		if (BitsPerSecond > Limit)
+		{
+			MY_LOG(LogTemp, Warning, TEXT("Combat net budget exceeded, %s %s %llu bits/s%s (budget %.0f)"), *Stats.Name, *Pair.Key.ToString(), BitsPerSecond, Entry.bRPC ? TEXT("") : TEXT(" estimated"), Limit);
+		}
+	}
+
+	const uint64 TotalBitsPerSecond = static_cast<uint64>(Stats.WindowTotalBits / Elapsed);
+	if (TotalBitsPerSecond > Settings->ComponentBudgetBitsPerSecond)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Combat net budget exceeded, %s total %llu bits/s (budget %.0f)"), *Stats.Name, TotalBitsPerSecond, Settings->ComponentBudgetBitsPerSecond);
+	}
+
+	Stats.WindowTotalBits = 0;
+	Stats.WindowStart = Now;
+}
+
+int32 FCombatNetAccounting::DumpCsv(const FString& Path) const
+{
+	const double Now = FPlatformTime::Seconds();
+
+	FString Csv = TEXT("Connection,Kind,Source,Name,Count,TotalBits,AvgBitsPerCall,PeakBitsPerSecond\n");
+	int32 NumRows = 0;
+	for (const TPair<TWeakObjectPtr<UNetConnection>, FConnectionStats>& Connection : Connections)
+	{
+		for (const TPair<FName, FEntry>& Pair : Connection.Value.Entries)
+		{
+			const FEntry& Entry = Pair.Value;
+			//아직 닫히지 않은 구간도 최고치에 반영
+			const double Elapsed = FMath::Max(Now - Connection.Value.WindowStart, WindowSeconds);
+			const uint64 Peak = FMath::Max(Entry.PeakBitsPerSecond, static_cast<uint64>(Entry.WindowBits / Elapsed));
+
+			Csv += FString::Printf(TEXT("%s,%s,%s,%s,%u,%llu,%.1f,%llu\n"),
+				*Connection.Value.Name, Entry.bRPC ? TEXT("RPC") : TEXT("Property"), Entry.bRPC ? TEXT("Measured") : TEXT("Estimated"), *Pair.Key.ToString(),
+				Entry.Count, Entry.TotalBits, Entry.Count > 0 ? static_cast<double>(Entry.TotalBits) / Entry.Count : 0.0, Peak);
+			NumRows++;
+		}
+	}
+
+	const FString FullPath = FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectSavedDir(), Path) : Path;
+	if (!FFileHelper::SaveStringToFile(Csv, *FullPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		MY_LOG(LogTemp, Error, TEXT("Failed to write combat net accounting %s"), *FullPath);
+		return 0;
+	}
+	return NumRows;
+}
+
+void FCombatNetAccounting::Reset()
+{
+	Connections.Reset();
+	PendingRPC.Reset();
+}
+
+static FAutoConsoleCommand DumpNetAccountingCommand(
+	TEXT("Combat.Net.DumpAccounting"),
+	TEXT("연결별 RPC, 프로퍼티 송신 비트를 CSV로 저장합니다. 인자: [경로]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Path = Args.Num() > 0 ? Args[0] : TEXT("Profiling/CombatNetAccounting.csv");
+		const int32 NumRows = FCombatNetAccounting::Get().DumpCsv(Path);
+		MY_LOG(LogTemp, Log, TEXT("Combat net accounting, %d rows written to %s. Property bits are estimates; use netprofile or Networking Insights for measured property data."), NumRows, *Path);
+	}));
+
+static FAutoConsoleCommand ResetNetAccountingCommand(
+	TEXT("Combat.Net.ResetAccounting"),
+	TEXT("네트워크 비용 집계를 초기화합니다."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FCombatNetAccounting::Get().Reset();
+	}));
@@ -0,0 +1,104 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "CombatNetAccounting.generated.h"
+
+class UActorComponent;
+class UNetConnection;
+
+/**
+ * UCombatComponent 네트워크 예산 설정입니다. DefaultGame.ini의 [/Script/DefendTheDungeon.CombatNetBudgetSettings]에서 바꿀 수 있습니다.
+ * 예산은 연결 하나당 초당 비트 수이며, 넘으면 경고 로그를 남깁니다.
+ */
+UCLASS(Config=Game, DefaultConfig, meta=(DisplayName="Combat Net Budget"))
+class DEFENDTHEDUNGEON_API UCombatNetBudgetSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	//컴포넌트 전체(모든 RPC + 프로퍼티) 예산
+	UPROPERTY(Config, EditAnywhere, Category="Budget")
+	float ComponentBudgetBitsPerSecond = 32000.f;
+
+	//따로 지정하지 않은 RPC, 프로퍼티의 예산
+	UPROPERTY(Config, EditAnywhere, Category="Budget")
+	float DefaultBudgetBitsPerSecond = 8000.f;
+
+	//RPC 이름 또는 프로퍼티 이름별 예산
+	UPROPERTY(Config, EditAnywhere, Category="Budget")
+	TMap<FName, float> BudgetBitsPerSecond;
+};
+
+/*
+ 네트워크 비용 집계
+ Combat.Net.Accounting 1 일 때만 동작하며, 연결별로 RPC, 리플리케이트 프로퍼티마다 보낸 비트 수를 모은다.
+ - RPC : 전송 전후 연결의 송신 비트 수 차이, 실제로 버퍼에 쓰인 값이다(같은 패킷의 다른 데이터가 섞일 수 있다).
+ - 프로퍼티 : PreReplication 시점에 바뀐 프로퍼티의 직렬화 크기 추정치다. 리플리케이션 조건(OwnerOnly, SkipOwner, InitialOnly 등)에 맞는 연결에만 더하지만,
+   DOREPLIFETIME_ACTIVE_OVERRIDE, 델타 압축, 양자화는 반영하지 못한다.
+ Combat.Net.DumpAccounting [경로] 로 CSV를 저장하며, Source 열이 Measured(RPC)/Estimated(프로퍼티)를 나눈다.
+ 네트워크 프로파일러 형식으로는 내보내지 않는다. 실제 프로퍼티별 비트는 엔진의 netprofile 또는 Networking Insights로 확인한다.
+ */
+class DEFENDTHEDUNGEON_API FCombatNetAccounting
+{
+public:
+	static FCombatNetAccounting& Get();
+	static bool IsEnabled();
+
+	//프로퍼티 변경 감지용 이전 값
+	struct FShadowState
+	{
+		TArray<const FProperty*> Properties;
+		TArray<TArray<uint8>> Values;
+		//GetLifetimeReplicatedProps에 등록된 조건(ELifetimeCondition)
+		TArray<uint8> Conditions;
+		bool bInitialized = false;
+		bool bSentInitial = false;
+
+		FShadowState() = default;
+		~FShadowState();
+		UE_NONCOPYABLE(FShadowState);
+	};
+
+	/**
+	 * RPC 전송 전에 관련 연결들의 송신 비트 수를 기록합니다. 전송 후 EndRPC로 차이를 집계합니다.
+	 */
+	void BeginRPC(const UActorComponent* Component, const UFunction* Function);
+	void EndRPC(const UActorComponent* Component, const UFunction* Function);
+
+	//PreReplication에서 호출, 바뀐 프로퍼티를 집계하고 이전 값을 갱신합니다.
+	void RecordPropertyChanges(const UActorComponent* Component, FShadowState& Shadow);
+
+	int32 DumpCsv(const FString& Path) const;
+	void Reset();
+
+private:
+	struct FEntry
+	{
+		bool bRPC = false;
+		uint32 Count = 0;
+		uint64 TotalBits = 0;
+		uint64 WindowBits = 0;
+		uint64 PeakBitsPerSecond = 0;
+	};
+
+	struct FConnectionStats
+	{
+		FString Name;
+		TMap<FName, FEntry> Entries;
+		uint64 WindowTotalBits = 0;
+		double WindowStart = 0.0;
+	};
+
+	void Record(UNetConnection* Connection, FName Name, bool bRPC, uint64 Bits);
+	void CloseWindow(FConnectionStats& Stats, double Now);
+	void GatherConnections(const UActorComponent* Component, const UFunction* Function, TArray<UNetConnection*>& OutConnections) const;
+	static uint64 GetSentBits(const UNetConnection* Connection);
+
+	TMap<TWeakObjectPtr<UNetConnection>, FConnectionStats> Connections;
+
+	//BeginRPC ~ EndRPC 사이 연결별 송신 비트
+	TArray<TPair<TWeakObjectPtr<UNetConnection>, uint64>> PendingRPC;
+};
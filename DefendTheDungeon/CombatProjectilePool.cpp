@@ -0,0 +1,256 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatProjectilePool.h"
+
+#include "CombatStats.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace
+{
+	float PoolHeadroom = 1.5f;
+	FAutoConsoleVariableRef CVarPoolHeadroom(TEXT("Combat.Pool.Headroom"), PoolHeadroom, TEXT("예비 프로젝타일 목표 = 동시 사용 최고치 * 이 값"));
+
+	int32 PoolWarmPerTick = 2;
+	FAutoConsoleVariableRef CVarPoolWarmPerTick(TEXT("Combat.Pool.WarmPerTick"), PoolWarmPerTick, TEXT("풀마다 한 틱에 채우는 최대 프로젝타일 수"));
+
+	int32 PoolMaxReserve = 32;
+	FAutoConsoleVariableRef CVarPoolMaxReserve(TEXT("Combat.Pool.MaxReserve"), PoolMaxReserve, TEXT("풀마다 예비 프로젝타일 최대 수"));
+
+	const TCHAR* PoolConfigSection = TEXT("CombatProjectilePool");
+}
+
+bool UCombatProjectilePoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatProjectilePoolSubsystem::Deinitialize()
+{
+	//PIE, 클라이언트, 리슨 서버가 끝날 때마다 ini를 덮어쓰지 않도록 데디케이티드 서버에서만 저장한다.
+	if (IsRunningDedicatedServer())
+	{
+		SaveLearnedTargets();
+	}
+	if (Pools.Num() > 0)
+	{
+		LogStats();
+	}
+
+	Pools.Reset();
+	Super::Deinitialize();
+}
+
+void UCombatProjectilePoolSubsystem::SaveLearnedTargets()
+{
+	//이번 매치의 최고 사용 수로 다음 매치 시작 크기를 정한다. 이전 값과 평균을 내 한 매치의 튀는 값에 덜 흔들리게 한다.
+	TMap<FName, int32> Observed;
+	for (const TPair<FPoolKey, FPool>& Pair : Pools)
+	{
+		int32& Value = Observed.FindOrAdd(Pair.Value.TypeName);
+		Value = FMath::Max(Value, FMath::CeilToInt(Pair.Value.Stats.PeakInUse * PoolHeadroom));
+	}
+	for (const TPair<FName, int32>& Pair : Observed)
+	{
+		const int32* Previous = LearnedTargets.Find(Pair.Key);
+		const int32 Learned = Previous && *Previous > 0 ? FMath::DivideAndRoundUp(*Previous + Pair.Value, 2) : Pair.Value;
+		GConfig->SetInt(PoolConfigSection, *Pair.Key.ToString(), FMath::Clamp(Learned, 0, PoolMaxReserve), GGameIni);
+	}
+	if (Observed.Num() > 0)
+	{
+		GConfig->Flush(false, GGameIni);
+	}
+}
+
+TStatId UCombatProjectilePoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatProjectilePoolSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatProjectilePoolSubsystem::RegisterPool(const UObject* Shooter, uint8 Type, FName TypeName, FSpawner Spawner, int32 MinReserve)
+{
+	if (!Shooter || !Spawner) return;
+
+	const FPoolKey Key = MakeKey(Shooter, Type);
+	if (Pools.Contains(Key)) return;
+
+	if (!LearnedTargets.Contains(TypeName))
+	{
+		int32 Learned = 0;
+		GConfig->GetInt(PoolConfigSection, *TypeName.ToString(), Learned, GGameIni);
+		LearnedTargets.Add(TypeName, Learned);
+	}
+
+	FPool& Pool = Pools.Add(Key);
+	Pool.Shooter = Shooter;
+	Pool.TypeName = TypeName;
+	Pool.Spawner = MoveTemp(Spawner);
+	Pool.MinReserve = MinReserve;
+	Pool.Stats.Target = GetTarget(Pool);
+}
+
+int32 UCombatProjectilePoolSubsystem::GetTarget(const FPool& Pool) const
+{
+	const int32 Learned = LearnedTargets.FindRef(Pool.TypeName);
+	const int32 FromPeak = FMath::CeilToInt(Pool.Stats.PeakInUse * PoolHeadroom);
+	return FMath::Clamp(FMath::Max3(Pool.MinReserve, Learned, FromPeak), 0, PoolMaxReserve);
+}
+
+AActor* UCombatProjectilePoolSubsystem::Acquire(const UObject* Shooter, uint8 Type, const FVector& Location, const FRotator& Rotation)
+{
+	FPool* Pool = Pools.Find(MakeKey(Shooter, Type));
+	if (!Pool) return nullptr;
+
+	Pool->Stats.Requests++;
+
+	AActor* Actor = nullptr;
+	while (!Actor && Pool->Reserve.Num() > 0)
+	{
+		Actor = Pool->Reserve.Pop().Get();
+	}
+
+	if (Actor)
+	{
+		Pool->Stats.Hits++;
+		Unpark(Actor, Location, Rotation);
+	}
+	else
+	{
+		//예비가 비어 발사 순간에 스폰한다.
+		Pool->Stats.Misses++;
+		COMBAT_COUNT(PoolMisses, 1);
+		Actor = Spawn(*Pool, Location, Rotation);
+		if (!Actor) return nullptr;
+	}
+
+	Pool->InUse.Add(Actor);
+	Pool->Stats.InUse = Pool->InUse.Num();
+	Pool->Stats.PeakInUse = FMath::Max(Pool->Stats.PeakInUse, Pool->Stats.InUse);
+	Pool->Stats.Reserved = Pool->Reserve.Num();
+	Pool->Stats.Target = GetTarget(*Pool);
+	return Actor;
+}
+
+void UCombatProjectilePoolSubsystem::Release(const UObject* Shooter, uint8 Type, AActor* Actor)
+{
+	FPool* Pool = Pools.Find(MakeKey(Shooter, Type));
+	if (!Pool || Pool->InUse.RemoveSingleSwap(Actor) == 0) return;
+
+	if (IsValid(Actor))
+	{
+		Park(Actor);
+		Pool->Reserve.Add(Actor);
+	}
+	Pool->Stats.InUse = Pool->InUse.Num();
+	Pool->Stats.Reserved = Pool->Reserve.Num();
+}
+
+AActor* UCombatProjectilePoolSubsystem::Spawn(FPool& Pool, const FVector& Location, const FRotator& Rotation)
+{
+	AActor* Actor = Pool.Spawner(Location, Rotation);
+	if (Actor)
+	{
+		Pool.Stats.Spawns++;
+		COMBAT_COUNT(PoolSpawns, 1);
+	}
+	return Actor;
+}
+
+const FCombatPoolStats* UCombatProjectilePoolSubsystem::FindStats(const UObject* Shooter, uint8 Type) const
+{
+	const FPool* Pool = Pools.Find(MakeKey(Shooter, Type));
+	return Pool ? &Pool->Stats : nullptr;
+}
+
+void UCombatProjectilePoolSubsystem::Park(AActor* Actor) const
+{
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	if (UProjectileMovementComponent* Movement = Actor->FindComponentByClass<UProjectileMovementComponent>())
+	{
+		Movement->Deactivate();
+	}
+}
+
+void UCombatProjectilePoolSubsystem::Unpark(AActor* Actor, const FVector& Location, const FRotator& Rotation) const
+{
+	//이동 컴포넌트는 발사하는 쪽이 켠다.
+	Actor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(true);
+}
+
+void UCombatProjectilePoolSubsystem::Reconcile(FPool& Pool)
+{
+	//돌려받기 전에 사라진 액터만 정리한다. 사용 중인지는 Acquire, Release로만 정한다.
+	Pool.InUse.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor) { return !IsValid(Actor.Get()); });
+	Pool.Reserve.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor) { return !IsValid(Actor.Get()); });
+	Pool.Stats.InUse = Pool.InUse.Num();
+	Pool.Stats.Reserved = Pool.Reserve.Num();
+}
+
+void UCombatProjectilePoolSubsystem::Tick(float DeltaTime)
+{
+	for (auto It = Pools.CreateIterator(); It; ++It)
+	{
+		FPool& Pool = It.Value();
+		if (!Pool.Shooter.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		Reconcile(Pool);
+
+		//부족한 만큼 틱마다 조금씩 채워 스폰 비용을 여러 프레임에 나눈다.
+		Pool.Stats.Target = GetTarget(Pool);
+		for (int32 Warmed = 0; Warmed < PoolWarmPerTick && Pool.Reserve.Num() < Pool.Stats.Target; Warmed++)
+		{
+			AActor* Actor = Spawn(Pool, FVector::ZeroVector, FRotator::ZeroRotator);
+			if (!Actor) break;
+
+			Park(Actor);
+			Pool.Reserve.Add(Actor);
+		}
+		Pool.Stats.Reserved = Pool.Reserve.Num();
+	}
+}
+
+void UCombatProjectilePoolSubsystem::LogStats() const
+{
+	for (const TPair<FPoolKey, FPool>& Pair : Pools)
+	{
+		const FCombatPoolStats& Stats = Pair.Value.Stats;
+		MY_LOG(LogTemp, Log, TEXT("Combat.Pool %s (%s): requests %d, hits %d, misses %d, spawns %d, in use %d, peak %d, reserved %d / target %d"),
+			*Pair.Value.TypeName.ToString(), *GetNameSafe(Pair.Value.Shooter.Get()), Stats.Requests, Stats.Hits, Stats.Misses,
+			Stats.Spawns, Stats.InUse, Stats.PeakInUse, Stats.Reserved, Stats.Target);
+	}
+}
+
+static FAutoConsoleCommandWithWorld PoolStatsCommand(
+	TEXT("Combat.Pool.Stats"),
+	TEXT("프로젝타일 예비 풀 통계를 출력합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UCombatProjectilePoolSubsystem* Pool = World ? World->GetSubsystem<UCombatProjectilePoolSubsystem>() : nullptr)
+		{
+			Pool->LogStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld SavePoolCommand(
+	TEXT("Combat.Pool.SaveLearned"),
+	TEXT("이번 매치의 최고 사용 수로 학습한 프로젝타일 예비 수를 게임 ini에 저장합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCombatProjectilePoolSubsystem* Pool = World ? World->GetSubsystem<UCombatProjectilePoolSubsystem>() : nullptr)
+		{
+			Pool->SaveLearnedTargets();
+		}
+	}));
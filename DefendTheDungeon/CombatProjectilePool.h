@@ -0,0 +1,96 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatProjectilePool.generated.h"
+
+/*
+ 프로젝타일 예비 풀
+ 꺼둔 프로젝타일을 미리 스폰해 두었다가 발사 순간에 내준다.
+	- 장착한 무기 구성에 맞는 풀을 등록하고 틱마다 조금씩 채운다. 스폰 비용이 발사 순간이 아닌 여유 프레임에 든다.
+	- 목표 예비 수 = 동시 사용 최고치 * Combat.Pool.Headroom, 종류별로 기억해 다음 매치 시작 크기로 쓴다.
+	- 통계 : 요청, 예비에서 꺼냄(Hit), 예비가 비어 발사 순간 스폰(Miss), 전체 스폰 수, 사용 중, 최고 사용 수
+ 예비 액터는 이 풀이 직접 스폰해 소유한다. UProjectileShooterComponent 풀과 섞이지 않으므로 같은 액터가 두 번 나가지 않는다.
+ 꺼낸 액터는 Release로 돌려받아 다시 예비에 넣는다. 돌려받기 전에 사라진 액터만 틱에서 정리한다.
+ 학습한 크기는 데디케이티드 서버가 끝날 때, 또는 Combat.Pool.SaveLearned 로만 게임 ini에 저장한다.
+ Combat.Pool.Stats 로 확인한다.
+ */
+
+struct FCombatPoolStats
+{
+	int32 Requests = 0;
+	int32 Hits = 0;
+	int32 Misses = 0;
+	int32 Spawns = 0;
+	int32 InUse = 0;
+	int32 PeakInUse = 0;
+	int32 Reserved = 0;
+	int32 Target = 0;
+};
+
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatProjectilePoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//Location, Rotation에 프로젝타일 하나를 새로 스폰한다. 다른 풀에 속하지 않은 액터여야 한다.
+	using FSpawner = TFunction<AActor*(const FVector& Location, const FRotator& Rotation)>;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * 풀을 등록합니다. 이미 있으면 아무것도 하지 않습니다. 등록 후 틱마다 목표 수까지 채웁니다.
+	 * @param Shooter 풀의 주인(UProjectileShooterComponent)
+	 * @param Type 프로젝타일 종류(EDDCharacterPoolingProjectileType)
+	 * @param TypeName 통계, 학습한 크기를 저장할 이름
+	 * @param Spawner 프로젝타일을 새로 스폰하는 함수
+	 * @param MinReserve 최소 예비 수
+	 */
+	void RegisterPool(const UObject* Shooter, uint8 Type, FName TypeName, FSpawner Spawner, int32 MinReserve = 1);
+	bool IsRegistered(const UObject* Shooter, uint8 Type) const { return Pools.Contains(MakeKey(Shooter, Type)); }
+
+	//예비에서 꺼내거나, 비었으면 바로 스폰한다. 등록하지 않은 풀이면 nullptr
+	AActor* Acquire(const UObject* Shooter, uint8 Type, const FVector& Location, const FRotator& Rotation);
+
+	//Acquire로 꺼낸 액터를 돌려받아 꺼두고 예비에 넣는다. 이 풀의 액터가 아니면 아무것도 하지 않는다.
+	void Release(const UObject* Shooter, uint8 Type, AActor* Actor);
+
+	//학습한 예비 수를 게임 ini에 쓴다.
+	void SaveLearnedTargets();
+
+	const FCombatPoolStats* FindStats(const UObject* Shooter, uint8 Type) const;
+	void LogStats() const;
+
+private:
+	using FPoolKey = TPair<FObjectKey, uint8>;
+	static FPoolKey MakeKey(const UObject* Shooter, uint8 Type) { return FPoolKey(FObjectKey(Shooter), Type); }
+
+	struct FPool
+	{
+		TWeakObjectPtr<const UObject> Shooter;
+		FName TypeName;
+		FSpawner Spawner;
+		int32 MinReserve = 1;
+		TArray<TWeakObjectPtr<AActor>> Reserve;
+		TArray<TWeakObjectPtr<AActor>> InUse;
+		FCombatPoolStats Stats;
+	};
+
+	int32 GetTarget(const FPool& Pool) const;
+	AActor* Spawn(FPool& Pool, const FVector& Location, const FRotator& Rotation);
+	void Park(AActor* Actor) const;
+	void Unpark(AActor* Actor, const FVector& Location, const FRotator& Rotation) const;
+	void Reconcile(FPool& Pool);
+
+	TMap<FPoolKey, FPool> Pools;
+
+	//종류별 학습한 예비 수
+	TMap<FName, int32> LearnedTargets;
+};
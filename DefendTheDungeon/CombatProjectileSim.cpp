@@ -0,0 +1,281 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatProjectileSim.h"
+
+#include "Async/ParallelFor.h"
+#include "CombatStats.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	bool bBatchedProjectiles = false;
+	FAutoConsoleVariableRef CVarBatchedProjectiles(TEXT("Combat.Projectile.Batched"), bBatchedProjectiles, TEXT("프로젝타일을 액터 대신 배치 시뮬레이션으로 움직입니다. 새로 쏘는 프로젝타일부터 적용됩니다."));
+}
+
+bool UCombatProjectileSimSubsystem::IsEnabled()
+{
+	return bBatchedProjectiles;
+}
+
+bool UCombatProjectileSimSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatProjectileSimSubsystem::Deinitialize()
+{
+	while (Num() > 0)
+	{
+		RemoveAt(Num() - 1);
+	}
+	Super::Deinitialize();
+}
+
+TStatId UCombatProjectileSimSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatProjectileSimSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatProjectileSimSubsystem::Tick(float DeltaTime)
+{
+	if (Num() > 0)
+	{
+		Simulate(DeltaTime);
+	}
+}
+
+FCombatProjectileHandle UCombatProjectileSimSubsystem::Launch(const FCombatProjectileSpawn& Spawn)
+{
+	//0은 무효 핸들
+	if (++NextId == 0) ++NextId;
+
+	PosX.Add(Spawn.Location.X);
+	PosY.Add(Spawn.Location.Y);
+	PosZ.Add(Spawn.Location.Z);
+	VelX.Add(Spawn.Velocity.X);
+	VelY.Add(Spawn.Velocity.Y);
+	VelZ.Add(Spawn.Velocity.Z);
+	GravityZ.Add(Spawn.GravityZ);
+	Radius.Add(Spawn.Radius);
+	TimeLeft.Add(Spawn.LifeTime);
+
+	FProjectileInfo& Info = Infos.AddDefaulted_GetRef();
+	Info.Id = NextId;
+	Info.Channel = Spawn.Channel;
+	Info.Responses = Spawn.Responses;
+	Info.Instigator = Spawn.Instigator;
+	Info.Proxy = Spawn.Proxy;
+	Info.bHasProxy = Spawn.Proxy.IsValid();
+	Info.OnFinished = Spawn.OnFinished;
+
+	IdToIndex.Add(NextId, Infos.Num() - 1);
+
+	FCombatProjectileHandle Handle;
+	Handle.Id = NextId;
+	return Handle;
+}
+
+void UCombatProjectileSimSubsystem::Remove(FCombatProjectileHandle& Handle)
+{
+	if (const int32* Index = IdToIndex.Find(Handle.Id))
+	{
+		RemoveAt(*Index);
+	}
+	Handle.Invalidate();
+}
+
+void UCombatProjectileSimSubsystem::RemoveAt(int32 Index)
+{
+	IdToIndex.Remove(Infos[Index].Id);
+
+	//마지막 요소를 빈 자리로 옮긴다. 모든 열을 같은 방식으로 옮겨 인덱스를 맞춘다.
+	for (TArray<float>* Column : { &PosX, &PosY, &PosZ, &VelX, &VelY, &VelZ, &GravityZ, &Radius, &TimeLeft })
+	{
+		Column->RemoveAtSwap(Index);
+	}
+	Infos.RemoveAtSwap(Index);
+
+	if (Infos.IsValidIndex(Index))
+	{
+		IdToIndex.Add(Infos[Index].Id, Index);
+	}
+}
+
+void UCombatProjectileSimSubsystem::Simulate(float DeltaTime)
+{
+	COMBAT_SCOPE_CYCLE(ProjectileSim);
+	const int32 Count = Num();
+	COMBAT_COUNT(ProjectilesSimulated, Count);
+	if (Count == 0) return;
+
+	//1. 적분
+	uint64 Start = FPlatformTime::Cycles64();
+	PrevX = PosX;
+	PrevY = PosY;
+	PrevZ = PosZ;
+	{
+		const float Dt = DeltaTime;
+		const float HalfDtSq = 0.5f * DeltaTime * DeltaTime;
+		float* RESTRICT X = PosX.GetData();
+		float* RESTRICT Y = PosY.GetData();
+		float* RESTRICT Z = PosZ.GetData();
+		float* RESTRICT VZ = VelZ.GetData();
+		float* RESTRICT Life = TimeLeft.GetData();
+		const float* RESTRICT VX = VelX.GetData();
+		const float* RESTRICT VY = VelY.GetData();
+		const float* RESTRICT G = GravityZ.GetData();
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			X[Index] += VX[Index] * Dt;
+			Y[Index] += VY[Index] * Dt;
+			Z[Index] += VZ[Index] * Dt + G[Index] * HalfDtSq;
+			VZ[Index] += G[Index] * Dt;
+			Life[Index] -= Dt;
+		}
+	}
+	LastIntegrateMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Start);
+
+	//2. 스윕, 약한 포인터는 게임 스레드에서 미리 푼다.
+	Start = FPlatformTime::Cycles64();
+	IgnoredActors.SetNumUninitialized(Count);
+	IgnoredProxies.SetNumUninitialized(Count);
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		IgnoredActors[Index] = Infos[Index].Instigator.Get();
+		IgnoredProxies[Index] = Infos[Index].Proxy.Get();
+	}
+	SweepHits.SetNum(Count);
+	SweepBlocked.SetNumZeroed(Count);
+
+	const UWorld* World = GetWorld();
+	const int32 NumBatches = FMath::DivideAndRoundUp(Count, SweepBatchSize);
+	ParallelFor(NumBatches, [this, World, Count](int32 Batch)
+	{
+		const int32 End = FMath::Min(Count, (Batch + 1) * SweepBatchSize);
+		for (int32 Index = Batch * SweepBatchSize; Index < End; Index++)
+		{
+			const FVector From(PrevX[Index], PrevY[Index], PrevZ[Index]);
+			const FVector To(PosX[Index], PosY[Index], PosZ[Index]);
+			const FProjectileInfo& Info = Infos[Index];
+
+			FCollisionQueryParams Params(SCENE_QUERY_STAT(CombatProjectileSim), false, IgnoredActors[Index]);
+			Params.AddIgnoredActor(IgnoredProxies[Index]);
+			SweepBlocked[Index] = World->SweepSingleByChannel(SweepHits[Index], From, To, FQuat::Identity, Info.Channel,
+				FCollisionShape::MakeSphere(Radius[Index]), Params, FCollisionResponseParams(Info.Responses));
+		}
+	}, Count < ParallelSweepThreshold);
+	COMBAT_COUNT(Queries, Count);
+	LastSweepMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Start);
+
+	//3. 정리, 콜백이 Launch, Remove를 불러도 되도록 끝난 것을 먼저 빼고 나중에 호출한다.
+	TArray<TPair<TFunction<void(const FHitResult&)>, FHitResult>, TInlineAllocator<16>> Finished;
+	for (int32 Index = Count - 1; Index >= 0; Index--)
+	{
+		FProjectileInfo& Info = Infos[Index];
+		AActor* Proxy = Info.Proxy.Get();
+		if (Info.bHasProxy && !Proxy)
+		{
+			RemoveAt(Index);
+			continue;
+		}
+
+		if (SweepBlocked[Index])
+		{
+			const FVector HitLocation = SweepHits[Index].Location;
+			if (Proxy)
+			{
+				Proxy->SetActorLocation(HitLocation);
+			}
+			Finished.Emplace(MoveTemp(Info.OnFinished), SweepHits[Index]);
+			RemoveAt(Index);
+		}
+		else if (TimeLeft[Index] <= 0.f)
+		{
+			Finished.Emplace(MoveTemp(Info.OnFinished), FHitResult());
+			RemoveAt(Index);
+		}
+		else if (Proxy)
+		{
+			const FVector Velocity(VelX[Index], VelY[Index], VelZ[Index]);
+			Proxy->SetActorLocationAndRotation(FVector(PosX[Index], PosY[Index], PosZ[Index]), Velocity.Rotation());
+		}
+	}
+
+	for (TPair<TFunction<void(const FHitResult&)>, FHitResult>& Entry : Finished)
+	{
+		if (Entry.Key)
+		{
+			Entry.Key(Entry.Value);
+		}
+	}
+}
+
+/**
+ * 후반 웨이브처럼 프로젝타일 수천 개가 동시에 날아가는 상황의 배치 시뮬레이션 비용을 잽니다.
+ * 첫 플레이어 주변에 프록시 없는 프로젝타일을 뿌리고 전투 시계 주기로 Frames번 진행합니다.
+ * 사용법 : Combat.Projectile.Benchmark [Count=5000] [Frames=300]
+ */
+static FAutoConsoleCommandWithWorldAndArgs ProjectileBenchmarkCommand(
+	TEXT("Combat.Projectile.Benchmark"),
+	TEXT("배치 프로젝타일 시뮬레이션 비용을 측정합니다. [Count] [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCombatProjectileSimSubsystem* Sim = World ? World->GetSubsystem<UCombatProjectileSimSubsystem>() : nullptr;
+		if (!Sim) LOG_RETURN(Warning, TEXT("Combat.Projectile.Benchmark: no projectile simulation in this world"));
+
+		const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 5000;
+		const int32 NumFrames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 300;
+		constexpr float FrameSeconds = 1.f / 30.f;
+
+		FVector Center = FVector::ZeroVector;
+		if (const APlayerController* PlayerController = World->GetFirstPlayerController())
+		{
+			if (const APawn* Pawn = PlayerController->GetPawn())
+			{
+				Center = Pawn->GetActorLocation();
+			}
+		}
+
+		FRandomStream Random(48);
+		int32 NumHits = 0;
+		TArray<FCombatProjectileHandle> Handles;
+		Handles.Reserve(Count);
+
+		double IntegrateMs = 0.0;
+		double SweepMs = 0.0;
+		int32 Launched = 0;
+		const uint64 Start = FPlatformTime::Cycles64();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			//수명이 다한 만큼 다시 채워 항상 Count개 정도가 날고 있게 한다.
+			while (Sim->Num() < Count)
+			{
+				FCombatProjectileSpawn Spawn;
+				Spawn.Location = Center + FVector(Random.FRandRange(-3000.f, 3000.f), Random.FRandRange(-3000.f, 3000.f), Random.FRandRange(100.f, 400.f));
+				Spawn.Velocity = Random.GetUnitVector() * Random.FRandRange(800.f, 2000.f);
+				Spawn.GravityZ = Random.RandRange(0, 1) ? World->GetGravityZ() : 0.f;
+				Spawn.Radius = 10.f;
+				Spawn.LifeTime = Random.FRandRange(1.f, 3.f);
+				Spawn.OnFinished = [&NumHits](const FHitResult& Hit) { NumHits += Hit.bBlockingHit; };
+				Handles.Add(Sim->Launch(Spawn));
+				Launched++;
+			}
+			Sim->Simulate(FrameSeconds);
+			IntegrateMs += Sim->GetLastIntegrateMs();
+			SweepMs += Sim->GetLastSweepMs();
+		}
+		const double TotalMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Start);
+
+		for (FCombatProjectileHandle& Handle : Handles)
+		{
+			Sim->Remove(Handle);
+		}
+
+		MY_LOG(LogTemp, Log, TEXT("Combat.Projectile.Benchmark: %d projectiles x %d frames (%d launched, %d hits), integrate %.3f ms/frame, sweep %.3f ms/frame, total %.3f ms/frame"),
+			Count, NumFrames, Launched, NumHits, IntegrateMs / NumFrames, SweepMs / NumFrames, TotalMs / NumFrames);
+	}));
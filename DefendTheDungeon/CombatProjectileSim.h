@@ -0,0 +1,120 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatProjectileSim.generated.h"
+
+/*
+ 배치 프로젝타일 시뮬레이션
+ 프로젝타일마다 액터 틱과 이동 컴포넌트를 돌리는 대신, 위치, 속도, 중력, 반지름, 남은 수명을 성분별 배열(SoA)에 모아
+ 한 번에 적분하고 이동 구간을 묶어서 스윕한다.
+	1. 적분 : 연속된 float 열을 한 방향으로 훑는 분기 없는 루프, 컴파일러가 SIMD로 묶는다.
+	2. 스윕 : 이전 위치 -> 새 위치 구간을 ParallelFor로 나눠 검사한다. 장면 질의는 읽기 전용이라 워커 스레드에서 해도 된다.
+	3. 정리 : 게임 스레드에서 충돌, 수명 종료를 처리하고 보이는 액터(프록시)만 위치를 옮긴다.
+ 액터는 보이는 용도의 선택 사항이다. 프록시가 없으면 순수 데이터로만 움직인다.
+ Combat.Projectile.Batched 1 일 때 중력포 등이 이 경로를 쓴다. 비용 측정은 Combat.Projectile.Benchmark.
+ */
+
+struct FCombatProjectileHandle
+{
+	uint32 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Invalidate() { Id = 0; }
+};
+
+struct FCombatProjectileSpawn
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	//중력 가속도 Z, 0이면 직선
+	float GravityZ = 0.f;
+	float Radius = 10.f;
+	//수명(초), 끝나면 OnFinished를 충돌 없이 호출한다.
+	float LifeTime = 5.f;
+	ECollisionChannel Channel = ECC_WorldDynamic;
+	FCollisionResponseContainer Responses = FCollisionResponseContainer(ECR_Block);
+	//스윕에서 무시할 발사자
+	TWeakObjectPtr<AActor> Instigator;
+	//위치를 따라가는 보이는 액터, 사라지면 프로젝타일도 조용히 지운다.
+	TWeakObjectPtr<AActor> Proxy;
+	//충돌하거나 수명이 끝나면 게임 스레드에서 호출, 수명 종료면 Hit.bBlockingHit == false
+	TFunction<void(const FHitResult& Hit)> OnFinished;
+};
+
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatProjectileSimSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static bool IsEnabled();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	FCombatProjectileHandle Launch(const FCombatProjectileSpawn& Spawn);
+
+	//OnFinished 없이 지운다. 함수 안에서 Handle을 무효화한다.
+	void Remove(FCombatProjectileHandle& Handle);
+	bool IsActive(const FCombatProjectileHandle& Handle) const { return Handle.IsValid() && IdToIndex.Contains(Handle.Id); }
+
+	int32 Num() const { return PosX.Num(); }
+
+	//한 단계 진행한다. Tick에서 부르며, 벤치마크는 직접 부른다.
+	void Simulate(float DeltaTime);
+
+	//마지막 단계의 단계별 시간(ms)
+	double GetLastIntegrateMs() const { return LastIntegrateMs; }
+	double GetLastSweepMs() const { return LastSweepMs; }
+
+	//이 수보다 적으면 스윕을 나누지 않는다.
+	static constexpr int32 ParallelSweepThreshold = 64;
+	static constexpr int32 SweepBatchSize = 32;
+
+private:
+	//자주 안 읽는 값
+	struct FProjectileInfo
+	{
+		uint32 Id = 0;
+		ECollisionChannel Channel = ECC_WorldDynamic;
+		FCollisionResponseContainer Responses;
+		TWeakObjectPtr<AActor> Instigator;
+		TWeakObjectPtr<AActor> Proxy;
+		bool bHasProxy = false;
+		TFunction<void(const FHitResult&)> OnFinished;
+	};
+
+	void RemoveAt(int32 Index);
+
+	//적분에 쓰는 값, 모든 열은 같은 길이
+	TArray<float> PosX;
+	TArray<float> PosY;
+	TArray<float> PosZ;
+	TArray<float> VelX;
+	TArray<float> VelY;
+	TArray<float> VelZ;
+	TArray<float> GravityZ;
+	TArray<float> Radius;
+	TArray<float> TimeLeft;
+	TArray<FProjectileInfo> Infos;
+
+	TMap<uint32, int32> IdToIndex;
+	uint32 NextId = 0;
+
+	//단계마다 다시 쓰는 임시 버퍼
+	TArray<float> PrevX;
+	TArray<float> PrevY;
+	TArray<float> PrevZ;
+	TArray<const AActor*> IgnoredActors;
+	TArray<const AActor*> IgnoredProxies;
+	TArray<FHitResult> SweepHits;
+	TArray<uint8> SweepBlocked;
+
+	double LastIntegrateMs = 0.0;
+	double LastSweepMs = 0.0;
+};
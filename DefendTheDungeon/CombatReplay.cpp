@@ -0,0 +1,530 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatReplay.h"
+
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "CombatClock.h"
+#include "CombatComponent.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+namespace
+{
+	constexpr uint32 ReplayMagic = 0x52434444; //'DDCR'
+	constexpr uint32 ReplayVersion = 1;
+
+	FString ToFullPath(const FString& Path)
+	{
+		return FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectSavedDir(), Path) : Path;
+	}
+}
+
+bool UCombatReplaySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Collection.InitializeDependency<UCombatClock>();
+
+	FString Path;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-CombatReplay="), Path))
+	{
+		bExitAfterReplay = FParse::Param(FCommandLine::Get(), TEXT("CombatReplayExit"));
+		StartReplay(Path);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("-CombatRecord="), Path))
+	{
+		StartRecording();
+	}
+}
+
+void UCombatReplaySubsystem::Deinitialize()
+{
+	//커맨드 라인으로 시작한 녹화는 월드가 끝날 때 저장한다.
+	FString Path;
+	if (bRecording && FParse::Value(FCommandLine::Get(), TEXT("-CombatRecord="), Path))
+	{
+		StopRecording(Path);
+	}
+	Super::Deinitialize();
+}
+
+TStatId UCombatReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatReplaySubsystem, STATGROUP_Tickables);
+}
+
+int64 UCombatReplaySubsystem::GetClockTick() const
+{
+	const UCombatClock* Clock = GetWorld()->GetSubsystem<UCombatClock>();
+	return Clock ? Clock->GetTick() : 0;
+}
+
+int32 UCombatReplaySubsystem::RegisterComponent(UCombatComponent* Component)
+{
+	return Components.Add(Component);
+}
+
+/*******************************************************************/
+/* 녹화 */
+
+void UCombatReplaySubsystem::StartRecording()
+{
+	if (bReplaying) LOG_RETURN(Warning, TEXT("Cannot record while replaying"));
+
+	bRecording = true;
+	RecordStartTick = GetClockTick();
+	LastRecordTick = 0;
+	RecordBuffer.Reset();
+	RecordNames.Reset();
+	MY_LOG(LogTemp, Log, TEXT("Combat replay recording started at tick %lld"), RecordStartTick);
+}
+
+bool UCombatReplaySubsystem::StopRecording(const FString& Path)
+{
+	if (!bRecording) return false;
+	bRecording = false;
+
+	/*
+	 파일 형식
+		uint32 Magic, uint32 Version, int32 TickRate, int32 슬롯 수
+		기록 : uint8 종류, packed 틱 차이, packed 슬롯, 종류별 값 (ECombatReplayRecord 참고)
+		Input의 함수 이름은 처음 나올 때만 문자열로 쓰고 이후에는 번호로 쓴다.
+	 */
+	TArray<uint8> File;
+	FMemoryWriter Writer(File);
+	uint32 Magic = ReplayMagic;
+	uint32 Version = ReplayVersion;
+	const UCombatClock* Clock = GetWorld()->GetSubsystem<UCombatClock>();
+	int32 TickRate = Clock ? Clock->GetTickRate() : 0;
+	int32 NumSlots = Components.Num();
+	Writer << Magic << Version << TickRate << NumSlots;
+	File.Append(RecordBuffer);
+
+	const FString FullPath = ToFullPath(Path);
+	if (!FFileHelper::SaveArrayToFile(File, *FullPath))
+	{
+		MY_LOG(LogTemp, Error, TEXT("Failed to write combat replay %s"), *FullPath);
+		return false;
+	}
+	MY_LOG(LogTemp, Log, TEXT("Combat replay, %d bytes, %lld ticks written to %s"), File.Num(), LastRecordTick, *FullPath);
+	RecordBuffer.Empty();
+	return true;
+}
+
+void UCombatReplaySubsystem::WriteHeader(ECombatReplayRecord Type, int32 Slot)
+{
+	const int64 Tick = GetClockTick() - RecordStartTick;
+	uint32 TickDelta = static_cast<uint32>(Tick - LastRecordTick);
+	LastRecordTick = Tick;
+
+	FMemoryWriter Writer(RecordBuffer, false, true);
+	uint8 TypeByte = static_cast<uint8>(Type);
+	uint32 PackedSlot = static_cast<uint32>(Slot);
+	Writer << TypeByte;
+	Writer.SerializeIntPacked(TickDelta);
+	Writer.SerializeIntPacked(PackedSlot);
+}
+
+void UCombatReplaySubsystem::RecordInput(int32 Slot, const UFunction* Function, void* Parms)
+{
+	if (!bRecording || Slot == INDEX_NONE) return;
+
+	WriteHeader(ECombatReplayRecord::Input, Slot);
+	FMemoryWriter Writer(RecordBuffer, false, true);
+
+	//처음 보는 함수면 이름을 함께 쓴다.
+	const FName FunctionName = Function->GetFName();
+	uint32 NameIndex;
+	if (const int32* Found = RecordNames.Find(FunctionName))
+	{
+		NameIndex = *Found;
+		Writer.SerializeIntPacked(NameIndex);
+	}
+	else
+	{
+		NameIndex = RecordNames.Num();
+		RecordNames.Add(FunctionName, NameIndex);
+		FString NameString = FunctionName.ToString();
+		Writer.SerializeIntPacked(NameIndex);
+		Writer << NameString;
+	}
+
+	//액터 참조는 경로 문자열로 남긴다.
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+	FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadWriter, false);
+	const_cast<UFunction*>(Function)->SerializeBin(PayloadArchive, Parms);
+
+	uint32 PayloadSize = Payload.Num();
+	Writer.SerializeIntPacked(PayloadSize);
+	Writer.Serialize(Payload.GetData(), Payload.Num());
+}
+
+void UCombatReplaySubsystem::RecordRandom(int32 Slot, int32 Value)
+{
+	if (!bRecording || Slot == INDEX_NONE) return;
+
+	WriteHeader(ECombatReplayRecord::Random, Slot);
+	FMemoryWriter Writer(RecordBuffer, false, true);
+	Writer << Value;
+}
+
+void UCombatReplaySubsystem::RecordDamage(int32 Slot, float Damage, uint8 AttackType)
+{
+	if (!bRecording || Slot == INDEX_NONE) return;
+
+	WriteHeader(ECombatReplayRecord::Damage, Slot);
+	FMemoryWriter Writer(RecordBuffer, false, true);
+	Writer << Damage << AttackType;
+}
+
+void UCombatReplaySubsystem::RecordCrowdControl(int32 Slot, CombatCore::ECrowdControl Type, float Duration)
+{
+	if (!bRecording || Slot == INDEX_NONE) return;
+
+	WriteHeader(ECombatReplayRecord::CrowdControl, Slot);
+	FMemoryWriter Writer(RecordBuffer, false, true);
+	uint8 TypeByte = static_cast<uint8>(Type);
+	Writer << TypeByte << Duration;
+}
+
+/*******************************************************************/
+/* 재생 */
+
+bool UCombatReplaySubsystem::StartReplay(const FString& Path)
+{
+	if (bRecording) bRecording = false;
+
+	TArray<uint8> File;
+	const FString FullPath = ToFullPath(Path);
+	if (!FFileHelper::LoadFileToArray(File, *FullPath))
+	{
+		MY_LOG(LogTemp, Error, TEXT("Failed to read combat replay %s"), *FullPath);
+		return false;
+	}
+
+	FMemoryReader Reader(File);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 TickRate = 0;
+	Reader << Magic << Version << TickRate << ReplaySlots;
+	if (Magic != ReplayMagic || Version != ReplayVersion)
+	{
+		MY_LOG(LogTemp, Error, TEXT("Not a combat replay file %s"), *FullPath);
+		return false;
+	}
+
+	const UCombatClock* Clock = GetWorld()->GetSubsystem<UCombatClock>();
+	if (Clock && Clock->GetTickRate() != TickRate)
+	{
+		MY_LOG(LogTemp, Warning, TEXT("Combat replay recorded at %d Hz, clock runs at %d Hz. Set Combat.Clock.Hz to match."), TickRate, Clock->GetTickRate());
+	}
+
+	//-benchmark의 기본 고정 프레임 시간(1/30초)은 시계가 30 Hz일 때만 한 틱이다. 시계 주기로 맞춘다.
+	if (Clock && FApp::IsBenchmarking() && !bOverrodeFixedDeltaTime)
+	{
+		SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+		bOverrodeFixedDeltaTime = true;
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(Clock->GetTickSeconds());
+	}
+
+	Records.Reset();
+	TArray<FName> Names;
+	int64 Tick = 0;
+	while (!Reader.AtEnd() && !Reader.IsError())
+	{
+		FReplayRecord& Record = Records.AddDefaulted_GetRef();
+		uint8 TypeByte;
+		uint32 TickDelta;
+		uint32 Slot;
+		Reader << TypeByte;
+		Reader.SerializeIntPacked(TickDelta);
+		Reader.SerializeIntPacked(Slot);
+		Tick += TickDelta;
+		Record.Tick = Tick;
+		Record.Slot = static_cast<int32>(Slot);
+		Record.Type = static_cast<ECombatReplayRecord>(TypeByte);
+
+		switch (Record.Type)
+		{
+		case ECombatReplayRecord::Input:
+		{
+			uint32 NameIndex;
+			Reader.SerializeIntPacked(NameIndex);
+			if (NameIndex == static_cast<uint32>(Names.Num()))
+			{
+				FString NameString;
+				Reader << NameString;
+				Names.Add(FName(*NameString));
+			}
+			Record.FunctionName = Names.IsValidIndex(NameIndex) ? Names[NameIndex] : NAME_None;
+
+			uint32 PayloadSize;
+			Reader.SerializeIntPacked(PayloadSize);
+			Record.Payload.SetNumUninitialized(PayloadSize);
+			Reader.Serialize(Record.Payload.GetData(), PayloadSize);
+			break;
+		}
+		case ECombatReplayRecord::Random:
+			Reader << Record.IntValue;
+			break;
+		case ECombatReplayRecord::Damage:
+		{
+			uint8 AttackType;
+			Reader << Record.FloatValue << AttackType;
+			Record.IntValue = AttackType;
+			break;
+		}
+		case ECombatReplayRecord::CrowdControl:
+		{
+			uint8 Type;
+			Reader << Type << Record.FloatValue;
+			Record.IntValue = Type;
+			break;
+		}
+		default:
+			Reader.SetError();
+			break;
+		}
+	}
+	if (Reader.IsError())
+	{
+		MY_LOG(LogTemp, Error, TEXT("Combat replay %s is corrupted"), *FullPath);
+		Records.Reset();
+		return false;
+	}
+
+	bReplaying = true;
+	bReplayStarted = false;
+	NextRecord = 0;
+	NumDesyncs = 0;
+	PendingRandoms.Reset();
+	PendingRandoms.SetNum(ReplaySlots);
+	MY_LOG(LogTemp, Log, TEXT("Combat replay loaded, %d records, %lld ticks, waiting for %d characters"), Records.Num(), Tick, ReplaySlots);
+	return true;
+}
+
+bool UCombatReplaySubsystem::ConsumeRandom(int32 Slot, int32& OutValue)
+{
+	if (!bReplaying || !PendingRandoms.IsValidIndex(Slot)) return false;
+
+	if (PendingRandoms[Slot].Num() == 0)
+	{
+		//녹화와 다른 순서로 난수를 뽑았다.
+		NumDesyncs++;
+		return false;
+	}
+	OutValue = PendingRandoms[Slot][0];
+	PendingRandoms[Slot].RemoveAt(0, 1, EAllowShrinking::No);
+	return true;
+}
+
+void UCombatReplaySubsystem::Tick(float DeltaTime)
+{
+	if (!bReplaying) return;
+
+	//캐릭터를 기다리는 동안에도 몬스터가 움직이면 녹화와 달라진다.
+	StopLiveAI();
+
+	if (!bReplayStarted)
+	{
+		//녹화한 수만큼 캐릭터가 준비될 때까지 기다린다.
+		if (Components.Num() < ReplaySlots) return;
+
+		bReplayStarted = true;
+		ReplayStartTick = GetClockTick();
+		//기록에 없는 난수(연출 등)도 매번 같게 뽑히도록 전역 시드를 고정한다.
+		FMath::RandInit(0);
+		FMath::SRandInit(0);
+		ReplayStartSeconds = FPlatformTime::Seconds();
+#if CSV_PROFILER
+		if (FCsvProfiler* Profiler = FCsvProfiler::Get())
+		{
+			Profiler->BeginCapture();
+		}
+#endif
+		MY_LOG(LogTemp, Log, TEXT("Combat replay started"));
+	}
+
+	const int64 ElapsedTicks = GetClockTick() - ReplayStartTick;
+
+	//같은 틱의 난수는 입력보다 먼저 준비해야 하므로, 이번 틱까지의 난수를 먼저 모은다.
+	for (int32 Index = NextRecord; Index < Records.Num() && Records[Index].Tick <= ElapsedTicks; Index++)
+	{
+		if (Records[Index].Type == ECombatReplayRecord::Random && PendingRandoms.IsValidIndex(Records[Index].Slot))
+		{
+			PendingRandoms[Records[Index].Slot].Add(Records[Index].IntValue);
+		}
+	}
+	while (NextRecord < Records.Num() && Records[NextRecord].Tick <= ElapsedTicks)
+	{
+		Dispatch(Records[NextRecord]);
+		NextRecord++;
+	}
+
+	if (NextRecord >= Records.Num())
+	{
+		FinishReplay();
+	}
+}
+
+void UCombatReplaySubsystem::Dispatch(const FReplayRecord& Record)
+{
+	UCombatComponent* Component = Components.IsValidIndex(Record.Slot) ? Components[Record.Slot].Get() : nullptr;
+	if (!Component)
+	{
+		NumDesyncs++;
+		return;
+	}
+
+	switch (Record.Type)
+	{
+	case ECombatReplayRecord::Input:
+	{
+		UFunction* Function = Component->FindFunction(Record.FunctionName);
+		if (!Function)
+		{
+			NumDesyncs++;
+			return;
+		}
+
+		uint8* Parms = static_cast<uint8*>(FMemory_Alloca_Aligned(Function->ParmsSize, Function->GetMinAlignment()));
+		FMemory::Memzero(Parms, Function->ParmsSize);
+		Function->InitializeStruct(Parms);
+
+		FMemoryReader PayloadReader(Record.Payload);
+		FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadReader, false);
+		Function->SerializeBin(PayloadArchive, Parms);
+
+		//서버 권한이므로 RPC를 보내지 않고 바로 _Implementation이 실행된다.
+		Component->ProcessEvent(Function, Parms);
+		Function->DestroyStruct(Parms);
+		break;
+	}
+	case ECombatReplayRecord::Damage:
+		Component->ApplyReplayedDamage(Record.FloatValue, static_cast<EAttackType>(Record.IntValue));
+		break;
+	case ECombatReplayRecord::CrowdControl:
+		switch (static_cast<CombatCore::ECrowdControl>(Record.IntValue))
+		{
+		case CombatCore::ECrowdControl::Stun:
+			Component->Stun(Record.FloatValue);
+			break;
+		case CombatCore::ECrowdControl::KnockBack:
+			Component->KnockBackCharacter();
+			break;
+		case CombatCore::ECrowdControl::BigKnockBack:
+			Component->BigKnockBackCharacter();
+			break;
+		case CombatCore::ECrowdControl::Shock:
+			Component->ShockCharacter(Record.FloatValue);
+			break;
+		default:
+			break;
+		}
+		break;
+	default:
+		//난수는 Tick에서 미리 넣었다.
+		break;
+	}
+}
+
+void UCombatReplaySubsystem::StopLiveAI()
+{
+	for (TActorIterator<AAIController> It(GetWorld()); It; ++It)
+	{
+		UBrainComponent* Brain = It->GetBrainComponent();
+		if (Brain && Brain->IsRunning())
+		{
+			Brain->StopLogic(TEXT("CombatReplay"));
+			It->StopMovement();
+		}
+	}
+}
+
+void UCombatReplaySubsystem::FinishReplay()
+{
+	bReplaying = false;
+
+	if (bOverrodeFixedDeltaTime)
+	{
+		FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		bOverrodeFixedDeltaTime = false;
+	}
+
+	for (const TArray<int32>& Randoms : PendingRandoms)
+	{
+		NumDesyncs += Randoms.Num();
+	}
+
+#if CSV_PROFILER
+	if (FCsvProfiler* Profiler = FCsvProfiler::Get())
+	{
+		Profiler->EndCapture();
+	}
+#endif
+
+	const int64 Ticks = GetClockTick() - ReplayStartTick;
+	const double WallSeconds = FPlatformTime::Seconds() - ReplayStartSeconds;
+	const UCombatClock* Clock = GetWorld()->GetSubsystem<UCombatClock>();
+	const double GameSeconds = Clock ? Ticks * Clock->GetTickSeconds() : 0.0;
+	MY_LOG(LogTemp, Log, TEXT("Combat replay finished, %d records, %lld ticks, game %.1f s, wall %.1f s (x%.1f), desyncs %d"),
+		Records.Num(), Ticks, GameSeconds, WallSeconds, WallSeconds > 0.0 ? GameSeconds / WallSeconds : 0.0, NumDesyncs);
+
+	Records.Empty();
+	if (bExitAfterReplay)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+static FAutoConsoleCommandWithWorld RecordReplayCommand(
+	TEXT("Combat.Replay.Record"),
+	TEXT("서버에서 전투 입력 녹화를 시작합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCombatReplaySubsystem* Replay = World ? World->GetSubsystem<UCombatReplaySubsystem>() : nullptr)
+		{
+			Replay->StartRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs StopReplayCommand(
+	TEXT("Combat.Replay.Stop"),
+	TEXT("전투 입력 녹화를 끝내고 저장합니다. 인자: [경로]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UCombatReplaySubsystem* Replay = World ? World->GetSubsystem<UCombatReplaySubsystem>() : nullptr)
+		{
+			Replay->StopRecording(Args.Num() > 0 ? Args[0] : TEXT("Replays/Combat.ddcr"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs PlayReplayCommand(
+	TEXT("Combat.Replay.Play"),
+	TEXT("전투 입력 녹화를 재생합니다. 인자: <경로>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCombatReplaySubsystem* Replay = World ? World->GetSubsystem<UCombatReplaySubsystem>() : nullptr;
+		if (Replay && Args.Num() > 0)
+		{
+			Replay->StartReplay(Args[0]);
+		}
+	}));
@@ -0,0 +1,119 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatCore.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatReplay.generated.h"
+
+class UCombatComponent;
+
+/*
+ 전투 입력 녹화, 재생
+ 서버에서 UCombatComponent를 움직이는 모든 것을 전투 시계 틱과 함께 작은 바이너리로 기록한다.
+	- 입력 RPC(Server_*) : 함수 이름과 인자, ProcessEvent에서 가로챈다.
+	- 서버 난수 : KnockBackRandIndex 등 DrawRandomRange로 뽑은 값
+	- 외부에서 들어온 피해(스탯 컴포넌트가 적용한 값), CC(Stun, KnockBack, BigKnockBack, Shock)
+ 재생은 새 서버에서 컴포넌트가 등록된 순서대로 슬롯을 맞추고, 같은 틱에 같은 순서로 다시 넣는다.
+ 피해는 스탯 컴포넌트에 다시 적용하므로 체력도 녹화와 같이 줄어든다.
+ 재생하는 동안 몬스터 AI는 멈추고 난수는 기록된 값만 쓴다. 피해와 CC는 이미 기록에 있으므로 AI가 새로 만들면 안 된다.
+ 프로파일링 통계(stat combat, CSV)는 평소처럼 기록된다.
+
+ 녹화 : Combat.Replay.Record / Combat.Replay.Stop [경로], 또는 서버 커맨드 라인 -CombatRecord=경로
+ 재생 : 헤드리스 서버를 최대 속도로 실행
+	DefendTheDungeonServer CombatLoadTestMap -nullrhi -unattended -benchmark -CombatReplay=Saved/Replays/Wave.ddcr -CombatReplayExit
+ -benchmark에서는 고정 프레임 시간을 전투 시계 한 틱(1 / Combat.Clock.Hz)으로 맞추고 대기 없이 진행하므로,
+ 녹화 길이와 관계없이 가능한 빨리 끝난다.
+ 재생 맵의 캐릭터 수와 무기 구성은 녹화한 매치와 같아야 한다(로드 테스트 디렉터 설정 사용).
+ */
+
+enum class ECombatReplayRecord : uint8
+{
+	//함수 이름, 인자 바이트
+	Input,
+	//int32 값
+	Random,
+	//float 피해(스탯 컴포넌트가 적용한 값), uint8 EAttackType
+	Damage,
+	//uint8 ECrowdControl, float 지속 시간
+	CrowdControl,
+};
+
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	bool IsRecording() const { return bRecording; }
+	bool IsReplaying() const { return bReplaying; }
+
+	//서버 컴포넌트를 등록하고 슬롯 번호를 받는다. 녹화와 재생 모두 등록 순서로 캐릭터를 맞춘다.
+	int32 RegisterComponent(UCombatComponent* Component);
+
+	void StartRecording();
+	//녹화를 끝내고 파일로 쓴다. 상대 경로는 Saved 기준
+	bool StopRecording(const FString& Path);
+	bool StartReplay(const FString& Path);
+
+	//녹화 중일 때만 기록한다.
+	void RecordInput(int32 Slot, const UFunction* Function, void* Parms);
+	void RecordRandom(int32 Slot, int32 Value);
+	void RecordDamage(int32 Slot, float Damage, uint8 AttackType);
+	void RecordCrowdControl(int32 Slot, CombatCore::ECrowdControl Type, float Duration);
+
+	//재생 중이면 기록된 난수를 꺼낸다. 남은 값이 없으면 false
+	bool ConsumeRandom(int32 Slot, int32& OutValue);
+
+private:
+	struct FReplayRecord
+	{
+		int64 Tick;
+		int32 Slot;
+		ECombatReplayRecord Type;
+		//Input이면 함수 이름
+		FName FunctionName;
+		//Input 인자 바이트
+		TArray<uint8> Payload;
+		int32 IntValue = 0;
+		float FloatValue = 0.f;
+	};
+
+	int64 GetClockTick() const;
+	void WriteHeader(ECombatReplayRecord Type, int32 Slot);
+	void Dispatch(const FReplayRecord& Record);
+	void FinishReplay();
+	//재생 중에 살아 있는 몬스터 AI를 멈춘다. 웨이브로 새로 생긴 몬스터도 잡도록 매 틱 부른다.
+	void StopLiveAI();
+
+	TArray<TWeakObjectPtr<UCombatComponent>> Components;
+
+	//녹화
+	bool bRecording = false;
+	int64 RecordStartTick = 0;
+	int64 LastRecordTick = 0;
+	TArray<uint8> RecordBuffer;
+	TMap<FName, int32> RecordNames;
+
+	//재생
+	bool bReplaying = false;
+	bool bReplayStarted = false;
+	int32 ReplaySlots = 0;
+	int64 ReplayStartTick = 0;
+	double ReplayStartSeconds = 0.0;
+	int32 NextRecord = 0;
+	TArray<FReplayRecord> Records;
+	TArray<TArray<int32>> PendingRandoms;
+	int32 NumDesyncs = 0;
+	bool bExitAfterReplay = false;
+	//-benchmark 고정 프레임 시간, 재생이 끝나면 되돌린다.
+	double SavedFixedDeltaTime = 0.0;
+	bool bOverrodeFixedDeltaTime = false;
+};
@@ -0,0 +1,136 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatRewind.h"
+
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	float MaxRewindTime = 0.3f;
+	FAutoConsoleVariableRef CVarMaxRewindTime(TEXT("Combat.Rewind.MaxTime"), MaxRewindTime, TEXT("클라이언트 히트 검증 시 되감을 수 있는 최대 시간(초)"));
+
+	float RewindTolerance = 30.f;
+	FAutoConsoleVariableRef CVarRewindTolerance(TEXT("Combat.Rewind.Tolerance"), RewindTolerance, TEXT("되감기 검증 허용 오차(cm)"));
+
+	//사라진 액터 기록 정리 주기(초)
+	constexpr double CleanupInterval = 5.0;
+}
+
+void UCombatRewindSubsystem::FHistory::Push(const FSample& Sample)
+{
+	Samples[Head] = Sample;
+	Head = (Head + 1) % Capacity;
+	Num = FMath::Min(Num + 1, Capacity);
+}
+
+bool UCombatRewindSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+TStatId UCombatRewindSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatRewindSubsystem, STATGROUP_Tickables);
+}
+
+float UCombatRewindSubsystem::GetTolerance()
+{
+	return RewindTolerance;
+}
+
+float UCombatRewindSubsystem::GetMaxRewindTime()
+{
+	return MaxRewindTime;
+}
+
+double UCombatRewindSubsystem::GetOldestAllowedTime() const
+{
+	return GetWorld()->GetTimeSeconds() - MaxRewindTime;
+}
+
+void UCombatRewindSubsystem::Tick(float DeltaTime)
+{
+	//클라이언트는 검증하지 않고, 혼자 하는 게임은 지연이 없다.
+	const UWorld* World = GetWorld();
+	const ENetMode NetMode = World->GetNetMode();
+	if (NetMode == NM_Client || NetMode == NM_Standalone) return;
+
+	const double Now = World->GetTimeSeconds();
+	for (TActorIterator<APawn> It(World); It; ++It)
+	{
+		const APawn* Pawn = *It;
+		float Radius = 0.f;
+		float HalfHeight = 0.f;
+		Pawn->GetSimpleCollisionCylinder(Radius, HalfHeight);
+		Histories.FindOrAdd(Pawn).Push({ Now, Pawn->GetActorLocation(), Radius, HalfHeight });
+	}
+
+	if (Now - LastCleanupTime >= CleanupInterval)
+	{
+		LastCleanupTime = Now;
+		for (auto It = Histories.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid()) It.RemoveCurrent();
+		}
+	}
+}
+
+void UCombatRewindSubsystem::GetRewoundCapsule(const AActor* Actor, double Time, FVector& OutLocation, float& OutRadius, float& OutHalfHeight) const
+{
+	Actor->GetSimpleCollisionCylinder(OutRadius, OutHalfHeight);
+	OutLocation = Actor->GetActorLocation();
+
+	const FHistory* History = Histories.Find(Actor);
+	if (!History || History->Num == 0) return;
+
+	Time = FMath::Max(Time, GetOldestAllowedTime());
+
+	//가장 최근 샘플보다 뒤면 현재 위치를 쓴다.
+	const FSample& Newest = History->Get(History->Num - 1);
+	if (Time >= Newest.Time) return;
+
+	const FSample* Before = &History->Get(0);
+	if (Time <= Before->Time)
+	{
+		OutLocation = Before->Location;
+		OutRadius = Before->Radius;
+		OutHalfHeight = Before->HalfHeight;
+		return;
+	}
+
+	for (int32 Index = 1; Index < History->Num; Index++)
+	{
+		const FSample& After = History->Get(Index);
+		if (After.Time >= Time)
+		{
+			const float Alpha = After.Time > Before->Time ? static_cast<float>((Time - Before->Time) / (After.Time - Before->Time)) : 1.f;
+			OutLocation = FMath::Lerp(Before->Location, After.Location, Alpha);
+			OutRadius = FMath::Lerp(Before->Radius, After.Radius, Alpha);
+			OutHalfHeight = FMath::Lerp(Before->HalfHeight, After.HalfHeight, Alpha);
+			return;
+		}
+		Before = &After;
+	}
+}
+
+bool UCombatRewindSubsystem::ValidateSweepHit(const AActor* Target, double Time, const FVector& Start, const FVector& End, float Radius) const
+{
+	FVector Center;
+	float CapsuleRadius = 0.f;
+	float HalfHeight = 0.f;
+	GetRewoundCapsule(Target, Time, Center, CapsuleRadius, HalfHeight);
+
+	//캡슐 축 선분과 스윕 선분의 최단 거리
+	const float AxisHalf = FMath::Max(HalfHeight - CapsuleRadius, 0.f);
+	const FVector AxisTop = Center + FVector(0.f, 0.f, AxisHalf);
+	const FVector AxisBottom = Center - FVector(0.f, 0.f, AxisHalf);
+
+	FVector OnSweep;
+	FVector OnAxis;
+	FMath::SegmentDistToSegmentSafe(Start, End, AxisBottom, AxisTop, OnSweep, OnAxis);
+	return FVector::DistSquared(OnSweep, OnAxis) <= FMath::Square(Radius + CapsuleRadius + RewindTolerance);
+}
@@ -0,0 +1,78 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatRewind.generated.h"
+
+/*
+ 지연 보상 되감기
+ 서버가 매 프레임 모든 폰의 위치와 캡슐 크기를 짧은 링 버퍼에 남긴다.
+ 클라이언트는 자기 화면에서 맞은 대상을 보고 시각(서버 시간 기준)과 함께 보고하고,
+ 서버는 대상들을 그 시각으로 되감아 캡슐 대 스윕 구 거리만으로 검증한다. 물리 트레이스를 쓰지 않는다.
+ - Combat.Rewind.MaxTime : 되감을 수 있는 최대 시간(초), 이보다 오래된 시각은 이 값으로 잘린다.
+ - Combat.Rewind.Tolerance : 위치 양자화, 보간 오차 허용치(cm)
+ */
+
+/**
+ * 서버 전용 위치 기록 서브시스템입니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatRewindSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * 주어진 시각의 대상 캡슐을 구합니다. 기록이 없는 대상(건물 등 폰이 아닌 액터)은 현재 위치를 씁니다.
+	 * @param Actor 대상
+	 * @param Time 서버 시각, MaxTime보다 오래되면 잘린다.
+	 * @param OutLocation 캡슐 중심
+	 * @param OutRadius 캡슐 반지름
+	 * @param OutHalfHeight 캡슐 반높이
+	 */
+	void GetRewoundCapsule(const AActor* Actor, double Time, FVector& OutLocation, float& OutRadius, float& OutHalfHeight) const;
+
+	/**
+	 * 되감은 대상 캡슐이 스윕 구(Start ~ End, Radius)에 닿는지 검사합니다.
+	 * @return 허용치 안에서 닿으면 true
+	 */
+	bool ValidateSweepHit(const AActor* Target, double Time, const FVector& Start, const FVector& End, float Radius) const;
+
+	//되감기 가능한 가장 오래된 시각
+	double GetOldestAllowedTime() const;
+
+	static float GetTolerance();
+
+	//Combat.Rewind.MaxTime
+	static float GetMaxRewindTime();
+
+private:
+	struct FSample
+	{
+		double Time;
+		FVector Location;
+		float Radius;
+		float HalfHeight;
+	};
+
+	//고정 크기 링 버퍼, 60fps 기준 약 1초
+	struct FHistory
+	{
+		static constexpr int32 Capacity = 64;
+		FSample Samples[Capacity];
+		int32 Head = 0;
+		int32 Num = 0;
+
+		void Push(const FSample& Sample);
+		const FSample& Get(int32 IndexFromOldest) const { return Samples[(Head - Num + IndexFromOldest + Capacity) % Capacity]; }
+	};
+
+	TMap<TWeakObjectPtr<const AActor>, FHistory> Histories;
+	double LastCleanupTime = 0.0;
+};
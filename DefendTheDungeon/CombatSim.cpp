@@ -0,0 +1,303 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatSim.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace CombatCore::Sim
+{
+	namespace
+	{
+		//전투마다 하나씩 쓰는 xorshift64* 난수, 스레드 간 공유하지 않는다.
+		class FSimRandom
+		{
+		public:
+			explicit FSimRandom(uint64_t Seed)
+			{
+				//splitmix64로 씨앗을 섞어 0을 피한다.
+				Seed += 0x9E3779B97F4A7C15ull;
+				Seed = (Seed ^ (Seed >> 30)) * 0xBF58476D1CE4E5B9ull;
+				Seed = (Seed ^ (Seed >> 27)) * 0x94D049BB133111EBull;
+				State = (Seed ^ (Seed >> 31)) | 1ull;
+			}
+
+			//[0, 1)
+			double Uniform()
+			{
+				State ^= State >> 12;
+				State ^= State << 25;
+				State ^= State >> 27;
+				return static_cast<double>((State * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+			}
+
+			//평균 Mean인 지수 분포
+			double Exponential(double Mean)
+			{
+				return -Mean * std::log(1.0 - Uniform());
+			}
+
+		private:
+			uint64_t State;
+		};
+
+		constexpr EActionState ToActionState(ECrowdControl Type)
+		{
+			switch (Type)
+			{
+			case ECrowdControl::Stun:			return EActionState::Stun;
+			case ECrowdControl::KnockBack:		return EActionState::KnockBack;
+			case ECrowdControl::BigKnockBack:	return EActionState::BigKnockBack;
+			//감전은 행동을 끊지 않는다.
+			default:							return EActionState::Idle;
+			}
+		}
+
+		constexpr size_t SlotIndex(EActionSlot Slot) { return static_cast<size_t>(Slot); }
+
+		//스킬 우선순위, 준비된 것 중 앞에 있는 것을 쓴다.
+		constexpr EActionSlot SkillPriority[] = { EActionSlot::R, EActionSlot::Q, EActionSlot::E };
+
+		//정렬된 표본의 백분위 (최근접 순위)
+		double Percentile(const std::vector<double>& Sorted, double Ratio)
+		{
+			if (Sorted.empty()) return 0.0;
+			const size_t Index = static_cast<size_t>(std::ceil(Ratio * Sorted.size()));
+			return Sorted[std::min(Sorted.size() - 1, Index > 0 ? Index - 1 : 0)];
+		}
+
+		FDistribution Summarize(std::vector<double>& Samples)
+		{
+			FDistribution Result;
+			if (Samples.empty()) return Result;
+
+			std::sort(Samples.begin(), Samples.end());
+			double Sum = 0.0;
+			for (const double Sample : Samples) Sum += Sample;
+			Result.Mean = Sum / Samples.size();
+			Result.P5 = Percentile(Samples, 0.05);
+			Result.P50 = Percentile(Samples, 0.5);
+			Result.P95 = Percentile(Samples, 0.95);
+			return Result;
+		}
+	}
+
+	FFightResult SimulateFight(const FLoadout& Loadout, const FFightParams& Params, uint64_t Seed)
+	{
+		FFightResult Result;
+		FSimRandom Random(Seed);
+		FCooldownBook CooldownBook;
+		FCrowdControlBook CrowdControlBook;
+
+		const double TickSeconds = 1.0 / std::max(1, Params.TickRate);
+		const int64_t MaxTicks = static_cast<int64_t>(std::ceil(Params.MaxFightTime / TickSeconds));
+		const bool bEnemyCC = Params.EnemyCCInterval > 0.0 && ToActionState(Params.EnemyCC) != EActionState::Idle;
+
+		double Health = Params.TargetHealth;
+		EActionState State = EActionState::Idle;
+		const FActionSpec* Current = nullptr;
+		double ActionStart = 0.0;
+		int32_t HitsDone = 0;
+		double NextDecision = 0.0;
+		double NextEnemyCC = bEnemyCC ? Random.Exponential(Params.EnemyCCInterval) : Params.MaxFightTime + 1.0;
+
+		auto StartAction = [&](EActionSlot Slot, double Now)
+		{
+			const FActionSpec& Spec = Loadout.Actions[SlotIndex(Slot)];
+			if (Spec.CooldownSlot != ECooldownSlot::MAX)
+			{
+				CooldownBook.Start(Spec.CooldownSlot, Now, Spec.Cooldown);
+			}
+			State = Spec.State;
+			Current = &Spec;
+			ActionStart = Now;
+			HitsDone = 0;
+			Result.ActionsUsed[SlotIndex(Slot)]++;
+		};
+
+		for (int64_t Tick = 0; Tick <= MaxTicks; ++Tick)
+		{
+			const double Now = Tick * TickSeconds;
+
+			//대상의 CC, 우선순위 표가 허락할 때만 현재 행동을 끊는다.
+			if (Now >= NextEnemyCC)
+			{
+				const EActionState CCState = ToActionState(Params.EnemyCC);
+				if (CanTransition(State, CCState))
+				{
+					if (Current) Result.ActionsInterrupted++;
+					Current = nullptr;
+					State = CCState;
+					CrowdControlBook.Apply(Params.EnemyCC, Now, Params.EnemyCCDuration);
+				}
+				NextEnemyCC = Now + Params.EnemyCCDuration + Random.Exponential(Params.EnemyCCInterval);
+			}
+
+			if (IsCrowdControl(State))
+			{
+				if (CrowdControlBook.IsActive(Params.EnemyCC, Now)) continue;
+				State = EActionState::Idle;
+				NextDecision = Now + Random.Uniform() * Params.ReactionJitter;
+			}
+
+			//진행 중인 행동의 타격을 Duration 동안 고르게 넣는다.
+			if (Current)
+			{
+				const int32_t Hits = std::max(1, Current->Hits);
+				while (HitsDone < Hits && Now >= ActionStart + Current->Duration * (HitsDone + 0.5) / Hits)
+				{
+					const float Damage = ScaleDamage(Current->DamageKind, Loadout.AD, Loadout.AP, Current->AdScale, Current->ApScale, Params.TargetDamageScale);
+					Health -= Damage;
+					Result.DamageDealt += Damage;
+					HitsDone++;
+				}
+				if (Health <= 0.0)
+				{
+					Result.TimeToKill = std::max(Now, TickSeconds);
+					return Result;
+				}
+				if (Now >= ActionStart + Current->Duration)
+				{
+					Current = nullptr;
+					State = EActionState::Idle;
+					NextDecision = Now + Random.Uniform() * Params.ReactionJitter;
+				}
+			}
+
+			if (Now < NextDecision) continue;
+
+			//스킬은 공격을 끊고 쓸 수 있다. 우선순위 표가 판정한다.
+			bool bStarted = false;
+			for (const EActionSlot Slot : SkillPriority)
+			{
+				const FActionSpec& Spec = Loadout.Actions[SlotIndex(Slot)];
+				if (!Spec.bEnabled || !CanTransition(State, Spec.State)) continue;
+				if (Spec.CooldownSlot != ECooldownSlot::MAX && !CooldownBook.IsReady(Spec.CooldownSlot, Now)) continue;
+
+				StartAction(Slot, Now);
+				bStarted = true;
+				break;
+			}
+
+			if (!bStarted && State == EActionState::Idle && Loadout.Actions[SlotIndex(EActionSlot::Attack)].bEnabled)
+			{
+				StartAction(EActionSlot::Attack, Now);
+			}
+		}
+
+		Result.TimeToKill = Params.MaxFightTime;
+		Result.bTimedOut = true;
+		return Result;
+	}
+
+	std::vector<FSweepResult> RunSweep(const std::vector<FLoadout>& Loadouts, const FFightParams& Params, int32_t NumFights, int32_t NumThreads)
+	{
+		//표준 스레드 실행기, 스레드마다 남은 묶음을 하나씩 가져간다.
+		const FParallelRunner ThreadRunner = [NumThreads](int32_t NumChunks, const std::function<void(int32_t)>& Body)
+		{
+			std::atomic<int32_t> NextChunk{ 0 };
+			auto Worker = [&]()
+			{
+				for (;;)
+				{
+					const int32_t Chunk = NextChunk.fetch_add(1, std::memory_order_relaxed);
+					if (Chunk >= NumChunks) return;
+					Body(Chunk);
+				}
+			};
+
+			int32_t ThreadCount = NumThreads > 0 ? NumThreads : static_cast<int32_t>(std::thread::hardware_concurrency());
+			ThreadCount = std::min(std::max(1, ThreadCount), NumChunks);
+
+			std::vector<std::thread> Threads;
+			Threads.reserve(ThreadCount - 1);
+			for (int32_t Index = 1; Index < ThreadCount; ++Index)
+			{
+				Threads.emplace_back(Worker);
+			}
+			Worker();
+			for (std::thread& Thread : Threads)
+			{
+				Thread.join();
+			}
+		};
+		return RunSweep(Loadouts, Params, NumFights, ThreadRunner);
+	}
+
+	std::vector<FSweepResult> RunSweep(const std::vector<FLoadout>& Loadouts, const FFightParams& Params, int32_t NumFights, const FParallelRunner& Runner)
+	{
+		std::vector<FSweepResult> Results(Loadouts.size());
+		if (Loadouts.empty() || NumFights <= 0) return Results;
+
+		//결과 자리를 미리 잡아 묶음마다 겹치지 않는 칸에만 쓴다.
+		std::vector<FFightResult> Fights(Loadouts.size() * static_cast<size_t>(NumFights));
+		const int64_t NumJobs = static_cast<int64_t>(Fights.size());
+		constexpr int64_t ChunkSize = 64;
+		const int32_t NumChunks = static_cast<int32_t>((NumJobs + ChunkSize - 1) / ChunkSize);
+
+		Runner(NumChunks, [&](int32_t Chunk)
+		{
+			const int64_t Begin = Chunk * ChunkSize;
+			const int64_t End = std::min(NumJobs, Begin + ChunkSize);
+			for (int64_t Job = Begin; Job < End; ++Job)
+			{
+				//씨앗은 작업 번호로 정하므로 실행기, 스레드 수와 관계없이 같은 결과가 나온다.
+				const size_t LoadoutIndex = static_cast<size_t>(Job / NumFights);
+				Fights[static_cast<size_t>(Job)] = SimulateFight(Loadouts[LoadoutIndex], Params, static_cast<uint64_t>(Job));
+			}
+		});
+
+		std::vector<double> DPS(NumFights);
+		std::vector<double> TimeToKill(NumFights);
+		for (size_t LoadoutIndex = 0; LoadoutIndex < Loadouts.size(); ++LoadoutIndex)
+		{
+			FSweepResult& Result = Results[LoadoutIndex];
+			Result.Name = Loadouts[LoadoutIndex].Name;
+			Result.NumFights = NumFights;
+
+			double Interrupts = 0.0;
+			for (int32_t Index = 0; Index < NumFights; ++Index)
+			{
+				const FFightResult& Fight = Fights[LoadoutIndex * NumFights + Index];
+				DPS[Index] = Fight.TimeToKill > 0.0 ? Fight.DamageDealt / Fight.TimeToKill : 0.0;
+				TimeToKill[Index] = Fight.TimeToKill;
+				Result.NumTimedOut += Fight.bTimedOut;
+				Interrupts += Fight.ActionsInterrupted;
+				for (size_t Slot = 0; Slot < SlotIndex(EActionSlot::MAX); ++Slot)
+				{
+					Result.AverageUses[Slot] += Fight.ActionsUsed[Slot];
+				}
+			}
+
+			for (double& Uses : Result.AverageUses)
+			{
+				Uses /= NumFights;
+			}
+			Result.AverageInterrupts = Interrupts / NumFights;
+			Result.DPS = Summarize(DPS);
+			Result.TimeToKill = Summarize(TimeToKill);
+		}
+		return Results;
+	}
+
+	std::string ToCsv(const std::vector<FSweepResult>& Results)
+	{
+		std::string Csv = "Loadout,Fights,TimedOut,DpsMean,DpsP5,DpsP50,DpsP95,TtkMean,TtkP5,TtkP50,TtkP95,Attacks,Q,E,R,Interrupts\n";
+		char Line[512];
+		for (const FSweepResult& Result : Results)
+		{
+			std::snprintf(Line, sizeof(Line), "%s,%d,%d,%.2f,%.2f,%.2f,%.2f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+				Result.Name.c_str(), Result.NumFights, Result.NumTimedOut,
+				Result.DPS.Mean, Result.DPS.P5, Result.DPS.P50, Result.DPS.P95,
+				Result.TimeToKill.Mean, Result.TimeToKill.P5, Result.TimeToKill.P50, Result.TimeToKill.P95,
+				Result.AverageUses[SlotIndex(EActionSlot::Attack)], Result.AverageUses[SlotIndex(EActionSlot::Q)],
+				Result.AverageUses[SlotIndex(EActionSlot::E)], Result.AverageUses[SlotIndex(EActionSlot::R)],
+				Result.AverageInterrupts);
+			Csv += Line;
+		}
+		return Csv;
+	}
+}
@@ -0,0 +1,131 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CombatCore.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ 오프라인 전투 시뮬레이터
+ CombatCore의 행동 우선순위 표, 쿨타임/CC 기록, 피해 공식을 그대로 써서 1:1 전투를 엔진 없이 돌린다.
+ - 공격자는 준비된 스킬(R > Q > E) 중 지금 상태에서 넘어갈 수 있는 것을, 없으면 기본 공격을 쓴다.
+ - 대상은 일정 간격으로 CC를 걸어 진행 중인 행동을 끊는다.
+ - 시간은 전투 시계와 같은 고정 틱으로 진행한다.
+ 로드아웃(무기 + 보조 무기)마다 수천 번 전투를 모든 코어에서 나눠 돌리고 DPS, TTK 분포를 낸다.
+ 게임 데이터는 UCombatComponent::BuildSimLoadout이 채우고, Combat.Sim.Sweep 으로 실행한다.
+ */
+namespace CombatCore::Sim
+{
+	enum class EActionSlot : uint8_t
+	{
+		Attack,
+		Q,
+		E,
+		R,
+		MAX
+	};
+
+	//행동 하나의 규칙 데이터
+	struct FActionSpec
+	{
+		bool bEnabled = false;
+		//행동 중 상태, 우선순위 표(LevelTable)로 취소 여부를 판정한다.
+		EActionState State = EActionState::Attack;
+		//몽타주 길이(초)
+		double Duration = 1.0;
+		//쿨타임(초), 기본 공격은 0
+		double Cooldown = 0.0;
+		ECooldownSlot CooldownSlot = ECooldownSlot::MAX;
+		//Duration 동안 고르게 나눠 들어가는 타격 수
+		int32_t Hits = 1;
+		//타격 한 번의 피해 종류와 배율 (FCombatHitRequest의 DamageType, AdScale, ApScale)
+		EDamageKind DamageKind = EDamageKind::Ad;
+		float AdScale = 1.f;
+		float ApScale = 1.f;
+	};
+
+	struct FLoadout
+	{
+		std::string Name;
+		float AD = 10.f;
+		float AP = 0.f;
+		FActionSpec Actions[static_cast<size_t>(EActionSlot::MAX)];
+	};
+
+	struct FFightParams
+	{
+		//대상 체력
+		float TargetHealth = 5000.f;
+		//대상이 받는 피해 배율 (피해 감소, 받는 피해 증가 버프), 게임에서는 FCombatHitRequest::TargetDamageScale
+		float TargetDamageScale = 1.f;
+		//대상이 CC를 거는 평균 간격(초), 0이면 걸지 않는다.
+		double EnemyCCInterval = 6.0;
+		ECrowdControl EnemyCC = ECrowdControl::Stun;
+		double EnemyCCDuration = 1.0;
+		//행동 사이 입력 지연 [0, ReactionJitter] 초
+		double ReactionJitter = 0.15;
+		//이 시간 안에 못 잡으면 시간 초과
+		double MaxFightTime = 180.0;
+		int32_t TickRate = 30;
+	};
+
+	struct FFightResult
+	{
+		//시간 초과면 MaxFightTime
+		double TimeToKill = 0.0;
+		double DamageDealt = 0.0;
+		int32_t ActionsUsed[static_cast<size_t>(EActionSlot::MAX)] = {};
+		int32_t ActionsInterrupted = 0;
+		bool bTimedOut = false;
+	};
+
+	//분포 요약
+	struct FDistribution
+	{
+		double Mean = 0.0;
+		double P5 = 0.0;
+		double P50 = 0.0;
+		double P95 = 0.0;
+	};
+
+	struct FSweepResult
+	{
+		std::string Name;
+		int32_t NumFights = 0;
+		int32_t NumTimedOut = 0;
+		FDistribution DPS;
+		FDistribution TimeToKill;
+		//전투당 평균 사용 횟수
+		double AverageUses[static_cast<size_t>(EActionSlot::MAX)] = {};
+		double AverageInterrupts = 0.0;
+	};
+
+	/**
+	 * 전투 한 번을 돌립니다. 같은 Seed면 항상 같은 결과가 나옵니다.
+	 */
+	FFightResult SimulateFight(const FLoadout& Loadout, const FFightParams& Params, uint64_t Seed);
+
+	/**
+	 * 로드아웃마다 NumFights번 전투를 모든 코어에 나눠 돌리고 분포를 요약합니다.
+	 * @param Loadouts 비교할 로드아웃
+	 * @param Params 전투 조건
+	 * @param NumFights 로드아웃당 전투 수
+	 * @param NumThreads 0이면 하드웨어 스레드 수
+	 * @return Loadouts와 같은 순서의 결과
+	 */
+	std::vector<FSweepResult> RunSweep(const std::vector<FLoadout>& Loadouts, const FFightParams& Params, int32_t NumFights, int32_t NumThreads = 0);
+
+	//Body(Chunk)를 [0, NumChunks)의 모든 Chunk에 대해 병렬로 부르고, 모두 끝난 뒤 돌아오는 실행기
+	using FParallelRunner = std::function<void(int32_t NumChunks, const std::function<void(int32_t Chunk)>& Body)>;
+
+	/**
+	 * RunSweep과 같지만 전투를 나눠 돌리는 방법을 호출한 쪽이 정합니다. 엔진에서는 ParallelFor를 넘깁니다.
+	 * 씨앗은 전투 번호로 정하므로 실행기와 관계없이 결과가 같습니다.
+	 */
+	std::vector<FSweepResult> RunSweep(const std::vector<FLoadout>& Loadouts, const FFightParams& Params, int32_t NumFights, const FParallelRunner& Runner);
+
+	//결과를 CSV 문자열로 만든다. 첫 줄은 머리글
+	std::string ToCsv(const std::vector<FSweepResult>& Results);
+}
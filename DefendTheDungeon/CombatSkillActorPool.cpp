@@ -0,0 +1,236 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatSkillActorPool.h"
+
+#include "Components/DecalComponent.h"
+#include "DefendTheDungeon/ETC/CustomMacro.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NiagaraComponent.h"
+#include "TimerManager.h"
+
+namespace
+{
+	int32 SkillPoolMaxPerClass = 8;
+	FAutoConsoleVariableRef CVarSkillPoolMaxPerClass(TEXT("Combat.SkillPool.MaxPerClass"), SkillPoolMaxPerClass, TEXT("클래스별로 보관하는 스킬 액터 최대 수"));
+}
+
+bool UCombatSkillActorPool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatSkillActorPool::Deinitialize()
+{
+	LogStats();
+	Pools.Reset();
+	PendingRelease.Reset();
+	Super::Deinitialize();
+}
+
+AActor* UCombatSkillActorPool::Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner)
+{
+	if (!Class) return nullptr;
+
+	FClassPool& Pool = Pools.FindOrAdd(Class.Get());
+	while (Pool.Free.Num() > 0)
+	{
+		//보관 중에 수명, 외부 파괴로 사라졌을 수 있다.
+		AActor* Actor = Pool.Free.Pop().Get();
+		if (!IsValid(Actor)) continue;
+
+		Pool.Reused++;
+		Unpark(Actor, Transform, Owner);
+		return Actor;
+	}
+
+	return SpawnPooled(Class.Get(), Transform, Owner);
+}
+
+AActor* UCombatSkillActorPool::SpawnPooled(UClass* Class, const FTransform& Transform, AActor* Owner)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = Owner;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(Class, Transform, SpawnParams);
+	if (Actor)
+	{
+		Pools.FindOrAdd(Class).Spawned++;
+	}
+	return Actor;
+}
+
+void UCombatSkillActorPool::Release(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+	PendingRelease.Remove(Actor);
+
+	FClassPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.Free.Num() >= SkillPoolMaxPerClass)
+	{
+		Pool.Overflowed++;
+		Actor->Destroy();
+		return;
+	}
+
+	Pool.Released++;
+	Park(Actor);
+	Pool.Free.Add(Actor);
+}
+
+void UCombatSkillActorPool::ReleaseWhenFinished(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+
+	bool bAlreadyPending = false;
+	PendingRelease.Add(Actor, &bAlreadyPending);
+	if (bAlreadyPending) return;
+
+	TInlineComponentArray<UNiagaraComponent*> NiagaraComponents(Actor);
+	bool bWaiting = false;
+	for (UNiagaraComponent* Niagara : NiagaraComponents)
+	{
+		if (!Niagara->IsActive()) continue;
+
+		//Deactivate는 새 파티클만 막고, 남은 파티클이 사라지면 OnSystemFinished가 온다.
+		Niagara->OnSystemFinished.AddUniqueDynamic(this, &UCombatSkillActorPool::OnNiagaraFinished);
+		Niagara->Deactivate();
+		bWaiting = true;
+	}
+
+	if (!bWaiting && PendingRelease.Remove(Actor) > 0)
+	{
+		Release(Actor);
+	}
+}
+
+void UCombatSkillActorPool::OnNiagaraFinished(UNiagaraComponent* Niagara)
+{
+	Niagara->OnSystemFinished.RemoveDynamic(this, &UCombatSkillActorPool::OnNiagaraFinished);
+
+	AActor* Actor = Niagara->GetOwner();
+	if (!IsValid(Actor) || !PendingRelease.Contains(Actor)) return;
+
+	TInlineComponentArray<UNiagaraComponent*> NiagaraComponents(Actor);
+	for (const UNiagaraComponent* Other : NiagaraComponents)
+	{
+		if (Other->IsActive()) return;
+	}
+
+	PendingRelease.Remove(Actor);
+	Release(Actor);
+}
+
+void UCombatSkillActorPool::Prewarm(TSubclassOf<AActor> Class, int32 Count)
+{
+	if (!Class) return;
+
+	const int32 Target = FMath::Min(Count, SkillPoolMaxPerClass);
+	while (Pools.FindOrAdd(Class.Get()).Free.Num() < Target)
+	{
+		AActor* Actor = SpawnPooled(Class.Get(), FTransform::Identity, nullptr);
+		if (!Actor) return;
+
+		Park(Actor);
+		Pools.FindOrAdd(Class.Get()).Free.Add(Actor);
+	}
+}
+
+void UCombatSkillActorPool::Park(AActor* Actor)
+{
+	if (Actor->Implements<UCombatPooledActor>())
+	{
+		ICombatPooledActor::Execute_OnReturnedToPool(Actor);
+	}
+
+	//수명, 타이머, 데칼 페이드가 보관 중인 액터를 파괴하지 않게 한다.
+	Actor->SetLifeSpan(0.f);
+	GetWorld()->GetTimerManager().ClearAllTimersForObject(Actor);
+
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components)
+	{
+		if (UNiagaraComponent* Niagara = Cast<UNiagaraComponent>(Component))
+		{
+			Niagara->OnSystemFinished.RemoveDynamic(this, &UCombatSkillActorPool::OnNiagaraFinished);
+			Niagara->DeactivateImmediate();
+		}
+		else if (UDecalComponent* Decal = Cast<UDecalComponent>(Component))
+		{
+			Decal->SetFadeOut(0.f, 0.f, false);
+			Decal->SetVisibility(false);
+		}
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	//숨김을 마지막으로 보내고 채널을 쉬게 한다.
+	if (Actor->GetIsReplicated())
+	{
+		Actor->ForceNetUpdate();
+		Actor->SetNetDormancy(DORM_DormantAll);
+	}
+}
+
+void UCombatSkillActorPool::Unpark(AActor* Actor, const FTransform& Transform, AActor* Owner) const
+{
+	if (Actor->GetIsReplicated())
+	{
+		Actor->SetNetDormancy(DORM_Awake);
+	}
+
+	Actor->SetOwner(Owner);
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	//스폰 직후처럼 자동 활성 컴포넌트를 다시 켠다.
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components)
+	{
+		if (UDecalComponent* Decal = Cast<UDecalComponent>(Component))
+		{
+			Decal->SetVisibility(true);
+		}
+		if (Component->IsAutoActivate())
+		{
+			Component->Activate(true);
+		}
+	}
+
+	if (Actor->Implements<UCombatPooledActor>())
+	{
+		ICombatPooledActor::Execute_OnAcquiredFromPool(Actor);
+	}
+
+	if (Actor->GetIsReplicated())
+	{
+		Actor->ForceNetUpdate();
+	}
+}
+
+void UCombatSkillActorPool::LogStats() const
+{
+	for (const TPair<TObjectKey<UClass>, FClassPool>& Pair : Pools)
+	{
+		const FClassPool& Pool = Pair.Value;
+		MY_LOG(LogTemp, Log, TEXT("Combat.SkillPool %s: spawned %d, reused %d, released %d, overflowed %d, free %d"),
+			*GetNameSafe(Pair.Key.ResolveObjectPtr()), Pool.Spawned, Pool.Reused, Pool.Released, Pool.Overflowed, Pool.Free.Num());
+	}
+}
+
+static FAutoConsoleCommandWithWorld SkillPoolStatsCommand(
+	TEXT("Combat.SkillPool.Stats"),
+	TEXT("스킬 액터 풀 통계를 출력합니다."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UCombatSkillActorPool* Pool = World ? World->GetSubsystem<UCombatSkillActorPool>() : nullptr)
+		{
+			Pool->LogStats();
+		}
+	}));
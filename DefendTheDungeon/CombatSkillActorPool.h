@@ -0,0 +1,102 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "CombatSkillActorPool.generated.h"
+
+class UNiagaraComponent;
+
+/*
+ 스킬 액터 풀
+ 시전할 때마다 스폰하고 끝나면 파괴하던 스킬 액터(ADarkMagicOrbSkill 등)를 클래스별로 모아 다시 쓴다.
+ 스폰, 컴포넌트 등록, 리플리케이션 채널 생성과 파괴 비용이 매 시전에서 빠진다.
+	- 반납 : 숨김, 충돌, 틱 끄기, 수명 해제, 나이아가라 즉시 정지, 데칼 숨김, 리플리케이트 액터는 DORM_DormantAll
+	- 연출이 끝난 뒤 반납 : ReleaseWhenFinished, 나이아가라를 Deactivate하고 모두 끝나면 반납한다.
+	- 대여 : 위치 지정, 깨우기, 보이기, 자동 활성 컴포넌트 다시 활성, ICombatPooledActor 훅 호출
+ 클래스별 최대 보관 수는 Combat.SkillPool.MaxPerClass, 넘치면 반납 대신 파괴한다.
+ Combat.SkillPool.Stats 로 확인한다.
+ */
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UCombatPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * 풀에서 재사용되는 액터가 자기 상태를 초기화할 때 구현합니다. 블루프린트에서도 구현할 수 있습니다.
+ */
+class DEFENDTHEDUNGEON_API ICombatPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	//풀에서 꺼내 위치를 정한 직후 호출, 스폰 직후와 같은 상태로 되돌린다.
+	UFUNCTION(BlueprintNativeEvent, Category="Pool")
+	void OnAcquiredFromPool();
+
+	//풀에 돌아가기 직전 호출, 타이머, 스폰한 효과 등을 정리한다.
+	UFUNCTION(BlueprintNativeEvent, Category="Pool")
+	void OnReturnedToPool();
+};
+
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatSkillActorPool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * 클래스의 액터를 풀에서 꺼내거나, 없으면 스폰합니다.
+	 * @param Class 스킬 액터 클래스
+	 * @param Transform 놓을 위치
+	 * @param Owner 소유 액터
+	 * @return 실패하면 nullptr
+	 */
+	AActor* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner = nullptr);
+
+	template <typename T>
+	T* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner = nullptr)
+	{
+		return Cast<T>(Acquire(Class, Transform, Owner));
+	}
+
+	//풀에 돌려준다. 클래스별 보관 수를 넘으면 파괴한다.
+	void Release(AActor* Actor);
+
+	//나이아가라를 자연스럽게 끄고, 모든 시스템이 끝나면 Release한다. 켜진 나이아가라가 없으면 바로 돌려준다.
+	void ReleaseWhenFinished(AActor* Actor);
+
+	//클래스의 보관 액터를 Count개까지 미리 만든다.
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+
+	void LogStats() const;
+
+private:
+	struct FClassPool
+	{
+		TArray<TWeakObjectPtr<AActor>> Free;
+		int32 Spawned = 0;
+		int32 Reused = 0;
+		int32 Released = 0;
+		int32 Overflowed = 0;
+	};
+
+	UFUNCTION()
+	void OnNiagaraFinished(UNiagaraComponent* Niagara);
+
+	AActor* SpawnPooled(UClass* Class, const FTransform& Transform, AActor* Owner);
+	void Park(AActor* Actor);
+	void Unpark(AActor* Actor, const FTransform& Transform, AActor* Owner) const;
+
+	TMap<TObjectKey<UClass>, FClassPool> Pools;
+
+	//ReleaseWhenFinished로 나이아가라가 끝나기를 기다리는 액터
+	TSet<TObjectKey<AActor>> PendingRelease;
+};
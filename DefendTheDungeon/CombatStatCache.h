@@ -0,0 +1,107 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/*
+ 최종 스탯 캐시
+ 전투 중 자주 읽는 최종 스탯을 스탯 컴포넌트의 리비전으로 관리한다.
+ - 스탯 컴포넌트는 효과, 버프를 붙이거나 떼거나 스스로 만료시킬 때, 속성 값이 바뀔 때 리비전을 올린다.
+   캐시는 읽을 때 리비전만 비교하므로 스탯 컴포넌트 안에서 만료되는 버프도 놓치지 않는다.
+ - 스탯 컴포넌트 밖의 변경(무기 교체 등)은 Invalidate()로 로컬 버전을 올린다.
+ 리비전과 버전이 그대로면 몇 번을 읽어도 배열 접근 한 번이다.
+ */
+class FCombatStatCache
+{
+public:
+	enum class ESlot : uint8
+	{
+		AD,
+		AP,
+		MaxHealth,
+		MAX
+	};
+
+	/**
+	 * 캐시된 값을 돌려주고, 리비전이나 버전이 바뀌었으면 Compute로 다시 계산합니다.
+	 * @param Revision 값을 읽어오는 스탯 컴포넌트의 현재 리비전
+	 */
+	template <typename ComputeType>
+	float Get(ESlot Slot, uint32 Revision, ComputeType&& Compute)
+	{
+		const int32 Index = static_cast<int32>(Slot);
+		if (ValueVersions[Index] != Version || ValueRevisions[Index] != Revision)
+		{
+			Values[Index] = Compute();
+			ValueVersions[Index] = Version;
+			ValueRevisions[Index] = Revision;
+		}
+		return Values[Index];
+	}
+
+	void Invalidate() { Version++; }
+	uint32 GetVersion() const { return Version; }
+
+private:
+	static constexpr int32 NumSlots = static_cast<int32>(ESlot::MAX);
+
+	float Values[NumSlots] = {};
+	uint32 ValueVersions[NumSlots] = {};
+	uint32 ValueRevisions[NumSlots] = {};
+	//0은 '계산 안 됨'으로 쓰므로 1부터 시작
+	uint32 Version = 1;
+};
+
+/*
+ 몬스터 스탯 캐시
+ 여러 히트가 같은 몬스터를 때릴 때 대상 측 피해 배율을 몬스터 스탯 컴포넌트마다 한 번만 계산한다.
+ 키는 스탯 컴포넌트와 피해 종류, 값은 그 스탯 컴포넌트의 리비전으로 검사한다.
+ */
+class FCombatMonsterStatCache
+{
+public:
+	/**
+	 * 캐시된 값을 돌려주고, 처음 읽거나 리비전이 바뀌었으면 Compute로 다시 계산합니다.
+	 * @param Source 값을 읽어오는 스탯 컴포넌트
+	 * @param Key 같은 스탯 컴포넌트 안에서 값을 구분하는 키 (피해 종류 등)
+	 * @param Revision Source의 현재 리비전
+	 */
+	template <typename ComputeType>
+	float Get(const UObject* Source, uint8 Key, uint32 Revision, ComputeType&& Compute)
+	{
+		FEntry& Entry = Entries.FindOrAdd(FEntryKey(Source, Key));
+		if (!Entry.bComputed || Entry.Revision != Revision)
+		{
+			Entry.Value = Compute();
+			Entry.Revision = Revision;
+			Entry.bComputed = true;
+		}
+		return Entry.Value;
+	}
+
+	//사라진 스탯 컴포넌트의 항목을 지운다.
+	void RemoveStale()
+	{
+		for (auto It = Entries.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().Key.ResolveObjectPtr()) It.RemoveCurrent();
+		}
+	}
+
+	void Reset() { Entries.Reset(); }
+	int32 Num() const { return Entries.Num(); }
+
+private:
+	using FEntryKey = TPair<TObjectKey<UObject>, uint8>;
+
+	struct FEntry
+	{
+		float Value = 0.f;
+		uint32 Revision = 0;
+		bool bComputed = false;
+	};
+
+	TMap<FEntryKey, FEntry> Entries;
+};
@@ -0,0 +1,63 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatStats.h"
+
+DEFINE_STAT(STAT_Combat_TryPlayAction);
+DEFINE_STAT(STAT_Combat_SphereTrace);
+DEFINE_STAT(STAT_Combat_ApplyCombatDamage);
+DEFINE_STAT(STAT_Combat_TickComponent);
+DEFINE_STAT(STAT_Combat_DarkMagicOrbSkillRun);
+DEFINE_STAT(STAT_Combat_ShieldProvocation);
+DEFINE_STAT(STAT_Combat_SwordHiding);
+DEFINE_STAT(STAT_Combat_FindTransformToShootProjectile);
+DEFINE_STAT(STAT_Combat_JobScheduler);
+DEFINE_STAT(STAT_Combat_EventBus);
+DEFINE_STAT(STAT_Combat_ProjectileSim);
+
+DEFINE_STAT(STAT_Combat_Queries);
+DEFINE_STAT(STAT_Combat_TargetsHit);
+DEFINE_STAT(STAT_Combat_EffectsCreated);
+DEFINE_STAT(STAT_Combat_MulticastsSent);
+DEFINE_STAT(STAT_Combat_JobsRun);
+DEFINE_STAT(STAT_Combat_JobsDeferred);
+DEFINE_STAT(STAT_Combat_EventsDelivered);
+DEFINE_STAT(STAT_Combat_ProjectilesSimulated);
+DEFINE_STAT(STAT_Combat_PoolMisses);
+DEFINE_STAT(STAT_Combat_PoolSpawns);
+
+CSV_DEFINE_CATEGORY_MODULE(DEFENDTHEDUNGEON_API, Combat, true);
+
+namespace CombatFunctionTiming
+{
+	bool bEnabled = false;
+	FTotal Totals[static_cast<int32>(EFunction::MAX)];
+
+	const TCHAR* GetName(EFunction Function)
+	{
+		static const TCHAR* Names[] =
+		{
+			TEXT("TryPlayAction"),
+			TEXT("SphereTrace"),
+			TEXT("ApplyCombatDamage"),
+			TEXT("TickComponent"),
+			TEXT("DarkMagicOrbSkillRun"),
+			TEXT("ShieldProvocation"),
+			TEXT("SwordHiding"),
+			TEXT("FindTransformToShootProjectile"),
+			TEXT("JobScheduler"),
+			TEXT("EventBus"),
+			TEXT("ProjectileSim"),
+		};
+		static_assert(UE_ARRAY_COUNT(Names) == static_cast<int32>(EFunction::MAX), "Names must match EFunction");
+		return Names[static_cast<int32>(Function)];
+	}
+
+	void Reset()
+	{
+		for (FTotal& Total : Totals)
+		{
+			Total = FTotal();
+		}
+	}
+}
@@ -0,0 +1,108 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+/*
+ 전투 프로파일링 통계
+ stat combat 으로 확인하고, CSV 프로파일러(csvprofile start/stop)에서는 Combat 카테고리로 기록된다.
+ */
+
+DECLARE_STATS_GROUP(TEXT("Combat"), STATGROUP_Combat, STATCAT_Advanced);
+
+//사이클 통계
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TryPlayAction"), STAT_Combat_TryPlayAction, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SphereTrace"), STAT_Combat_SphereTrace, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyCombatDamage"), STAT_Combat_ApplyCombatDamage, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TickComponent"), STAT_Combat_TickComponent, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DarkMagicOrbSkillRun"), STAT_Combat_DarkMagicOrbSkillRun, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ShieldProvocation"), STAT_Combat_ShieldProvocation, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SwordHiding"), STAT_Combat_SwordHiding, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindTransformToShootProjectile"), STAT_Combat_FindTransformToShootProjectile, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("JobScheduler"), STAT_Combat_JobScheduler, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("EventBus"), STAT_Combat_EventBus, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ProjectileSim"), STAT_Combat_ProjectileSim, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+
+//프레임 카운터, 매 프레임 0으로 초기화된다.
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries"), STAT_Combat_Queries, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Targets Hit"), STAT_Combat_TargetsHit, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Created"), STAT_Combat_EffectsCreated, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Multicasts Sent"), STAT_Combat_MulticastsSent, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Jobs Run"), STAT_Combat_JobsRun, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Jobs Deferred"), STAT_Combat_JobsDeferred, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Events Delivered"), STAT_Combat_EventsDelivered, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Projectiles Simulated"), STAT_Combat_ProjectilesSimulated, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool Misses"), STAT_Combat_PoolMisses, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool Spawns"), STAT_Combat_PoolSpawns, STATGROUP_Combat, DEFENDTHEDUNGEON_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(DEFENDTHEDUNGEON_API, Combat);
+
+/*
+ 함수별 CPU 누적 시간
+ stat 빌드 설정과 관계없이 COMBAT_SCOPE_CYCLE 구간의 사이클과 호출 수를 모은다. 안쪽 구간도 바깥 구간 시간에 포함된다.
+ bEnabled를 켠 동안만 기록하며(부하 테스트 디렉터), 게임 스레드에서만 쓴다.
+ */
+namespace CombatFunctionTiming
+{
+	//사이클 통계 이름과 같아야 한다.
+	enum class EFunction : uint8
+	{
+		TryPlayAction,
+		SphereTrace,
+		ApplyCombatDamage,
+		TickComponent,
+		DarkMagicOrbSkillRun,
+		ShieldProvocation,
+		SwordHiding,
+		FindTransformToShootProjectile,
+		JobScheduler,
+		EventBus,
+		ProjectileSim,
+		MAX
+	};
+
+	struct FTotal
+	{
+		uint64 Cycles = 0;
+		uint32 Calls = 0;
+	};
+
+	extern DEFENDTHEDUNGEON_API bool bEnabled;
+	extern DEFENDTHEDUNGEON_API FTotal Totals[static_cast<int32>(EFunction::MAX)];
+
+	DEFENDTHEDUNGEON_API const TCHAR* GetName(EFunction Function);
+	DEFENDTHEDUNGEON_API void Reset();
+
+	struct FScope
+	{
+		explicit FScope(EFunction InFunction)
+			: Function(InFunction), StartCycles(bEnabled ? FPlatformTime::Cycles64() : 0)
+		{
+		}
+
+		~FScope()
+		{
+			if (StartCycles == 0) return;
+			FTotal& Total = Totals[static_cast<int32>(Function)];
+			Total.Cycles += FPlatformTime::Cycles64() - StartCycles;
+			Total.Calls++;
+		}
+
+		EFunction Function;
+		uint64 StartCycles;
+	};
+}
+
+//사이클 통계, CSV 타이밍, 함수별 누적 시간을 함께 기록한다. Name은 STAT_Combat_ 뒤의 이름.
+#define COMBAT_SCOPE_CYCLE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Combat_##Name); \
+	CSV_SCOPED_TIMING_STAT(Combat, Name); \
+	const CombatFunctionTiming::FScope CombatFunctionScope_##Name(CombatFunctionTiming::EFunction::Name)
+
+//프레임 카운터와 CSV 누적 값을 함께 올린다.
+#define COMBAT_COUNT(Name, Amount) \
+	INC_DWORD_STAT_BY(STAT_Combat_##Name, Amount); \
+	CSV_CUSTOM_STAT(Combat, Name, static_cast<int32>(Amount), ECsvCustomStatOp::Accumulate)
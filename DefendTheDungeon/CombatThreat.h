@@ -0,0 +1,208 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatThreat.generated.h"
+
+/*
+ 위협 표
+ 몬스터마다 위협이 높은 대상 MaxEntries개만 내림차순으로 들고 있는다.
+ - 피해, 도발, 은신이 들어올 때마다 그 몬스터의 표만 고친다. 매 프레임 전체를 다시 계산하지 않는다.
+ - 감쇠는 표 전체에 같은 비율로 걸리므로 순서가 바뀌지 않는다. 그래서 갱신할 때만 늦게(lazy) 적용한다.
+ - 현재 대상은 도발 대상 또는 맨 앞의 살아있는 항목이므로 조회는 최대 MaxEntries번 비교다.
+ 키 타입이 템플릿이라 엔진 객체 없이 벤치마크(Combat.Threat.Benchmark)에서도 같은 코드를 쓴다.
+ */
+namespace CombatThreat
+{
+	//키가 가리키는 대상이 아직 있는지, 약한 포인터가 아닌 키(벤치마크의 정수 등)는 항상 true
+	template <typename KeyType>
+	bool IsSourceValid(const KeyType&) { return true; }
+
+	template <typename T>
+	bool IsSourceValid(const TWeakObjectPtr<T>& Source) { return Source.IsValid(); }
+}
+
+template <typename KeyType>
+class TCombatThreatList
+{
+public:
+	static constexpr int32 MaxEntries = 4;
+	//이보다 낮아진 위협은 버린다.
+	static constexpr float MinThreat = 1.f;
+
+	/**
+	 * 위협을 더합니다.
+	 * @param Source 위협을 준 대상
+	 * @param Amount 더할 위협
+	 * @param Now 전투 시간(초)
+	 * @param HalfLife 위협이 절반이 되는 시간(초)
+	 */
+	void Add(const KeyType& Source, float Amount, double Now, float HalfLife)
+	{
+		Decay(Now, HalfLife);
+
+		int32 Index = Find(Source);
+		if (Index == INDEX_NONE)
+		{
+			if (Num < MaxEntries)
+			{
+				Index = Num++;
+				Entries[Index] = { Source, 0.f };
+			}
+			else if (Entries[Num - 1].Threat < Amount)
+			{
+				//가장 낮은 항목을 밀어낸다.
+				Index = Num - 1;
+				Entries[Index] = { Source, 0.f };
+			}
+			else
+			{
+				return;
+			}
+		}
+
+		Entries[Index].Threat += Amount;
+		//위협은 늘기만 하므로 앞으로만 옮긴다.
+		while (Index > 0 && Entries[Index - 1].Threat < Entries[Index].Threat)
+		{
+			Swap(Entries[Index - 1], Entries[Index]);
+			Index--;
+		}
+	}
+
+	//대상을 표에서 뺀다. 도발 중이었으면 도발도 풀린다.
+	void Remove(const KeyType& Source)
+	{
+		const int32 Index = Find(Source);
+		if (Index != INDEX_NONE)
+		{
+			for (int32 Next = Index + 1; Next < Num; Next++)
+			{
+				Entries[Next - 1] = Entries[Next];
+			}
+			Entries[--Num] = FEntry();
+		}
+		if (TauntUntil >= 0.0 && TauntSource == Source)
+		{
+			TauntSource = KeyType();
+			TauntUntil = -1.0;
+		}
+	}
+
+	//Until까지 위협과 관계없이 Source를 대상으로 고정한다.
+	void Taunt(const KeyType& Source, double Until)
+	{
+		TauntSource = Source;
+		TauntUntil = Until;
+	}
+
+	/**
+	 * 현재 대상, 없으면 nullptr
+	 * 도발 대상이나 위협 항목이 이미 사라졌으면 건너뛰고 그다음 위협이 높은 살아있는 항목을 고른다.
+	 */
+	const KeyType* GetTarget(double Now, float HalfLife) const
+	{
+		if (Now < TauntUntil && CombatThreat::IsSourceValid(TauntSource)) return &TauntSource;
+
+		//정렬되어 있으므로 감쇠는 한 번만 계산하고, 처음 기준 아래로 떨어지면 뒤는 볼 필요가 없다.
+		const float Factor = GetDecayFactor(Now, HalfLife);
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			if (Entries[Index].Threat * Factor < MinThreat) break;
+			if (CombatThreat::IsSourceValid(Entries[Index].Source)) return &Entries[Index].Source;
+		}
+		return nullptr;
+	}
+
+	int32 GetNum() const { return Num; }
+	bool IsEmpty(double Now) const { return Num == 0 && Now >= TauntUntil; }
+
+private:
+	struct FEntry
+	{
+		KeyType Source;
+		float Threat = 0.f;
+	};
+
+	int32 Find(const KeyType& Source) const
+	{
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			if (Entries[Index].Source == Source) return Index;
+		}
+		return INDEX_NONE;
+	}
+
+	float GetDecayFactor(double Now, float HalfLife) const
+	{
+		return HalfLife > 0.f ? FMath::Exp2(-static_cast<float>(Now - LastDecayTime) / HalfLife) : 1.f;
+	}
+
+	void Decay(double Now, float HalfLife)
+	{
+		const float Factor = GetDecayFactor(Now, HalfLife);
+		LastDecayTime = Now;
+		if (Factor >= 1.f) return;
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Entries[Index].Threat *= Factor;
+		}
+		//정렬되어 있으므로 뒤에서부터 버린다.
+		while (Num > 0 && Entries[Num - 1].Threat < MinThreat)
+		{
+			Entries[--Num] = FEntry();
+		}
+	}
+
+	FEntry Entries[MaxEntries];
+	int32 Num = 0;
+	double LastDecayTime = 0.0;
+	KeyType TauntSource = KeyType();
+	double TauntUntil = -1.0;
+};
+
+/**
+ * 몬스터별 위협 표를 관리하는 서브시스템입니다. 서버에서만 갱신합니다.
+ * 피해는 CombatComponent의 피해 배치에서, 도발은 ShieldProvocation에서, 은신은 SetStealth에서 들어옵니다.
+ * 몬스터 AI는 GetCurrentTarget으로 대상을 얻습니다.
+ * 감쇠 반감기는 Combat.Threat.HalfLife(초), 시간은 전투 시계(UCombatClock) 기준입니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatThreatSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	//피해를 위협으로 더한다.
+	void AddDamageThreat(AActor* Monster, AActor* Source, float Damage);
+
+	/**
+	 * 도발, Duration 동안 위협과 관계없이 Source를 대상으로 고정한다.
+	 * @param Monster 도발당한 몬스터
+	 * @param Source 도발한 캐릭터
+	 * @param Duration 도발 시간(초)
+	 */
+	void Taunt(AActor* Monster, AActor* Source, float Duration);
+
+	//은신 등으로 Source를 모든 몬스터의 표에서 뺀다.
+	void DropSource(AActor* Source);
+
+	//몬스터의 현재 대상, 없으면 nullptr
+	AActor* GetCurrentTarget(const AActor* Monster) const;
+
+private:
+	using FThreatList = TCombatThreatList<TWeakObjectPtr<AActor>>;
+
+	FThreatList& FindOrAddList(AActor* Monster);
+	double GetNow() const;
+
+	UFUNCTION()
+	void HandleMonsterDestroyed(AActor* DestroyedActor);
+
+	TMap<TWeakObjectPtr<AActor>, FThreatList> Lists;
+};
@@ -0,0 +1,119 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+
+#include "CombatVisibility.h"
+
+bool UCombatVisibilitySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCombatVisibilitySubsystem::WriteBit(TArray<uint64>& Words, int32 Slot, bool bValue)
+{
+	const uint64 Mask = 1ull << (Slot % BitsPerWord);
+	if (bValue)
+	{
+		Words[Slot / BitsPerWord] |= Mask;
+	}
+	else
+	{
+		Words[Slot / BitsPerWord] &= ~Mask;
+	}
+}
+
+int32 UCombatVisibilitySubsystem::Register(AActor* Actor, ECombatTeam Team)
+{
+	check(Actor);
+
+	if (const int32* Existing = SlotByActor.Find(Actor))
+	{
+		return *Existing;
+	}
+
+	int32 Slot;
+	if (FreeSlots.Num() > 0)
+	{
+		Slot = FreeSlots.Pop();
+		Actors[Slot] = Actor;
+	}
+	else
+	{
+		Slot = Actors.Add(Actor);
+		const int32 NumWords = Slot / BitsPerWord + 1;
+		if (VisibleWords.Num() < NumWords)
+		{
+			VisibleWords.SetNumZeroed(NumWords);
+			for (TArray<uint64>& Words : TeamWords)
+			{
+				Words.SetNumZeroed(NumWords);
+			}
+		}
+	}
+
+	SlotByActor.Add(Actor, Slot);
+	WriteBit(TeamWords[static_cast<int32>(Team)], Slot, true);
+	WriteBit(VisibleWords, Slot, true);
+	return Slot;
+}
+
+void UCombatVisibilitySubsystem::Unregister(int32 Slot)
+{
+	if (!Actors.IsValidIndex(Slot)) return;
+
+	SlotByActor.Remove(Actors[Slot].Get());
+	Actors[Slot].Reset();
+	WriteBit(VisibleWords, Slot, false);
+	for (TArray<uint64>& Words : TeamWords)
+	{
+		WriteBit(Words, Slot, false);
+	}
+	FreeSlots.Add(Slot);
+}
+
+void UCombatVisibilitySubsystem::SetVisible(int32 Slot, bool bVisible)
+{
+	if (!Actors.IsValidIndex(Slot)) return;
+
+	WriteBit(VisibleWords, Slot, bVisible);
+}
+
+bool UCombatVisibilitySubsystem::IsVisible(int32 Slot) const
+{
+	return Actors.IsValidIndex(Slot) && TestBit(VisibleWords, Slot);
+}
+
+bool UCombatVisibilitySubsystem::IsVisible(const AActor* Actor) const
+{
+	const int32* Slot = SlotByActor.Find(Actor);
+	return !Slot || TestBit(VisibleWords, *Slot);
+}
+
+void UCombatVisibilitySubsystem::GatherVisible(ECombatTeam Team, TArray<AActor*>& OutTargets) const
+{
+	const TArray<uint64>& Members = TeamWords[static_cast<int32>(Team)];
+	ForEachMasked([this, &Members](int32 Word) { return VisibleWords[Word] & Members[Word]; },
+		[&OutTargets](AActor* Actor) { OutTargets.Add(Actor); });
+}
+
+void UCombatVisibilitySubsystem::FilterVisible(TArray<AActor*>& Candidates) const
+{
+	//보이지 않는 대상은 은신한 캐릭터 몇 명뿐이므로, 등록된 비트에서 보임 비트를 뺀 나머지만 모은다.
+	TArray<const AActor*, TInlineAllocator<8>> Hidden;
+	ForEachMasked([this](int32 Word)
+	{
+		uint64 Registered = 0;
+		for (const TArray<uint64>& Words : TeamWords)
+		{
+			Registered |= Words[Word];
+		}
+		return Registered & ~VisibleWords[Word];
+	}, [&Hidden](AActor* Actor) { Hidden.Add(Actor); });
+
+	if (Hidden.Num() == 0) return;
+
+	Candidates.RemoveAllSwap([&Hidden](const AActor* Candidate)
+	{
+		return Hidden.Contains(Candidate);
+	}, EAllowShrinking::No);
+}
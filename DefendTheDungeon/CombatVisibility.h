@@ -0,0 +1,89 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatVisibility.generated.h"
+
+enum class ECombatTeam : uint8
+{
+	Player,
+	Monster,
+	MAX
+};
+
+/**
+ * 팀별 보임 비트셋입니다. 서버에서만 씁니다.
+ * 캐릭터마다 비트 하나를 받고, 은신 상태가 바뀔 때(SetStealth, EndStealth)만 비트를 고칩니다.
+ * 몬스터 인지 갱신은 캐릭터마다 CombatComponent를 들여다보는 대신,
+ * 팀 비트셋과 보임 비트셋을 64비트 단위로 AND 한 번에 걸러 보이는 대상만 얻습니다.
+ */
+UCLASS()
+class DEFENDTHEDUNGEON_API UCombatVisibilitySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/**
+	 * 대상을 등록하고 비트 번호를 돌려줍니다. 처음에는 보이는 상태입니다.
+	 * @param Actor 등록할 대상
+	 * @param Team 대상의 팀
+	 * @return 비트 번호, 해제할 때 쓴다.
+	 */
+	int32 Register(AActor* Actor, ECombatTeam Team);
+	void Unregister(int32 Slot);
+
+	void SetVisible(int32 Slot, bool bVisible);
+	bool IsVisible(int32 Slot) const;
+	bool IsVisible(const AActor* Actor) const;
+
+	/**
+	 * Team에서 보이는 대상을 모두 모읍니다.
+	 * @param Team 찾을 팀
+	 * @param OutTargets 결과, 비우지 않고 뒤에 붙인다.
+	 */
+	void GatherVisible(ECombatTeam Team, TArray<AActor*>& OutTargets) const;
+
+	/**
+	 * 인지한 후보 중 보이는 대상만 남깁니다. 등록되지 않은 후보는 그대로 둡니다.
+	 * 후보마다 비트 번호를 찾지 않고, 등록됐지만 보이지 않는 대상을 비트셋에서 한 번에 모아 후보와 비교합니다.
+	 * @param Candidates 인지 후보, 보이지 않는 대상은 제거된다.
+	 */
+	void FilterVisible(TArray<AActor*>& Candidates) const;
+
+private:
+	static constexpr int32 BitsPerWord = 64;
+
+	static bool TestBit(const TArray<uint64>& Words, int32 Slot) { return (Words[Slot / BitsPerWord] >> (Slot % BitsPerWord)) & 1; }
+	static void WriteBit(TArray<uint64>& Words, int32 Slot, bool bValue);
+
+	//WordMask(Word)가 돌려준 64비트 묶음에서 켜진 비트마다 살아있는 대상으로 Func를 부른다.
+	template <typename MaskType, typename FuncType>
+	void ForEachMasked(MaskType&& WordMask, FuncType&& Func) const
+	{
+		for (int32 Word = 0; Word < VisibleWords.Num(); Word++)
+		{
+			uint64 Bits = WordMask(Word);
+			while (Bits)
+			{
+				const int32 Slot = Word * BitsPerWord + static_cast<int32>(FMath::CountTrailingZeros64(Bits));
+				Bits &= Bits - 1;
+
+				if (AActor* Actor = Actors[Slot].Get())
+				{
+					Func(Actor);
+				}
+			}
+		}
+	}
+
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TMap<TObjectKey<AActor>, int32> SlotByActor;
+	TArray<int32> FreeSlots;
+
+	TArray<uint64> VisibleWords;
+	TArray<uint64> TeamWords[static_cast<int32>(ECombatTeam::MAX)];
+};
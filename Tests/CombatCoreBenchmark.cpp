@@ -0,0 +1,108 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+/*
+ CombatCore 마이크로 벤치마크 (Google Benchmark)
+ 무작위 행동 요청 판정, 쿨타임, CC 기록의 초당 처리량을 잰다.
+ */
+
+#include "CombatCore.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace CombatCore;
+
+namespace
+{
+	std::vector<FActionDesc> MakeRandomActions(size_t Count)
+	{
+		static int OwnerTags[4] = {};
+		std::mt19937 Random(1234);
+		std::uniform_int_distribution<int32_t> StateDist(0, NumStates - 1);
+		std::uniform_int_distribution<int32_t> OwnerDist(0, 3);
+
+		std::vector<FActionDesc> Actions(Count);
+		for (FActionDesc& Desc : Actions)
+		{
+			const EActionState State = static_cast<EActionState>(StateDist(Random));
+			Desc.Owner = &OwnerTags[OwnerDist(Random)];
+			Desc.PlayFunction = 100 + static_cast<uint64_t>(State);
+			Desc.CancelFunction = 200 + static_cast<uint64_t>(State);
+			Desc.EndFunction = 300 + static_cast<uint64_t>(State);
+			Desc.ActionLevel = GetActionLevel(State);
+			Desc.CancelLevel = GetCancelLevel(State);
+		}
+		return Actions;
+	}
+
+	//무작위 요청을 이어서 판정하며, 받아들여진 요청이 현재 액션이 된다.
+	void BM_DecidePlay(benchmark::State& State)
+	{
+		const std::vector<FActionDesc> Actions = MakeRandomActions(4096);
+		FActionDesc Current;
+		size_t Index = 0;
+		for (auto _ : State)
+		{
+			FActionDesc Requested = Actions[Index++ & 4095];
+			FActionBindings Bindings;
+			if (DecidePlay(Current, Requested, Bindings) != EPlayDecision::Denied)
+			{
+				Current = Requested;
+			}
+			//가끔 기본 상태로 돌아가 거절만 반복하지 않게 한다.
+			if ((Index & 7) == 0) Current = FActionDesc();
+			benchmark::DoNotOptimize(Current);
+		}
+		State.SetItemsProcessed(State.iterations());
+	}
+	BENCHMARK(BM_DecidePlay);
+
+	void BM_CanTransition(benchmark::State& State)
+	{
+		std::mt19937 Random(42);
+		std::uniform_int_distribution<int32_t> StateDist(0, NumStates - 1);
+		std::vector<EActionState> States(4096);
+		for (EActionState& Value : States) Value = static_cast<EActionState>(StateDist(Random));
+
+		size_t Index = 0;
+		for (auto _ : State)
+		{
+			const bool bAllowed = CanTransition(States[Index & 4095], States[(Index + 1) & 4095]);
+			++Index;
+			benchmark::DoNotOptimize(bAllowed);
+		}
+		State.SetItemsProcessed(State.iterations());
+	}
+	BENCHMARK(BM_CanTransition);
+
+	void BM_CooldownBook(benchmark::State& State)
+	{
+		FCooldownBook Book;
+		double Now = 0.0;
+		for (auto _ : State)
+		{
+			Now += 0.01;
+			const ECooldownSlot Slot = static_cast<ECooldownSlot>(static_cast<int>(Now * 100.0) % static_cast<int>(ECooldownSlot::MAX));
+			if (Book.IsReady(Slot, Now)) Book.Start(Slot, Now, 1.5);
+			benchmark::DoNotOptimize(Book.GetRemaining(Slot, Now));
+		}
+		State.SetItemsProcessed(State.iterations());
+	}
+	BENCHMARK(BM_CooldownBook);
+
+	void BM_CrowdControlBook(benchmark::State& State)
+	{
+		FCrowdControlBook Book;
+		double Now = 0.0;
+		for (auto _ : State)
+		{
+			Now += 0.01;
+			const ECrowdControl Type = static_cast<ECrowdControl>(static_cast<int>(Now * 100.0) % static_cast<int>(ECrowdControl::MAX));
+			benchmark::DoNotOptimize(Book.Apply(Type, Now, 0.5));
+			benchmark::DoNotOptimize(Book.IsActive(Type, Now));
+		}
+		State.SetItemsProcessed(State.iterations());
+	}
+	BENCHMARK(BM_CrowdControlBook);
+}
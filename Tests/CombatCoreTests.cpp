@@ -0,0 +1,169 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+/*
+ CombatCore 단위 테스트
+ 엔진 없이 우선순위 판정, 전이 표, 쿨타임, CC 기록을 검사한다. 실패한 검사 수를 종료 코드로 돌려준다.
+ */
+
+#include "CombatCore.h"
+
+#include <cstdio>
+
+using namespace CombatCore;
+
+namespace
+{
+	int Failures = 0;
+
+	#define CHECK(Expr) do { if (!(Expr)) { std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Expr); ++Failures; } } while (0)
+
+	//컴포넌트가 내장 행동을 요청할 때 만드는 것과 같은 FActionDesc, 함수 키는 상태마다 다르게 준다.
+	FActionDesc MakeStateAction(EActionState State)
+	{
+		static int OwnerTag = 0;
+		FActionDesc Desc;
+		Desc.Owner = &OwnerTag;
+		Desc.PlayFunction = 100 + static_cast<uint64_t>(State);
+		Desc.CancelFunction = 200 + static_cast<uint64_t>(State);
+		Desc.EndFunction = 300 + static_cast<uint64_t>(State);
+		Desc.ActionLevel = GetActionLevel(State);
+		Desc.CancelLevel = GetCancelLevel(State);
+		return Desc;
+	}
+
+	//전이 표가 실제 판정 함수(DecidePlay)의 결과와 모든 상태 쌍에서 같은지
+	void TestTransitionMatrixMatchesDecidePlay()
+	{
+		for (int32_t From = 0; From < NumStates; ++From)
+		{
+			for (int32_t To = 0; To < NumStates; ++To)
+			{
+				const EActionState FromState = static_cast<EActionState>(From);
+				const EActionState ToState = static_cast<EActionState>(To);
+				FActionDesc Requested = MakeStateAction(ToState);
+				FActionBindings Bindings;
+				const bool bAllowed = DecidePlay(MakeStateAction(FromState), Requested, Bindings) != EPlayDecision::Denied;
+				if (bAllowed != CanTransition(FromState, ToState))
+				{
+					std::printf("Transition %d -> %d: DecidePlay %d, matrix %d\n", From, To, bAllowed, CanTransition(FromState, ToState));
+					++Failures;
+				}
+			}
+		}
+	}
+
+	void TestDecidePlay()
+	{
+		//보정 : 범위를 벗어난 우선순위는 [0, ActionMax]로 잘린다.
+		{
+			FActionDesc Current;
+			FActionDesc Requested = MakeStateAction(EActionState::Attack);
+			Requested.ActionLevel = -5;
+			Requested.CancelLevel = 1000;
+			FActionBindings Bindings;
+			CHECK(DecidePlay(Current, Requested, Bindings) == EPlayDecision::Replace);
+			CHECK(Requested.ActionLevel == 0);
+			CHECK(Requested.CancelLevel == ActionMax);
+		}
+
+		//같은 액션이면 바인딩을 유지한 채 다시 실행한다.
+		{
+			FActionDesc Current = MakeStateAction(EActionState::Block);
+			FActionDesc Requested = Current;
+			FActionBindings Bindings;
+			CHECK(DecidePlay(Current, Requested, Bindings) == EPlayDecision::Replay);
+			CHECK(!Bindings.bBindCancel && !Bindings.bBindEnd);
+		}
+
+		//취소, 엔드 함수가 없으면 바인딩하지 않는다.
+		{
+			FActionDesc Requested = MakeStateAction(EActionState::Dash);
+			Requested.CancelFunction = 0;
+			FActionBindings Bindings;
+			CHECK(DecidePlay(FActionDesc(), Requested, Bindings) == EPlayDecision::Replace);
+			CHECK(!Bindings.bBindCancel);
+			CHECK(Bindings.bBindEnd);
+		}
+
+		//우선순위가 낮으면 거절한다.
+		{
+			FActionDesc Requested = MakeStateAction(EActionState::Attack);
+			FActionBindings Bindings;
+			CHECK(DecidePlay(MakeStateAction(EActionState::SkillQ), Requested, Bindings) == EPlayDecision::Denied);
+		}
+	}
+
+	void TestCooldownBook()
+	{
+		FCooldownBook Book;
+		CHECK(Book.IsReady(ECooldownSlot::Q, 0.0));
+
+		Book.Lock(ECooldownSlot::Q);
+		CHECK(!Book.IsReady(ECooldownSlot::Q, 1.0e9));
+
+		Book.Start(ECooldownSlot::Q, 10.0, 5.0);
+		CHECK(!Book.IsReady(ECooldownSlot::Q, 14.9));
+		CHECK(Book.IsReady(ECooldownSlot::Q, 15.0));
+		CHECK(Book.GetRemaining(ECooldownSlot::Q, 12.0) == 3.0);
+		CHECK(Book.GetRemaining(ECooldownSlot::Q, 20.0) == 0.0);
+		CHECK(Book.IsReady(ECooldownSlot::E, 10.0));
+
+		Book.Finish(ECooldownSlot::Q, 11.0);
+		CHECK(Book.IsReady(ECooldownSlot::Q, 11.0));
+
+		Book.Start(ECooldownSlot::R, 0.0, 100.0);
+		Book.Reset();
+		CHECK(Book.IsReady(ECooldownSlot::R, 0.0));
+	}
+
+	void TestCrowdControlBook()
+	{
+		FCrowdControlBook Book;
+		CHECK(!Book.IsActive(ECrowdControl::Stun, 0.0));
+
+		CHECK(Book.Apply(ECrowdControl::Stun, 0.0, 2.0));
+		CHECK(Book.IsActive(ECrowdControl::Stun, 1.0));
+		//더 일찍 끝나는 CC는 해제 시각을 바꾸지 않는다.
+		CHECK(!Book.Apply(ECrowdControl::Stun, 1.0, 0.5));
+		CHECK(Book.GetRemaining(ECrowdControl::Stun, 1.0) == 1.0);
+		CHECK(Book.Apply(ECrowdControl::Stun, 1.0, 3.0));
+		CHECK(Book.IsActive(ECrowdControl::Stun, 3.5));
+		CHECK(!Book.IsActive(ECrowdControl::Shock, 1.0));
+
+		Book.Clear(ECrowdControl::Stun);
+		CHECK(!Book.IsActive(ECrowdControl::Stun, 1.0));
+
+		//CC 상태가 아닌 행동의 Clear는 아무것도 하지 않는다.
+		Book.Apply(ECrowdControl::KnockBack, 0.0, 1.0);
+		Book.Clear(ToCrowdControl(EActionState::Attack));
+		CHECK(Book.IsActive(ECrowdControl::KnockBack, 0.5));
+	}
+
+	void TestCrowdControlMapping()
+	{
+		for (int32_t State = 0; State < NumStates; ++State)
+		{
+			const EActionState ActionState = static_cast<EActionState>(State);
+			CHECK(IsCrowdControl(ActionState) == (ToCrowdControl(ActionState) != ECrowdControl::MAX));
+		}
+	}
+
+	void TestScaleDamage()
+	{
+		CHECK(ScaleDamage(EDamageKind::Ad, 100.f, 50.f, 1.5f, 2.f, 1.f) == 150.f);
+		CHECK(ScaleDamage(EDamageKind::Ap, 100.f, 50.f, 1.5f, 2.f, 0.5f) == 50.f);
+	}
+}
+
+int main()
+{
+	TestTransitionMatrixMatchesDecidePlay();
+	TestDecidePlay();
+	TestCooldownBook();
+	TestCrowdControlBook();
+	TestCrowdControlMapping();
+	TestScaleDamage();
+
+	if (Failures == 0) std::printf("CombatCoreTests passed\n");
+	return Failures == 0 ? 0 : 1;
+}
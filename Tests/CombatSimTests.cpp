@@ -0,0 +1,141 @@
+// Copyright © Earth Heroes 2024. Defend The Dungeon™ is a trademark of Earth Heroes. All Rights Reserved.
+
+/*
+ CombatSim 단위 테스트
+ 스레드 수, 실행기와 관계없이 스윕 결과가 같은지, DPS가 규칙상 가능한 범위 안인지 검사한다. 실패한 검사 수를 종료 코드로 돌려준다.
+ */
+
+#include "CombatSim.h"
+
+#include <cstdio>
+
+using namespace CombatCore;
+using namespace CombatCore::Sim;
+
+namespace
+{
+	int Failures = 0;
+
+	#define CHECK(Expr) do { if (!(Expr)) { std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Expr); ++Failures; } } while (0)
+
+	//기본 공격만 쓰는 로드아웃, 초당 AD / Duration이 상한이다.
+	FLoadout MakeAttackOnly(float AD, double Duration)
+	{
+		FLoadout Loadout;
+		Loadout.Name = "AttackOnly";
+		Loadout.AD = AD;
+		FActionSpec& Attack = Loadout.Actions[static_cast<size_t>(EActionSlot::Attack)];
+		Attack.bEnabled = true;
+		Attack.State = EActionState::Attack;
+		Attack.Duration = Duration;
+		return Loadout;
+	}
+
+	//기본 공격과 Q, R을 쓰는 로드아웃, 스킬이 공격을 끊는 경로까지 지난다.
+	FLoadout MakeWithSkills()
+	{
+		FLoadout Loadout = MakeAttackOnly(80.f, 0.8);
+		Loadout.Name = "WithSkills";
+		Loadout.AP = 40.f;
+
+		FActionSpec& Q = Loadout.Actions[static_cast<size_t>(EActionSlot::Q)];
+		Q.bEnabled = true;
+		Q.State = EActionState::SkillQ;
+		Q.Duration = 1.2;
+		Q.Cooldown = 6.0;
+		Q.CooldownSlot = ECooldownSlot::Q;
+		Q.Hits = 3;
+		Q.AdScale = 1.5f;
+
+		FActionSpec& R = Loadout.Actions[static_cast<size_t>(EActionSlot::R)];
+		R.bEnabled = true;
+		R.State = EActionState::SkillR;
+		R.Duration = 2.0;
+		R.Cooldown = 20.0;
+		R.CooldownSlot = ECooldownSlot::R;
+		R.Hits = 2;
+		R.DamageKind = EDamageKind::Ap;
+		R.ApScale = 4.f;
+		return Loadout;
+	}
+
+	bool SameDistribution(const FDistribution& A, const FDistribution& B)
+	{
+		return A.Mean == B.Mean && A.P5 == B.P5 && A.P50 == B.P50 && A.P95 == B.P95;
+	}
+
+	bool SameResult(const FSweepResult& A, const FSweepResult& B)
+	{
+		bool bSame = A.Name == B.Name && A.NumFights == B.NumFights && A.NumTimedOut == B.NumTimedOut
+			&& SameDistribution(A.DPS, B.DPS) && SameDistribution(A.TimeToKill, B.TimeToKill)
+			&& A.AverageInterrupts == B.AverageInterrupts;
+		for (size_t Slot = 0; Slot < static_cast<size_t>(EActionSlot::MAX); ++Slot)
+		{
+			bSame = bSame && A.AverageUses[Slot] == B.AverageUses[Slot];
+		}
+		return bSame;
+	}
+
+	//스레드 1개와 여러 개, 묶음을 거꾸로 도는 실행기의 결과가 비트 단위로 같은지
+	void TestSweepIsThreadCountIndependent()
+	{
+		const std::vector<FLoadout> Loadouts = { MakeAttackOnly(100.f, 1.0), MakeWithSkills() };
+		FFightParams Params;
+		constexpr int32_t NumFights = 500;
+
+		const std::vector<FSweepResult> Single = RunSweep(Loadouts, Params, NumFights, 1);
+		const std::vector<FSweepResult> Multi = RunSweep(Loadouts, Params, NumFights, 4);
+		const std::vector<FSweepResult> Reversed = RunSweep(Loadouts, Params, NumFights, [](int32_t NumChunks, const std::function<void(int32_t)>& Body)
+		{
+			for (int32_t Chunk = NumChunks - 1; Chunk >= 0; --Chunk)
+			{
+				Body(Chunk);
+			}
+		});
+
+		CHECK(Single.size() == Loadouts.size());
+		CHECK(Multi.size() == Loadouts.size());
+		CHECK(Reversed.size() == Loadouts.size());
+		for (size_t Index = 0; Index < Single.size() && Index < Multi.size() && Index < Reversed.size(); ++Index)
+		{
+			CHECK(SameResult(Single[Index], Multi[Index]));
+			CHECK(SameResult(Single[Index], Reversed[Index]));
+		}
+	}
+
+	//기본 공격만 쓰면 DPS는 AD / Duration을 넘을 수 없고, 입력 지연과 CC를 빼도 크게 모자라지 않다.
+	//마지막 타격은 스윙 중간에 들어가 전투 시간이 반 스윙 짧아지므로 상한에 2% 여유를 둔다.
+	void TestAttackOnlyDpsBounds()
+	{
+		constexpr float AD = 100.f;
+		constexpr double Duration = 1.0;
+		const double MaxDps = AD / Duration;
+		FFightParams Params;
+
+		const std::vector<FSweepResult> Results = RunSweep({ MakeAttackOnly(AD, Duration) }, Params, 200, 2);
+		CHECK(Results.size() == 1);
+		if (Results.size() != 1) return;
+
+		const FSweepResult& Result = Results[0];
+		CHECK(Result.NumTimedOut == 0);
+		CHECK(Result.DPS.P95 <= MaxDps * 1.02);
+		CHECK(Result.DPS.P5 >= MaxDps * 0.5);
+		CHECK(Result.DPS.P5 <= Result.DPS.P50 && Result.DPS.P50 <= Result.DPS.P95);
+		CHECK(Result.TimeToKill.Mean >= Params.TargetHealth / MaxDps * 0.99);
+
+		//CC와 입력 지연이 없으면 공격 시간만큼 정확히 들어간다.
+		Params.EnemyCCInterval = 0.0;
+		Params.ReactionJitter = 0.0;
+		const std::vector<FSweepResult> Ideal = RunSweep({ MakeAttackOnly(AD, Duration) }, Params, 20, 1);
+		CHECK(Ideal.size() == 1 && Ideal[0].DPS.Mean >= MaxDps * 0.95 && Ideal[0].DPS.Mean <= MaxDps * 1.02);
+	}
+}
+
+int main()
+{
+	TestSweepIsThreadCountIndependent();
+	TestAttackOnlyDpsBounds();
+
+	if (Failures == 0) std::printf("CombatSimTests passed\n");
+	return Failures == 0 ? 0 : 1;
+}